@@ -7,6 +7,7 @@ Nécessite: pip install matplotlib pandas
 import matplotlib.pyplot as plt
 import pandas as pd
 import numpy as np
+import os
 
 # Configuration matplotlib pour un style professionnel
 plt.style.use('seaborn-v0_8-darkgrid')
@@ -192,6 +193,65 @@ def graph4_stacked_latencies():
     plt.close()
 
 
+def graph5_latency_percentiles():
+    """Graphe 5: Distribution des latences par étape (p50 / p90 / p99 / max)"""
+    # fichier écrit par: motion --stats-path graph_data_latency_percentiles.csv
+    df = pd.read_csv('graph_data_latency_percentiles.csv')
+
+    fig, ax = plt.subplots(figsize=(12, 6))
+
+    x = np.arange(len(df))
+    width = 0.2
+
+    for i, (col, label, color) in enumerate([('p50_ms', 'p50', '#006E90'), ('p90_ms', 'p90', '#00A6C7'),
+                                             ('p99_ms', 'p99', '#F18F01'), ('Max_ms', 'max', '#C73E1D')]):
+        ax.bar(x + (i - 1.5) * width, df[col], width, label=label, color=color, alpha=0.8)
+
+    ax.set_xlabel('Étape du Pipeline (thread)', fontsize=14, fontweight='bold')
+    ax.set_ylabel('Latence (ms)', fontsize=14, fontweight='bold')
+    ax.set_title('Distribution des Latences par Étape', fontsize=16, fontweight='bold')
+    ax.set_xticks(x)
+    ax.set_xticklabels(df['Task'].str.replace('_', ' ') + '\n(' + df['Thread'] + ')', rotation=15, ha='right')
+    ax.legend(fontsize=12)
+    ax.grid(True, axis='y', alpha=0.3)
+
+    plt.tight_layout()
+    plt.savefig('graph5_latency_percentiles.png', dpi=300, bbox_inches='tight')
+    print("✓ Graphe 5 généré: graph5_latency_percentiles.png")
+    plt.close()
+
+
+def graph6_kernels():
+    """Graphe 6: Temps par pixel de chaque kernel (micro-benchmarks)"""
+    # fichier écrit par: motion-bench --bench-out-path graph_data_kernels.csv
+    df = pd.read_csv('graph_data_kernels.csv')
+
+    fig, ax = plt.subplots(figsize=(14, 6))
+
+    kernels = df['Kernel'].unique()
+    threads = df['Threads'].unique()
+    x = np.arange(len(kernels))
+    width = 0.8 / len(threads)
+
+    for i, t in enumerate(threads):
+        d = df[df['Threads'] == t].set_index('Kernel').reindex(kernels)
+        ax.bar(x + (i - (len(threads) - 1) / 2) * width, d['ns_per_pixel'], width, label=f'{t} thread(s)',
+               alpha=0.8)
+
+    ax.set_xlabel('Kernel', fontsize=14, fontweight='bold')
+    ax.set_ylabel('Temps (ns / pixel)', fontsize=14, fontweight='bold')
+    ax.set_title('Micro-Benchmarks des Kernels', fontsize=16, fontweight='bold')
+    ax.set_xticks(x)
+    ax.set_xticklabels(kernels, rotation=45, ha='right')
+    ax.legend(fontsize=12)
+    ax.grid(True, axis='y', alpha=0.3)
+
+    plt.tight_layout()
+    plt.savefig('graph6_kernels.png', dpi=300, bbox_inches='tight')
+    print("✓ Graphe 6 généré: graph6_kernels.png")
+    plt.close()
+
+
 if __name__ == '__main__':
     print("Génération des graphes de présentation...")
     print("=" * 50)
@@ -201,6 +261,10 @@ if __name__ == '__main__':
         graph2_latencies_comparison()
         graph3_fps_comparison()
         graph4_stacked_latencies()
+        if os.path.exists('graph_data_latency_percentiles.csv'):
+            graph5_latency_percentiles()
+        if os.path.exists('graph_data_kernels.csv'):
+            graph6_kernels()
 
         print("=" * 50)
         print("✓ Tous les graphes ont été générés avec succès!")
@@ -209,6 +273,8 @@ if __name__ == '__main__':
         print("  - graph2_latencies_comparison.png (CM2/CM3: Latences par étape)")
         print("  - graph3_fps_comparison.png      (Vue globale: FPS)")
         print("  - graph4_stacked_latencies.png   (Breakdown du temps)")
+        print("  - graph5_latency_percentiles.png (Distribution des latences)")
+        print("  - graph6_kernels.png             (Micro-benchmarks des kernels)")
         print("\nUtilisez ces graphes dans votre présentation PowerPoint.")
 
     except Exception as e:
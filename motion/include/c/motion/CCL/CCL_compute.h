@@ -61,7 +61,7 @@ uint32_t _CCL_LSL_apply(uint32_t** CCL_data_er, uint32_t** CCL_data_era, uint32_
  * @param img Input binary image (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$, \f$\{0,1\}\f$ has to be coded as
  *            \f$\{0,255\}\f$).
  * @param labels Output labels (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$. The labels are in \f$[1;2^{32} -1]\f$ and
- *               0 value means no label).
+ *               0 value means no label). Can be NULL, then only the inner data are computed.
  * @param no_init_labels If this boolean is set to `1`, then the \p labels buffer is considered pre-initialized with `0`
  *                       values. Else, if \p no_labels_init parameter is set to `0`, then this function will initialized
  *                       zones that does not correspond to connected-components with `0` value. In doubt, prefer to set
@@ -70,6 +70,90 @@ uint32_t _CCL_LSL_apply(uint32_t** CCL_data_er, uint32_t** CCL_data_era, uint32_
  */
 uint32_t CCL_LSL_apply(CCL_data_t *CCL_data, const uint8_t** img, uint32_t** labels, const uint8_t no_init_labels);
 
+/**
+ * Compute the Light Speed Labeling (LSL) algorithm on a 64-bit packed binary image. The segments are extracted from the
+ * bit transitions of the packed words and the relative labels (`CCL_data->er`) are not used. The labels are the same
+ * as the ones returned by `CCL_LSL_apply` on the equivalent unpacked image.
+ * @param CCL_data Inner data required to perform the LSL.
+ * @param img Input packed binary image (2D array \f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$, 64 pixels
+ *            per word, see `sigma_delta_compute_packed`).
+ * @param labels Output labels (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$. The labels are in \f$[1;2^{32} -1]\f$ and
+ *               0 value means no label).
+ * @param no_init_labels If this boolean is set to `1`, then the \p labels buffer is considered pre-initialized with `0`
+ *                       values (see `CCL_LSL_apply`).
+ * @return Number of labels.
+ */
+uint32_t CCL_LSL_apply_packed(CCL_data_t* CCL_data, const uint64_t** img, uint32_t** labels,
+                              const uint8_t no_init_labels);
+
+/**
+ * Parallel version of `CCL_LSL_apply`. The image is split into horizontal bands that are labeled concurrently (one
+ * band per OpenMP thread), then the equivalences between the bands are merged and the final labeling is done in
+ * parallel. The number of labels and the labels themselves are the same as with `CCL_LSL_apply`.
+ * @param CCL_data Inner data required to perform the LSL.
+ * @param img Input binary image (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$, \f$\{0,1\}\f$ has to be coded as
+ *            \f$\{0,255\}\f$).
+ * @param labels Output labels (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$. The labels are in \f$[1;2^{32} -1]\f$ and
+ *               0 value means no label).
+ * @param no_init_labels If this boolean is set to `1`, then the \p labels buffer is considered pre-initialized with `0`
+ *                       values (see `CCL_LSL_apply`).
+ * @return Number of labels.
+ */
+uint32_t CCL_LSL_apply_par(CCL_data_t* CCL_data, const uint8_t** img, uint32_t** labels,
+                           const uint8_t no_init_labels);
+
+/**
+ * Parallel version of `CCL_LSL_apply_packed` (see `CCL_LSL_apply_par`).
+ * @param CCL_data Inner data required to perform the LSL.
+ * @param img Input packed binary image (2D array \f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$).
+ * @param labels Output labels (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$. The labels are in \f$[1;2^{32} -1]\f$ and
+ *               0 value means no label).
+ * @param no_init_labels If this boolean is set to `1`, then the \p labels buffer is considered pre-initialized with `0`
+ *                       values (see `CCL_LSL_apply`).
+ * @return Number of labels.
+ */
+uint32_t CCL_LSL_apply_packed_par(CCL_data_t* CCL_data, const uint64_t** img, uint32_t** labels,
+                                  const uint8_t no_init_labels);
+
+/**
+ * Compute the Light Speed Labeling (LSL) algorithm and the features of the connected-components (CCL + CCA). The
+ * features are computed from the segments found by the LSL, the labels image is not read. The RoIs are the same as the
+ * ones computed by `features_extract` on the labels image returned by `CCL_LSL_apply`.
+ * @param CCL_data Inner data required to perform the LSL.
+ * @param img Input binary image (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$, \f$\{0,1\}\f$ has to be coded as
+ *            \f$\{0,255\}\f$).
+ * @param labels Output labels (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$). Can be NULL, then the labels image is not
+ *               written.
+ * @param RoIs Output features (the capacity has to be at least the number of labels).
+ * @param par Boolean, use the parallel LSL (`CCL_LSL_apply_par`).
+ * @return Number of labels (= number of RoIs).
+ */
+uint32_t CCL_LSL_apply_features(CCL_data_t* CCL_data, const uint8_t** img, uint32_t** labels, RoIs_t* RoIs,
+                                const uint8_t par);
+
+/**
+ * Same as `CCL_LSL_apply_features` but on a 64-bit packed binary image (see `CCL_LSL_apply_packed`).
+ * @param CCL_data Inner data required to perform the LSL.
+ * @param img Input packed binary image (2D array \f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$).
+ * @param labels Output labels (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$). Can be NULL, then the labels image is not
+ *               written.
+ * @param RoIs Output features (the capacity has to be at least the number of labels).
+ * @param par Boolean, use the parallel LSL (`CCL_LSL_apply_packed_par`).
+ * @return Number of labels (= number of RoIs).
+ */
+uint32_t CCL_LSL_apply_packed_features(CCL_data_t* CCL_data, const uint64_t** img, uint32_t** labels, RoIs_t* RoIs,
+                                       const uint8_t par);
+
+/**
+ * Write the labels image from the segments of the last labeling (`CCL_LSL_apply*` has to be called before). The
+ * background and the filtered labels are set to 0.
+ * @param CCL_data Inner data of the last labeling.
+ * @param labels Output labels (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$).
+ * @param remap Remap table of the labels (see `features_filter_surface_remap`): the segments of label `l` are written
+ *              with the value `remap[l]`. Can be NULL, then the labels are written as is.
+ */
+void CCL_LSL_write_labels(const CCL_data_t* CCL_data, uint32_t** labels, const uint32_t* remap);
+
 /**
  * Free the inner data.
  * Arthur HENNEQUIN's LSL implementation.
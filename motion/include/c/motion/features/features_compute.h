@@ -14,19 +14,27 @@
  * @param max_size Maximum capacity of each *feature* field (= maximum number of elements in the arrays).
  * @return Pointer of allocated RoIs.
  */
-RoI_t* features_alloc_RoIs(const size_t max_size);
+RoIs_t* features_alloc_RoIs(const size_t max_size);
 
 /**
  * Initialization of the features. Set all zeros.
  * @param RoIs Pointer of RoIs.
  */
-void features_init_RoIs(RoI_t* RoIs, const size_t max_size);
+void features_init_RoIs(RoIs_t* RoIs);
 
 /**
  * Free the features.
  * @param RoIs Pointer of RoIs.
  */
-void features_free_RoIs(RoI_t* RoIs);
+void features_free_RoIs(RoIs_t* RoIs);
+
+/**
+ * Gather the features of one RoI (conversion from the SoA to the AoS representation).
+ * @param RoIs Features.
+ * @param i Position of the RoI in the arrays.
+ * @return The features of the RoI.
+ */
+RoI_t features_get_RoI(const RoIs_t* RoIs, const size_t i);
 
 /**
  * Basic features extraction from a 2D array of `labels`.
@@ -39,10 +47,10 @@ void features_free_RoIs(RoI_t* RoIs);
  * @param j1 Last \f$x\f$ index in the labels (included).
  * @param RoIs Features.
  * @param n_RoIs Number of connected-components (= number of RoIs) in the 2D array of `labels`.
- * @see RoI_t for more explanations about the features.
+ * @see RoIs_t for more explanations about the features.
  */
 void features_extract(const uint32_t** labels, const int i0, const int i1, const int j0, const int j1,
-                      RoI_t* RoIs, const size_t n_RoIs);
+                      RoIs_t* RoIs, const size_t n_RoIs);
 
 /**
  * This function performs a surface thresholding as follow: if \f$ S_{min} > S \f$ or \f$ S > S_{max}\f$, then the
@@ -60,20 +68,38 @@ void features_extract(const uint32_t** labels, const int i0, const int i1, const
  * @param S_min Minimum morphological threshold.
  * @param S_max Maximum morphological threshold.
  * @return Number of labels after filtering.
- * @see RoI_t for more explanations about the features.
+ * @see RoIs_t for more explanations about the features.
  */
 uint32_t features_filter_surface(const uint32_t** in_labels, uint32_t** out_labels, const int i0, const int i1,
-                                 const int j0, const int j1, RoI_t* RoIs, const size_t n_RoIs, const uint32_t S_min,
+                                 const int j0, const int j1, RoIs_t* RoIs, const size_t n_RoIs, const uint32_t S_min,
                                  const uint32_t S_max);
+/**
+ * Same surface thresholding as `features_filter_surface` but the labels image is not read nor written: instead, the
+ * new label of each RoI is returned in a remap table (the new labels are the same as the ones written in `out_labels`
+ * by `features_filter_surface`). The filtered labels image can then be produced in a single pass from the segments of
+ * the CCL (see `CCL_LSL_write_labels`).
+ * @param RoIs Features.
+ * @param n_RoIs Number of RoIs in the previous array.
+ * @param S_min Minimum morphological threshold.
+ * @param S_max Maximum morphological threshold.
+ * @param remap Output remap table (\f$[\texttt{n\_RoIs} + 1]\f$): `remap[RoIs->id[i]]` is the new label of the RoI
+ *              `i` (0 if the RoI is filtered) and `remap[0]` is 0.
+ * @return Number of labels after filtering.
+ * @see RoIs_t for more explanations about the features.
+ */
+uint32_t features_filter_surface_remap(RoIs_t* RoIs, const size_t n_RoIs, const uint32_t S_min, const uint32_t S_max,
+                                       uint32_t* remap);
+
 /**
  * Shrink features. Remove features when feature identifier value is 0.
- * Source features (`RoIs_src[i].X`) are copied into destination features (`RoIs_dst[i].X`) if `RoIs_src[i].id` > 0.
+ * Source features (`RoIs_src->X[i]`) are copied into destination features (`RoIs_dst->X[j]`) if `RoIs_src->id[i]` > 0,
+ * the RoIs are renumbered from 1 in the destination.
  * @param RoIs_src Source features.
  * @param n_RoIs_src Number of RoIs in the previous arrays.
  * @param RoIs_dst Destination features.
- * @see RoIs_basic_t for more explanations about the features.
+ * @see RoIs_t for more explanations about the features.
  */
-void features_shrink_basic(const RoI_t* RoIs_src, const size_t n_RoIs_src, RoI_t* RoIs_dst);
+void features_shrink_basic(const RoIs_t* RoIs_src, const size_t n_RoIs_src, RoIs_t* RoIs_dst);
 
 /**
  * Initialize labels to zero value depending on bounding boxes.
@@ -81,4 +107,4 @@ void features_shrink_basic(const RoI_t* RoIs_src, const size_t n_RoIs_src, RoI_t
  * @param n_RoIs Number of connected-components (= number of RoIs).
  * @param labels 2D array of labels (\f$[\texttt{img\_height}][\texttt{img\_width}]\f$).
  */
-void features_labels_zero_init(const RoI_t* RoIs, const size_t n_RoIs, uint32_t** labels);
+void features_labels_zero_init(const RoIs_t* RoIs, const size_t n_RoIs, uint32_t** labels);
@@ -20,9 +20,9 @@
  *               then the corresponding tracks are not shown.
  * @param age 0 if `frame` is the current frame, 1 if `frame` is the \f$t - 1\f$ frame. This is mandatory to find the
  *            corresponding track (if any). If `tracks == NULL` then this argument is useless.
- * @see RoI_t for more explanations about the features.
+ * @see RoIs_t for more explanations about the features.
  */
-void features_RoIs_write(FILE* f, const int frame, const RoI_t* RoIs, const size_t n_RoIs, const vec_track_t tracks,
+void features_RoIs_write(FILE* f, const int frame, const RoIs_t* RoIs, const size_t n_RoIs, const vec_track_t tracks,
                          const unsigned age);
 
 /**
@@ -36,8 +36,8 @@ void features_RoIs_write(FILE* f, const int frame, const RoI_t* RoIs, const size
  * @param n_RoIs1 Number of connected-components (= number of RoIs) in the 2D array of `labels` (at \f$t\f$).
  * @param tracks Vector of tracks. It enables to match RoIs with corresponding track in the table of RoIs. Can be NULL,
  *               then the corresponding tracks are not shown.
- * @see RoIs_basic_t for more explanations about the features.
+ * @see RoIs_t for more explanations about the features.
  */
-void features_RoIs0_RoIs1_write(FILE* f, const int prev_frame, const int cur_frame, const RoI_t* RoIs0,
-                                const size_t n_RoIs0, const RoI_t* RoIs1, const size_t n_RoIs1,
+void features_RoIs0_RoIs1_write(FILE* f, const int prev_frame, const int cur_frame, const RoIs_t* RoIs0,
+                                const size_t n_RoIs0, const RoIs_t* RoIs1, const size_t n_RoIs1,
                                 const vec_track_t tracks);
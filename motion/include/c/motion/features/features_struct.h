@@ -7,6 +7,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  *  Features: bounding box, surface, centroid & associations (matching).
@@ -29,3 +30,28 @@ typedef struct {
     uint32_t prev_id; /**< Previous corresponding RoI identifiers (\f$RoI_{t - 1} \leftrightarrow RoI_{t}\f$). */
     uint32_t next_id; /**< Next corresponding RoI identifiers (\f$ RoI_{t} \leftrightarrow RoI_{t + 1}\f$). */
 } RoI_t;
+
+/**
+ *  Features of a set of RoIs stored as a Structure of Arrays (SoA): one array per feature, the \f$i^{th}\f$ RoI is
+ *  described by the \f$i^{th}\f$ element of each array (see `RoI_t` for the meaning of the fields).
+ *  The arrays are allocated in a single aligned block, each array starts on a 64-byte boundary and its capacity is
+ *  rounded up to a multiple of 16 elements, this way the hot kernels (surface filtering, \f$k\f$-NN distances and
+ *  surface ratios) only load the fields they need and can be vectorized.
+ *  `RoI_t` remains the Array of Structures (AoS) representation of one RoI, it is used by the tracking history and by
+ *  the text writers (see `features_get_RoI`).
+ */
+typedef struct {
+    uint32_t* id; /**< RoI unique identifiers (0 = filtered or uninitialized RoI). */
+    uint32_t* xmin; /**< Minimum \f$x\f$ coordinates of the bounding boxes. */
+    uint32_t* xmax; /**< Maximum \f$x\f$ coordinates of the bounding boxes. */
+    uint32_t* ymin; /**< Minimum \f$y\f$ coordinates of the bounding boxes. */
+    uint32_t* ymax; /**< Maximum \f$y\f$ coordinates of the bounding boxes. */
+    uint32_t* S; /**< Numbers of points/pixels = surfaces of the RoIs. */
+    uint32_t* Sx; /**< Sums of the \f$x\f$ coordinates of the points of the RoIs. */
+    uint32_t* Sy; /**< Sums of the \f$y\f$ coordinates of the points of the RoIs. */
+    float* x; /**< \f$x\f$ coordinates of the centroids (\f$ x = S_x / S \f$). */
+    float* y; /**< \f$y\f$ coordinates of the centroids (\f$ y = S_y / S \f$). */
+    uint32_t* prev_id; /**< Previous corresponding RoI identifiers (\f$RoI_{t - 1} \leftrightarrow RoI_{t}\f$). */
+    uint32_t* next_id; /**< Next corresponding RoI identifiers (\f$ RoI_{t} \leftrightarrow RoI_{t + 1}\f$). */
+    size_t _max_size; /**< Maximum number of RoIs that can be contained in the arrays. */
+} RoIs_t;
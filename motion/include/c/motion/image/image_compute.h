@@ -34,7 +34,7 @@ img_data_t* image_gs_alloc(const size_t img_height, const size_t img_width);
  * @param show_id Boolean to enable display of the label numbers (has no effect if the program has not be linked with
  *                the OpenCV library).
  */
-void image_gs_draw_labels(img_data_t* img_data, const uint32_t** labels, const RoI_t* RoIs, const size_t n_RoIs,
+void image_gs_draw_labels(img_data_t* img_data, const uint32_t** labels, const RoIs_t* RoIs, const size_t n_RoIs,
                           const uint8_t show_id);
 
 /**
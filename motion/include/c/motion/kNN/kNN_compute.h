@@ -12,7 +12,8 @@
 
 /**
  * Allocation of inner kNN data.
- * The `conflicts` field is allocated only if the `MOTION_ENABLE_DEBUG` macro is
+ * The working storage is not allocated here: it grows on demand in `kNN_match` depending on the actual numbers of RoIs
+ * (see `kNN_data_t::peak_bytes`). The `conflicts` field is allocated only if the `MOTION_ENABLE_DEBUG` macro is
  * defined.
  * @param max_size Maximum number of RoIs that can considered for associations.
  * @return Pointer of kNN data.
@@ -38,7 +39,7 @@ void kNN_init_data(kNN_data_t* kNN_data);
  *                    then the association is not made.
  * @return The number of associations.
  */
-uint32_t kNN_match(kNN_data_t* kNN_data, RoI_t* RoIs0, const size_t n_RoIs0, RoI_t* RoIs1, const size_t n_RoIs1,
+uint32_t kNN_match(kNN_data_t* kNN_data, RoIs_t* RoIs0, const size_t n_RoIs0, RoIs_t* RoIs1, const size_t n_RoIs1,
                    const int k, const uint32_t max_dist, const float min_ratio_S);
 
 /**
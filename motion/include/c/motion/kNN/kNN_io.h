@@ -20,5 +20,5 @@
  * @param RoIs1 Features at \f$t\f$.
  * @param n_RoIs1 Number of connected-components (= number of RoIs) (at \f$t\f$)..
  */
-void kNN_asso_conflicts_write(FILE* f, const kNN_data_t* kNN_data, const RoI_t* RoIs0, const size_t n_RoIs0,
-                              const RoI_t* RoIs1, const size_t n_RoIs1);
+void kNN_asso_conflicts_write(FILE* f, const kNN_data_t* kNN_data, const RoIs_t* RoIs0, const size_t n_RoIs0,
+                              const RoIs_t* RoIs1, const size_t n_RoIs1);
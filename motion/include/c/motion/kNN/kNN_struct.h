@@ -9,22 +9,53 @@
 
 /**
  *  Inner data structure required to compute associations between RoIs.
+ *  The \f$RoI_{t}\f$ centroids are bucketed in a uniform grid (the size of a cell is greater than the maximum
+ *  distance of association) so only the neighboring cells of a \f$RoI_{t-1}\f$ are searched. The ranked associations
+ *  (at most \f$k\f$ per \f$RoI_{t-1}\f$) are stored in a compressed sparse row (CSR) list and in its transposition.
+ *  All the arrays are allocated on demand (and reused over the frames) depending on the actual numbers of RoIs, their
+ *  sizes are given by the `_max_RoIs`, `_max_pairs` and `_max_cells` capacities.
  */
 typedef struct {
-    float** distances; /*!< 2D array of euclidean distances (\f$[\texttt{\_max\_size}][\texttt{\_max\_size}]\f$).
-                            \f$y\f$ axis represents RoIs at \f$t-1\f$ and \f$x\f$ axis represents RoIs at \f$t\f$.
-                            For instance, \f$\texttt{distances}[i][j]\f$ represents the distance between
-                            \f$RoI_{t-1}^i\f$ and \f$RoI_{t}^j\f$. Note that sometime, for efficiency reasons, the
-                            implementation may choose to store squared euclidean distances instead of euclidean
-                            distances. */
-    uint32_t** nearest; /*!< 2D array of ranks (\f$[\texttt{\_max\_size}][\texttt{\_max\_size}]\f$).
-                             \f$y\f$ axis represents RoIs at \f$t-1\f$ and \f$x\f$ axis represents RoIs at \f$t\f$.
-                             For instance, \f$\texttt{nearest}[i][j]\f$ represents the rank of \f$RoI_{t-1}^i\f$ and
-                             \f$RoI_{t}^j\f$. Rank = 1 means that \f$i\f$ and \f$j\f$ are the closest possible RoIs
-                             association, rank = 2 means that \f$i\f$ and \f$j\f$ are the second closest possible RoIs
-                             association, and so on. Rank = 0 means that \f$i\f$ and \f$j\f$ were not associated
-                             together (common reason is that they are too far from each others). */
-    uint32_t* conflicts; /*!< 1D array of conflicts (\f$[\texttt{\_max\_size}]\f$).
+    uint32_t* nearest_offset; /*!< CSR offsets of the ranked associations (\f$[\texttt{\_max\_RoIs} + 1]\f$).
+                                   The associations of \f$RoI_{t-1}^i\f$ are stored in the `nearest_*` arrays from
+                                   \f$\texttt{nearest\_offset}[i]\f$ to \f$\texttt{nearest\_offset}[i + 1]\f$
+                                   (excluded), sorted by rank: the association at position \f$p\f$ has the rank
+                                   \f$p - \texttt{nearest\_offset}[i] + 1\f$. Rank = 1 means that \f$i\f$ and \f$j\f$
+                                   are the closest possible RoIs association, rank = 2 means that \f$i\f$ and \f$j\f$
+                                   are the second closest possible RoIs association, and so on. RoIs that are not
+                                   in the list were not associated together (common reason is that they are too far
+                                   from each others). */
+    uint32_t* nearest_id; /*!< Index \f$j\f$ of \f$RoI_{t}^j\f$ for each association
+                               (\f$[\texttt{\_max\_pairs}]\f$). */
+    float* nearest_dist; /*!< Squared euclidean distance between \f$RoI_{t-1}^i\f$ and \f$RoI_{t}^j\f$ for each
+                              association (\f$[\texttt{\_max\_pairs}]\f$). */
+    float* nearest_ratio_S; /*!< Surface ratio \f$\min(S_i, S_j) / \max(S_i, S_j)\f$ between \f$RoI_{t-1}^i\f$ and
+                                 \f$RoI_{t}^j\f$ for each association (\f$[\texttt{\_max\_pairs}]\f$). */
+    float* pair_S; /*!< Scratch buffer, surface of \f$RoI_{t}^j\f$ for each association
+                        (\f$[\texttt{\_max\_pairs}]\f$). */
+    uint32_t* rev_offset; /*!< Offsets of the transposed CSR (\f$[\texttt{\_max\_RoIs} + 1]\f$). The associations of
+                               \f$RoI_{t}^j\f$ are stored in the `rev_*` arrays from \f$\texttt{rev\_offset}[j]\f$ to
+                               \f$\texttt{rev\_offset}[j + 1]\f$ (excluded), sorted by \f$i\f$. */
+    uint32_t* rev_id; /*!< Index \f$i\f$ of \f$RoI_{t-1}^i\f$ for each transposed association
+                           (\f$[\texttt{\_max\_pairs}]\f$). */
+    uint32_t* rev_pos; /*!< Position of each transposed association in the `nearest_*` arrays
+                            (\f$[\texttt{\_max\_pairs}]\f$). */
+    uint32_t* grid_offset; /*!< Offsets of the grid cells (\f$[\texttt{\_max\_cells} + 1]\f$). The \f$RoIs_{t}\f$ of
+                                the cell \f$c\f$ are stored in `grid_id` from \f$\texttt{grid\_offset}[c]\f$ to
+                                \f$\texttt{grid\_offset}[c + 1]\f$ (excluded). */
+    uint32_t* grid_id; /*!< Indexes of the \f$RoIs_{t}\f$ sorted by grid cell (\f$[\texttt{\_max\_RoIs}]\f$). */
+    float* grid_x; /*!< \f$x\f$ coordinates of the centroids of the \f$RoIs_{t}\f$ sorted by grid cell, the
+                        distances to the RoIs of consecutive cells are computed on contiguous memory
+                        (\f$[\texttt{\_max\_RoIs}]\f$). */
+    float* grid_y; /*!< \f$y\f$ coordinates of the centroids of the \f$RoIs_{t}\f$ sorted by grid cell
+                        (\f$[\texttt{\_max\_RoIs}]\f$). */
+    uint32_t* cand_id; /*!< Scratch buffer, candidates of the current \f$RoI_{t-1}\f$ (\f$[\texttt{\_max\_RoIs}]\f$). */
+    float* cand_dist; /*!< Scratch buffer, squared distances of the candidates (\f$[\texttt{\_max\_RoIs}]\f$). */
+    float* cand_sorted; /*!< Scratch buffer, the \f$k\f$ smallest squared distances of the candidates, sorted
+                             (\f$[\texttt{\_max\_RoIs}]\f$). */
+    uint32_t* cand_cpt; /*!< Scratch buffer, number of closer candidates for each candidate
+                             (\f$[\texttt{\_max\_RoIs}]\f$). */
+    uint32_t* conflicts; /*!< 1D array of conflicts (\f$[\texttt{\_max\_RoIs}]\f$).
                               A conflict happens when they are more than one \f$RoI_{t-1}\f$ that is the closet to
                               \f$RoI_{t}^j\f$.
                               \f$\texttt{conflicts}[j]\f$ contains 0 if there is no conflict.
@@ -32,5 +63,9 @@ typedef struct {
                               For instance if \f$RoI_{t-1}^{i1}\f$, \f$RoI_{t-1}^{i2}\f$ and \f$RoI_{t-1}^{i3}\f$ are
                               all the closest to \f$RoI_{t}^j\f$, then \f$\texttt{conflicts}[j] = 2\f$.
                               This buffer is allocated only if the MOTION_ENABLE_DEBUG macro is defined. */
-    size_t _max_size; /*!< Maximum number of RoIs allocated in the previous fields. */
+    size_t peak_bytes; /*!< Peak number of bytes allocated for the previous fields. */
+    size_t _max_size; /*!< Maximum number of RoIs that can be considered for associations. */
+    size_t _max_RoIs; /*!< Current capacity in number of RoIs of the previous fields. */
+    size_t _max_pairs; /*!< Current capacity in number of associations of the previous fields. */
+    size_t _max_cells; /*!< Current capacity in number of grid cells of `grid_offset`. */
 } kNN_data_t;
@@ -6,7 +6,7 @@
 #pragma once
 
 #include <stdint.h>
-#include <sys/time.h>
+#include <time.h>
 
 // MOTION_ENABLE_DEBUG : macro definissant le fonctionnement general des macros de debug
 
@@ -47,10 +47,16 @@
 #endif
 #define CLAMP(x, a, b) MIN(MAX(x, a), b)
 
+// bit-packed binary images: 1 bit per pixel, 64 pixels per `uint64_t` word, the pixel `j` of a row is the bit
+// `(j - j0) % 64` (LSB first) of the word `(j - j0) / 64`, the bits after `j1` in the last word are always 0
+#define PACKED_N_WORDS(j0, j1) (((j1) - (j0) + 64) / 64)
+#define PACKED_TAIL_MASK(j0, j1) (~(uint64_t)0 >> (63 - (((j1) - (j0)) % 64)))
+
+// monotonic clock (not affected by the system time updates), the time points keep a sub-microsecond resolution
 #define TIME_POINT(name) \
-    struct timeval t_##name; \
-    gettimeofday(&t_##name, NULL); \
-    double t_##name##_us = (double)(t_##name.tv_sec * 1e6 + t_##name.tv_usec);
+    struct timespec t_##name; \
+    clock_gettime(CLOCK_MONOTONIC, &t_##name); \
+    double t_##name##_us = (double)t_##name.tv_sec * 1e6 + (double)t_##name.tv_nsec * 1e-3;
 
 #define TIME_ELAPSED2_US(start_name, stop_name) (t_##stop_name##_us - t_##start_name##_us)
 #define TIME_ELAPSED2_MS(start_name, stop_name) (t_##stop_name##_us - t_##start_name##_us) * 1e-3
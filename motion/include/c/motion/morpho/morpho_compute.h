@@ -90,7 +90,8 @@ void morpho_compute_closing3(morpho_data_t* morpho_data, const uint8_t** img_in,
 /**
  * Convert binary image from 0/255 format to packed 1-bit format (8 pixels per byte).
  * @param img_in Input 2D binary image (0 or 255 per pixel).
- * @param img_packed Output packed image (8 pixels per byte).
+ * @param img_packed Output packed image (8 pixels per byte, \f$\lceil (j1 - j0 + 1) / 8 \rceil\f$ bytes per row, the
+ *                   bits after the last pixel are set to 0).
  * @param i0 First y index (included).
  * @param i1 Last y index (included).
  * @param j0 First x index (included).
@@ -136,3 +137,80 @@ void morpho_compute_opening3_packed(uint8_t** img_packed, uint8_t** tmp1, uint8_
  */
 void morpho_compute_closing3_packed(uint8_t** img_packed, uint8_t** tmp1, uint8_t** tmp2,
                                     const int i0, const int i1, const int jp0, const int jp1);
+
+// ============================================================================
+// 64-BIT PACKED FUNCTIONS (64 pixels per word, see PACKED_N_WORDS)
+// ============================================================================
+
+/**
+ * Convert binary image from 0/255 format to 64-bit packed format (64 pixels per word, see `PACKED_N_WORDS`).
+ * @param img_in Input 2D binary image (0 or 255 per pixel, any non-zero pixel is set).
+ * @param img_out Output packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$, the bits after
+ *                the last pixel are set to 0).
+ * @param i0 First \f$y\f$ index in the image (included).
+ * @param i1 Last \f$y\f$ index in the image (included).
+ * @param j0 First \f$x\f$ index in the image (included).
+ * @param j1 Last \f$x\f$ index in the image (included).
+ */
+void morpho_pack64(const uint8_t** img_in, uint64_t** img_out, const int i0, const int i1, const int j0,
+                   const int j1);
+
+/**
+ * Convert 64-bit packed format back to 0/255 format.
+ * @param img_in Input packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$).
+ * @param img_out Output 2D binary image (0 or 255 per pixel).
+ * @param i0 First \f$y\f$ index in the image (included).
+ * @param i1 Last \f$y\f$ index in the image (included).
+ * @param j0 First \f$x\f$ index in the image (included).
+ * @param j1 Last \f$x\f$ index in the image (included).
+ */
+void morpho_unpack64(const uint64_t** img_in, uint8_t** img_out, const int i0, const int i1, const int j0,
+                     const int j1);
+
+/**
+ * This function performs an opening (3x3 convolution) on a 64-bit packed binary image. The borders are processed as in
+ * `morpho_compute_opening3` (the result is the same, bit per byte).
+ * @param morpho_data Pointer of inner morpho data.
+ * @param img_in Input packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$).
+ * @param img_out Output packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$). Note that
+ *                \p img_in and \p img_out can be the same frame (in-place computing is supported).
+ * @param i0 First \f$y\f$ index in the image (included).
+ * @param i1 Last \f$y\f$ index in the image (included).
+ * @param j0 First \f$x\f$ index in the image (included).
+ * @param j1 Last \f$x\f$ index in the image (included).
+ */
+void morpho_compute_opening3_packed64(morpho_data_t* morpho_data, const uint64_t** img_in, uint64_t** img_out,
+                                      const int i0, const int i1, const int j0, const int j1);
+
+/**
+ * This function performs a closing (3x3 convolution) on a 64-bit packed binary image. The borders are processed as in
+ * `morpho_compute_closing3` (the result is the same, bit per byte).
+ * @param morpho_data Pointer of inner morpho data.
+ * @param img_in Input packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$).
+ * @param img_out Output packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$). Note that
+ *                \p img_in and \p img_out can be the same frame (in-place computing is supported).
+ * @param i0 First \f$y\f$ index in the image (included).
+ * @param i1 Last \f$y\f$ index in the image (included).
+ * @param j0 First \f$x\f$ index in the image (included).
+ * @param j1 Last \f$x\f$ index in the image (included).
+ */
+void morpho_compute_closing3_packed64(morpho_data_t* morpho_data, const uint64_t** img_in, uint64_t** img_out,
+                                      const int i0, const int i1, const int j0, const int j1);
+
+/**
+ * This function performs an opening (3x3 convolution) followed by a closing (3x3 convolution) on a 64-bit packed
+ * binary image. The result is the same as `morpho_compute_opening3_packed64` followed by
+ * `morpho_compute_closing3_packed64` but the 8 separable passes are fused: each thread streams a band of rows through
+ * all the passes, so the intermediate images are never written in memory.
+ * @param morpho_data Pointer of inner morpho data (`IB_words` is used to store the per-thread working sets).
+ * @param img_in Input packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$).
+ * @param img_out Output packed binary image (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$). Note that
+ *                \p img_in and \p img_out can be the same frame (in-place computing is supported).
+ * @param i0 First \f$y\f$ index in the image (included).
+ * @param i1 Last \f$y\f$ index in the image (included).
+ * @param j0 First \f$x\f$ index in the image (included).
+ * @param j1 Last \f$x\f$ index in the image (included).
+ */
+void morpho_compute_opening_closing3_packed64(morpho_data_t* morpho_data, const uint64_t** img_in,
+                                              uint64_t** img_out, const int i0, const int i1, const int j0,
+                                              const int j1);
@@ -20,4 +20,6 @@ typedef struct {
     uint8_t **IB_packed; /**< Packed binary image (8 pixels per byte). */
     uint8_t **IB_packed2; /**< Second packed temporary image. */
     uint8_t **IB_packed3; /**< Third packed temporary image. */
+    uint64_t **IB_words; /**< Temporary bit-packed binary image (64 pixels per word, see `PACKED_N_WORDS`). */
+    uint64_t **IB_words2; /**< Second temporary bit-packed binary image. */
 } morpho_data_t;
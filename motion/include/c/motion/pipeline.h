@@ -0,0 +1,8 @@
+/*!
+ * \file
+ * \brief Pipeline module (stage-pipelined execution of the detection chain).
+ */
+
+#pragma once
+
+#include "motion/pipeline/pipeline_struct.h"
@@ -0,0 +1,109 @@
+/*!
+ * \file
+ * \brief Pipeline structures (frame slots and bounded queues used to chain the stages of the detection chain).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "motion/features/features_struct.h"
+
+/**
+ *  Bounded blocking FIFO of slot indices. It connects two consecutive stages of the pipeline: the producer stage pushes
+ *  the index of a slot it has finished to work on, the consumer stage pops it. When the producer has nothing more to
+ *  produce it closes the queue, the consumer then drains the remaining indices and is notified of the end of stream.
+ */
+typedef struct {
+    size_t* items; /**< Circular buffer of slot indices (\f$[\texttt{\_max\_size}]\f$). */
+    size_t head; /**< Position of the next index to pop in `items`. */
+    size_t size; /**< Current number of indices in the queue. */
+    size_t _max_size; /**< Maximum number of indices that can be contained in the queue. */
+    uint8_t closed; /**< Boolean, 1 when the producer will not push anymore. */
+    pthread_mutex_t mutex; /**< Lock protecting all the previous fields. */
+    pthread_cond_t not_empty; /**< Signaled when an index is pushed or when the queue is closed. */
+    pthread_cond_t not_full; /**< Signaled when an index is popped. */
+} pipeline_queue_t;
+
+/**
+ *  Frame slot: all the data produced for one frame while it flows through the stages of the pipeline.
+ *  A slot is owned by one stage at a time, so its fields are never accessed concurrently.
+ */
+typedef struct {
+    int frame; /**< Frame id (as returned by the video reader). */
+    uint8_t** IG; /**< Grayscale input image (\f$[i1 - i0 + 1][j1 - j0 + 1]\f$). */
+    const uint8_t** IG_view; /**< Grayscale image read by the next stages: `IG` or a view on the frames kept in memory
+                                  by the video reader (\f$[i1 - i0 + 1][j1 - j0 + 1]\f$). */
+    const uint8_t** IG_rows; /**< Copy of the rows of the view, the video reader can reuse its rows array before the
+                                  slot is released (\f$[i1 - i0 + 1]\f$). */
+    uint8_t** IB; /**< Binary image after Sigma-Delta and morphology, NULL if the binary image is packed
+                       (\f$[i1 - i0 + 1][j1 - j0 + 1]\f$). */
+    uint64_t** IB_packed; /**< Packed binary image after Sigma-Delta and morphology (64 pixels per word), NULL if the
+                               binary image is not packed (\f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$). */
+    uint32_t** L2; /**< Labels after surface filtering, can be NULL (\f$[i1 - i0 + 1][j1 - j0 + 1]\f$). */
+    RoIs_t* RoIs; /**< Filtered RoIs of the frame. */
+    uint32_t n_RoIs; /**< Number of filtered RoIs in `RoIs`. */
+} pipeline_slot_t;
+
+/**
+ * Allocation of a bounded queue.
+ * @param max_size Maximum number of slot indices in the queue.
+ * @return Pointer of the allocated queue.
+ */
+pipeline_queue_t* pipeline_queue_alloc(const size_t max_size);
+
+/**
+ * Free a queue.
+ * @param queue Pointer of the queue.
+ */
+void pipeline_queue_free(pipeline_queue_t* queue);
+
+/**
+ * Push a slot index at the end of the queue. Blocks while the queue is full.
+ * @param queue Pointer of the queue.
+ * @param slot_id Index of the slot.
+ */
+void pipeline_queue_push(pipeline_queue_t* queue, const size_t slot_id);
+
+/**
+ * Pop the first slot index of the queue. Blocks while the queue is empty and not closed.
+ * @param queue Pointer of the queue.
+ * @param slot_id Return the index of the slot.
+ * @return 1 if an index has been popped, 0 if the queue is closed and empty (= end of stream).
+ */
+int pipeline_queue_pop(pipeline_queue_t* queue, size_t* slot_id);
+
+/**
+ * Close the queue: no more index will be pushed, waiting consumers are woken up.
+ * @param queue Pointer of the queue.
+ */
+void pipeline_queue_close(pipeline_queue_t* queue);
+
+/**
+ * Allocation of the frame slots.
+ * @param n_slots Number of slots.
+ * @param i0 First \f$y\f$ index in the images (included).
+ * @param i1 Last \f$y\f$ index in the images (included).
+ * @param j0 First \f$x\f$ index in the images (included).
+ * @param j1 Last \f$x\f$ index in the images (included).
+ * @param max_RoIs_size Maximum number of RoIs per slot.
+ * @param alloc_L2 Boolean, allocate the `L2` images or not.
+ * @param packed Boolean, allocate the packed binary images (`IB_packed`) instead of the byte ones (`IB`).
+ * @return Array of allocated slots (\f$[\texttt{n\_slots}]\f$).
+ */
+pipeline_slot_t* pipeline_slots_alloc(const size_t n_slots, const int i0, const int i1, const int j0, const int j1,
+                                      const size_t max_RoIs_size, const uint8_t alloc_L2, const uint8_t packed);
+
+/**
+ * Free the frame slots.
+ * @param slots Array of slots.
+ * @param n_slots Number of slots.
+ * @param i0 First \f$y\f$ index in the images (included).
+ * @param i1 Last \f$y\f$ index in the images (included).
+ * @param j0 First \f$x\f$ index in the images (included).
+ * @param j1 Last \f$x\f$ index in the images (included).
+ */
+void pipeline_slots_free(pipeline_slot_t* slots, const size_t n_slots, const int i0, const int i1, const int j0,
+                         const int j1);
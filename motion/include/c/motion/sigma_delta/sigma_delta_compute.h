@@ -38,6 +38,22 @@ void sigma_delta_init_data(sigma_delta_data_t* sd_data, const uint8_t** img, con
  */
 void sigma_delta_free_data(sigma_delta_data_t* sd_data);
 
+/**
+ * Select the instruction set of the Sigma-Delta kernels (for all the `sigma_delta_*` compute functions). Without a
+ * call to this function, `SD_ISA_AUTO` is selected at the first Sigma-Delta computation. The selection is global to
+ * the process, it has to be made before starting the processing threads.
+ * @param isa Instruction set, if it is not supported by the build or by the CPU the program is stopped.
+ * @return The selected instruction set (the widest one supported if `isa` is `SD_ISA_AUTO`).
+ */
+enum sigma_delta_isa_e sigma_delta_select_isa(const enum sigma_delta_isa_e isa);
+
+/**
+ * Check if the Sigma-Delta kernels of an instruction set can be selected.
+ * @param isa Instruction set (except `SD_ISA_AUTO`).
+ * @return 1 if the kernels have been compiled and if the CPU supports them, 0 otherwise.
+ */
+int sigma_delta_isa_supported(const enum sigma_delta_isa_e isa);
+
 /**
  * Sigma-Delta algorithm. Per-pixel computes if a pixel intensity changed over time.
  * @param sd_data Pointer of inner Sigma-Delta data.
@@ -53,10 +69,30 @@ void sigma_delta_free_data(sigma_delta_data_t* sd_data);
 void sigma_delta_compute(sigma_delta_data_t *sd_data, const uint8_t** img_in, uint8_t** img_out, const int i0,
                          const int i1, const int j0, const int j1, const uint8_t N);
 
+/**
+ * Sigma-Delta algorithm with a bit-packed output. Same as `sigma_delta_compute` except that the binary image is
+ * directly produced with 1 bit per pixel (64 pixels per word, see `PACKED_N_WORDS`), the byte image is never written.
+ * @param sd_data Pointer of inner Sigma-Delta data.
+ * @param img_in Input grayscale image (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$).
+ * @param img_out Output packed binary image (2D array \f$[i1 - i0 + 1][\texttt{PACKED\_N\_WORDS}(j0, j1)]\f$).
+ * @param i0 The first \f$y\f$ index in the image (included).
+ * @param i1 The last \f$y\f$ index in the image (included).
+ * @param j0 The first \f$x\f$ index in the image (included).
+ * @param j1 The last \f$x\f$ index in the image (included).
+ * @param N The Sigma-Delta parameter.
+ */
+void sigma_delta_compute_packed(sigma_delta_data_t *sd_data, const uint8_t** img_in, uint64_t** img_out, const int i0,
+                                const int i1, const int j0, const int j1, const uint8_t N);
+
 /**
  * Fused Sigma-Delta + Opening + Closing pipeline.
  * Combines Sigma-Delta motion detection with morphological opening and closing
  * in a single function to maximize cache utilization and reduce memory traffic.
+ * The image is strip-mined: each thread streams a horizontal band row by row
+ * through all the operators and keeps only a rolling window of 13 rows (in
+ * `tmp2`), the Sigma-Delta rows at the band edges are shared through `tmp1`.
+ * The result is the same as `sigma_delta_compute` followed by
+ * `morpho_compute_opening3` and `morpho_compute_closing3`.
  * 
  * @param sd_data Pointer of inner Sigma-Delta data.
  * @param img_in Input grayscale image (2D array).
@@ -7,6 +7,20 @@
 
 #include <stdint.h>
 
+/**
+ *  Instruction sets of the Sigma-Delta kernels. A kernel is specialized for each value of N from 1 to 4, the other
+ *  values use a generic kernel (saturating multiplication).
+ */
+enum sigma_delta_isa_e { SD_ISA_AUTO = 0, /*!< Widest instruction set supported by the CPU, detected at runtime. */
+                         SD_ISA_SCALAR, /*!< Plain C kernel, no SIMD. */
+                         SD_ISA_MIPP, /*!< MIPP kernel, the instruction set is the one given to the compiler (SSE2 by
+                                           default on x86, NEON on ARM). Requires `MOTION_USE_MIPP`. */
+                         SD_ISA_AVX2, /*!< AVX2 kernel, x86 only (built with GCC or Clang), whatever the compiler
+                                           flags. */
+                         SD_ISA_AVX512BW, /*!< AVX-512BW kernel, x86 only (built with GCC or Clang), whatever the
+                                               compiler flags. */
+};
+
 /**
  *  Inner Sigma-Delta data required to perform the Sigma-Delta algorithm.
  */
@@ -21,3 +35,17 @@ typedef struct {
     uint8_t **M; /**< Background image (= Mean image). */
     uint8_t **V; /**< Variance image. */
 } sigma_delta_data_t;
+
+/**
+ * Convert a string into a `sigma_delta_isa_e` enum value.
+ * @param str String that can be "AUTO", "SCALAR", "MIPP", "AVX2" or "AVX512BW".
+ * @return Corresponding enum value.
+ */
+enum sigma_delta_isa_e sigma_delta_str_to_isa(const char* str);
+
+/**
+ * Convert a `sigma_delta_isa_e` enum value into a string.
+ * @param isa Enum value.
+ * @return Corresponding string (same as the ones accepted by `sigma_delta_str_to_isa`).
+ */
+const char* sigma_delta_isa_to_str(const enum sigma_delta_isa_e isa);
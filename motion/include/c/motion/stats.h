@@ -0,0 +1,10 @@
+/*!
+ * \file
+ * \brief Statistics module (latency distributions of the tasks of the detection chain).
+ */
+
+#pragma once
+
+#include "motion/stats/stats_struct.h"
+#include "motion/stats/stats_compute.h"
+#include "motion/stats/stats_io.h"
@@ -0,0 +1,57 @@
+/*!
+ * \file
+ * \brief Record latencies (and hardware counters) into the histograms and compute their percentiles.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "motion/macros.h"
+#include "motion/stats/stats_struct.h"
+
+/**
+ * Time point (see `TIME_POINT`) plus a snapshot of the hardware counters (all zero if \p perf is NULL).
+ */
+#define STATS_POINT(perf, name) \
+    uint64_t c_##name[STATS_N_PERF]; \
+    stats_perf_read(perf, c_##name); \
+    TIME_POINT(name)
+
+/**
+ * Record the latency and the hardware counters between two points (see `STATS_POINT`) into a histogram.
+ */
+#define STATS_HIST_ADD(hist, start_name, stop_name) \
+    stats_hist_add(hist, (uint64_t)(TIME_ELAPSED2_US(start_name, stop_name) * 1e3)); \
+    stats_hist_add_perf(hist, c_##start_name, c_##stop_name);
+
+/**
+ * Record a latency into a histogram.
+ * @param hist Pointer of the histogram.
+ * @param ns Latency (in ns).
+ */
+void stats_hist_add(stats_hist_t* hist, const uint64_t ns);
+
+/**
+ * Accumulate the hardware counters of a task into its histogram.
+ * @param hist Pointer of the histogram.
+ * @param start Counters at the beginning of the task (\f$[\texttt{STATS\_N\_PERF}]\f$).
+ * @param stop Counters at the end of the task (\f$[\texttt{STATS\_N\_PERF}]\f$).
+ */
+void stats_hist_add_perf(stats_hist_t* hist, const uint64_t* start, const uint64_t* stop);
+
+/**
+ * Read the hardware counters of the calling thread.
+ * @param perf Pointer of the counters group, can be NULL.
+ * @param counters Return the counters, 0 for the counters that are not available (\f$[\texttt{STATS\_N\_PERF}]\f$).
+ */
+void stats_perf_read(const stats_perf_t* perf, uint64_t* counters);
+
+/**
+ * Compute a percentile of the recorded latencies. The result is the highest value of the bucket that contains the
+ * percentile (bounded by the maximum recorded latency), so it is never under-estimated.
+ * @param hist Pointer of the histogram.
+ * @param p Percentile in \f$[0;100]\f$.
+ * @return The latency (in ns), 0 if the histogram is empty.
+ */
+uint64_t stats_hist_percentile(const stats_hist_t* hist, const double p);
@@ -0,0 +1,54 @@
+/*!
+ * \file
+ * \brief IOs of the latency histograms and of the hardware counters.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#include "motion/stats/stats_struct.h"
+
+/**
+ * Print the latency distribution of each task (count, mean, p50, p90, p99 and max) followed by the busy time of each
+ * thread. All the lines start with a '#'.
+ * @param f File descriptor (in write mode).
+ * @param stats Pointer of the statistics data.
+ * @param wall_sec Wall time of the processing (in seconds), used to compute the occupancy of the threads.
+ */
+void stats_write_table(FILE* f, const stats_data_t* stats, const double wall_sec);
+
+/**
+ * Print the hardware counters of each task, averaged per call: kilo-cycles, instructions per cycle (IPC), kilo-misses
+ * in the L1D and in the last level cache (LLC), kilo-branch-misses, and the bytes moved from the memory estimated from
+ * the LLC misses (one cache line per miss) with the resulting bandwidth. Nothing is printed if no counter has been
+ * recorded. All the lines start with a '#'.
+ * @param f File descriptor (in write mode).
+ * @param stats Pointer of the statistics data.
+ */
+void stats_write_perf_table(FILE* f, const stats_data_t* stats);
+
+/**
+ * Write the latency distribution of each task in CSV (one line per task, latencies in ms). If hardware counters have
+ * been recorded, their averages per call are added (empty fields for the unavailable counters).
+ * @param f File descriptor (in write mode).
+ * @param stats Pointer of the statistics data.
+ */
+void stats_write_csv(FILE* f, const stats_data_t* stats);
+
+/**
+ * Write the latency distribution of each task and the busy time of each thread in JSON (latencies in ms). If hardware
+ * counters have been recorded, their averages per call are added (null for the unavailable counters).
+ * @param f File descriptor (in write mode).
+ * @param stats Pointer of the statistics data.
+ * @param wall_sec Wall time of the processing (in seconds).
+ */
+void stats_write_json(FILE* f, const stats_data_t* stats, const double wall_sec);
+
+/**
+ * Write the latency distributions in a file, in JSON if the file extension is ".json" and in CSV otherwise.
+ * @param path Path of the file.
+ * @param stats Pointer of the statistics data.
+ * @param wall_sec Wall time of the processing (in seconds).
+ */
+void stats_write_file(const char* path, const stats_data_t* stats, const double wall_sec);
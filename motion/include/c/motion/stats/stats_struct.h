@@ -0,0 +1,110 @@
+/*!
+ * \file
+ * \brief Statistics structures (log-bucketed latency histograms and hardware performance counters).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ *  Number of bits of precision kept in a bucket index: each power of two is split in \f$2^{\texttt{SUB\_BITS}}\f$
+ *  linear sub-buckets, the relative error of a recorded value is then lower than \f$2^{-\texttt{SUB\_BITS}}\f$ (3%).
+ */
+#define STATS_SUB_BITS 5
+#define STATS_N_SUB (1 << STATS_SUB_BITS)
+/**
+ *  Number of buckets to cover the full `uint64_t` range (in ns): the values lower than `STATS_N_SUB` have their own
+ *  bucket, then one group of `STATS_N_SUB` buckets per power of two.
+ */
+#define STATS_N_BUCKETS ((64 - STATS_SUB_BITS + 1) * STATS_N_SUB)
+
+/**
+ *  Enumeration of the hardware performance counters.
+ */
+enum stats_perf_e { STATS_PERF_CYCLES = 0, /*!< CPU cycles. */
+                    STATS_PERF_INSTRUCTIONS, /*!< Retired instructions. */
+                    STATS_PERF_L1D_MISSES, /*!< L1 data cache read misses. */
+                    STATS_PERF_LLC_MISSES, /*!< Last level cache misses. */
+                    STATS_PERF_BRANCH_MISSES, /*!< Mispredicted branches. */
+                    STATS_N_PERF /*!< Number of counters in the enumeration. */
+};
+
+/**
+ *  Group of hardware performance counters (`perf_event_open`) of the calling thread. The counters only count the
+ *  events of the thread that opened them (user space only), they are all read at once.
+ */
+typedef struct {
+    int fds[STATS_N_PERF]; /**< File descriptors of the counters, -1 if a counter is not available. */
+    int pos[STATS_N_PERF]; /**< Position of each counter in the group read, -1 if a counter is not available. */
+    int leader; /**< File descriptor of the group leader (the first available counter). */
+    int n_open; /**< Number of available counters. */
+    uint32_t mask; /**< Bit `c` is set if the counter `c` is available. */
+} stats_perf_t;
+
+/**
+ *  Histogram of the latencies of one task. The values are recorded in nanoseconds. A histogram is only written by the
+ *  thread that runs the task.
+ */
+typedef struct {
+    const char* task; /**< Name of the task. */
+    const char* thread; /**< Name of the thread that runs the task. */
+    uint64_t count; /**< Number of recorded latencies. */
+    uint64_t sum_ns; /**< Sum of the recorded latencies. */
+    uint64_t min_ns; /**< Minimum recorded latency. */
+    uint64_t max_ns; /**< Maximum recorded latency. */
+    uint64_t* buckets; /**< Number of recorded latencies per bucket (\f$[\texttt{STATS\_N\_BUCKETS}]\f$). */
+    uint64_t perf[STATS_N_PERF]; /**< Sum of the hardware counters (see `stats_perf_e`). */
+} stats_hist_t;
+
+/**
+ *  Set of histograms, one per task of the detection chain.
+ */
+typedef struct {
+    stats_hist_t* hists; /**< Histograms (\f$[\texttt{\_max\_size}]\f$). */
+    size_t n_hists; /**< Number of histograms in use. */
+    size_t _max_size; /**< Maximum number of histograms. */
+    uint32_t perf_mask; /**< Bit `c` is set if the hardware counter `c` is recorded, 0 if there is no counter. */
+} stats_data_t;
+
+/**
+ * Allocation of the histograms.
+ * @param max_size Maximum number of histograms (= tasks).
+ * @return Pointer of the allocated statistics data.
+ */
+stats_data_t* stats_alloc_data(const size_t max_size);
+
+/**
+ * Initialization of the histograms: remove all the tasks.
+ * @param stats Pointer of the statistics data.
+ */
+void stats_init_data(stats_data_t* stats);
+
+/**
+ * Add a task and its (empty) histogram. The returned pointer stays valid until the statistics data are freed.
+ * @param stats Pointer of the statistics data.
+ * @param task Name of the task (the string is not copied).
+ * @param thread Name of the thread that runs the task (the string is not copied).
+ * @return Pointer of the histogram of the task.
+ */
+stats_hist_t* stats_add_hist(stats_data_t* stats, const char* task, const char* thread);
+
+/**
+ * Free the histograms.
+ * @param stats Pointer of the statistics data.
+ */
+void stats_free_data(stats_data_t* stats);
+
+/**
+ * Open the hardware performance counters of the calling thread. If the counters can't be opened (unsupported platform,
+ * not allowed by `/proc/sys/kernel/perf_event_paranoid`, ...), a warning is printed.
+ * @return Pointer of the counters group, NULL if no counter is available.
+ */
+stats_perf_t* stats_perf_alloc(void);
+
+/**
+ * Close the hardware performance counters.
+ * @param perf Pointer of the counters group (can be NULL).
+ */
+void stats_perf_free(stats_perf_t* perf);
@@ -0,0 +1,9 @@
+/*!
+ * \file
+ * \brief Synthetic scene module (procedural rendering of moving objects, used to benchmark without video files).
+ */
+
+#pragma once
+
+#include "motion/synth/synth_struct.h"
+#include "motion/synth/synth_compute.h"
@@ -0,0 +1,53 @@
+/*!
+ * \file
+ * \brief Synthetic scene rendering.
+ */
+
+#pragma once
+
+#include "motion/synth/synth_struct.h"
+
+/**
+ * Allocation of a synthetic scene.
+ * @param i0 The first \f$y\f$ index in the image (included).
+ * @param i1 The last \f$y\f$ index in the image (included).
+ * @param j0 The first \f$x\f$ index in the image (included).
+ * @param j1 The last \f$x\f$ index in the image (included).
+ * @param n_objs Number of moving objects.
+ * @param obj_size Mean diameter of the objects (in pixels).
+ * @param obj_speed Maximum speed of the objects along each axis (in pixels per frame).
+ * @param noise Ratio of the pixels replaced by a random value in each frame (in \f$[0;1]\f$).
+ * @param seed Seed of the pseudo-random generator.
+ * @return The allocated scene.
+ */
+synth_data_t* synth_alloc_data(const int i0, const int i1, const int j0, const int j1, const size_t n_objs,
+                               const float obj_size, const float obj_speed, const float noise, const uint64_t seed);
+
+/**
+ * Initialization of a synthetic scene: the objects are placed from the seed.
+ * @param synth_data Pointer of the scene.
+ */
+void synth_init_data(synth_data_t* synth_data);
+
+/**
+ * Free a synthetic scene.
+ * @param synth_data Pointer of the scene.
+ */
+void synth_free_data(synth_data_t* synth_data);
+
+/**
+ * Render a grayscale frame: a static gradient background, the objects at their position in the frame and the impulse
+ * noise.
+ * @param synth_data Pointer of the scene.
+ * @param frame Frame id.
+ * @param img Output grayscale image (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$).
+ */
+void synth_render_gray(const synth_data_t* synth_data, const size_t frame, uint8_t** img);
+
+/**
+ * Render a binary frame: the pixels of the objects and of the impulse noise are set to 255, the others to 0.
+ * @param synth_data Pointer of the scene.
+ * @param frame Frame id.
+ * @param img Output binary image (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$, \f$\{0,255\}\f$).
+ */
+void synth_render_binary(const synth_data_t* synth_data, const size_t frame, uint8_t** img);
@@ -0,0 +1,46 @@
+/*!
+ * \file
+ * \brief Synthetic scene structures.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ *  Number of fractional bits of the fixed-point positions and speeds of the objects (the rendering only uses integer
+ *  arithmetic, so the frames are bit-exact whatever the compiler and the target).
+ */
+#define SYNTH_FP_BITS 8
+
+/**
+ *  Moving object of a synthetic scene: a filled ellipse that moves in straight line and bounces on the image borders.
+ */
+typedef struct {
+    int64_t x; /**< \f$x\f$ coordinate of the center at frame 0, relative to \f$j0\f$ (fixed-point). */
+    int64_t y; /**< \f$y\f$ coordinate of the center at frame 0, relative to \f$i0\f$ (fixed-point). */
+    int64_t dx; /**< \f$x\f$ speed (fixed-point, in pixels per frame). */
+    int64_t dy; /**< \f$y\f$ speed (fixed-point, in pixels per frame). */
+    int rx; /**< Horizontal radius (in pixels). */
+    int ry; /**< Vertical radius (in pixels). */
+    uint8_t value; /**< Gray level of the object. */
+} synth_obj_t;
+
+/**
+ *  Synthetic scene: a static background crossed by moving objects, plus impulse noise. A frame only depends on the
+ *  parameters of the scene and on its id, so the frames can be rendered in any order and the rendering is
+ *  deterministic (bit-exact) from the seed.
+ */
+typedef struct {
+    int i0; /**< First \f$y\f$ index in the image (included). */
+    int i1; /**< Last \f$y\f$ index in the image (included). */
+    int j0; /**< First \f$x\f$ index in the image (included). */
+    int j1; /**< Last \f$x\f$ index in the image (included). */
+    size_t n_objs; /**< Number of moving objects. */
+    float obj_size; /**< Mean diameter of the objects (in pixels). */
+    float obj_speed; /**< Maximum speed of the objects along each axis (in pixels per frame). */
+    float noise; /**< Ratio of the pixels replaced by a random value in each frame (in \f$[0;1]\f$). */
+    uint64_t seed; /**< Seed of the pseudo-random generator. */
+    synth_obj_t* objs; /**< Moving objects (\f$[\texttt{n\_objs}]\f$). */
+} synth_data_t;
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <stdio.h>
+
 #include "motion/features/features_struct.h"
 #include "motion/tracking/tracking_struct.h"
 
@@ -41,6 +43,18 @@ void tracking_free_data(tracking_data_t* tracking_data);
  * @param min_extrapol_ratio_S Minimum ratio between two RoIs. \f$ r_S = RoI_{S}^j / RoI_{S}^i\f$, if
  *                             \f$r_S < r_S^{min}\f$ then the association for the extrapolation is not made.
  */
-void tracking_perform(tracking_data_t* tracking_data, const RoI_t* RoIs, const size_t n_RoIs, size_t frame,
+void tracking_perform(tracking_data_t* tracking_data, const RoIs_t* RoIs, const size_t n_RoIs, size_t frame,
                       const size_t r_extrapol, const size_t fra_obj_min, const uint8_t save_RoIs_id,
                       const uint8_t extrapol_order_max, const float min_extrapol_ratio_S);
+
+/**
+ * Write the finished tracks (or all the tracks) into a file and remove them from the tracks vector. The number of
+ * active tracks and the memory footprint of the tracking then do not depend on the length of the video anymore.
+ * The tracks are written in the order they are removed, in the format of `tracking_tracks_write` (one line per
+ * track).
+ * @param tracking_data Inner data.
+ * @param f File descriptor (in write mode).
+ * @param only_finished Boolean, if 1 only the finished tracks are flushed, else all the tracks are flushed.
+ * @return The number of flushed tracks.
+ */
+size_t tracking_tracks_flush(tracking_data_t* tracking_data, FILE* f, const uint8_t only_finished);
@@ -9,6 +9,19 @@
 
 #include "motion/tracking/tracking_struct.h"
 
+/**
+ * Print the header of the table of tracks (columns only).
+ * @param f File descriptor (in write mode).
+ */
+void tracking_tracks_write_header(FILE* f);
+
+/**
+ * Print a track as a line of the table of tracks.
+ * @param f File descriptor (in write mode).
+ * @param track The track to print.
+ */
+void tracking_track_write(FILE* f, const track_t* track);
+
 /**
  * Print a table of tracks (dedicated to the terminal).
  * @param f File descriptor (in write mode).
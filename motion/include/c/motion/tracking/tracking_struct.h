@@ -63,27 +63,72 @@ typedef track_t* vec_track_t;
 
 /**
  *  History of the previous RoI features and motions.
- *  This structure allows to access RoI/motion in the past frames.
- *  RoIs at \f$t\f$ are stored in the first array element while RoIs at \f$t-\texttt{\_size}\f$ are store in the
- *  \f$\texttt{\_size} - 1\f$ element.
+ *  This structure allows to access RoI/motion in the past frames. It is a circular buffer of `_max_size` slots: the
+ *  RoIs at \f$t - a\f$ (\f$a\f$ is the age, \f$0 \leq a < \texttt{\_size}\f$) are stored in the
+ *  \f$(\texttt{\_head} + a) \bmod \texttt{\_max\_size}\f$ slot. Adding a new frame only moves `_head` backward
+ *  (the oldest slot is recycled), the slots are never shifted nor cleared.
  *  The memory layout is a Structure of Arrays (SoA), each field is an array of `_max_size` capacity (except for
- * `_max_size` itself and `_size` fields that are both scalar values).
+ * `_max_size`, `_head` and `_size` fields that are scalar values).
  */
 typedef struct {
-    RoI4track_t** RoIs; /**< 2D array of RoIs, the first dimension is the time and the second dimension is the RoIs at a
-                             given time. */
-    uint32_t* n_RoIs; /**< Array of numbers of RoIs. */
+    RoI4track_t** RoIs; /**< 2D array of RoIs, the first dimension is the slot and the second dimension is the RoIs at
+                             a given time. A slot is NULL until it is used for the first time. */
+    uint32_t* n_RoIs; /**< Array of numbers of RoIs (per slot). */
     uint32_t _max_n_RoIs; /**< Maximum number of RoIs. */
+    size_t _head; /**< Slot of the most recent frame (age 0). */
     size_t _size; /**< Current size/utilization of the fields. */
     size_t _max_size; /**< Maximum capacity of data that can be contained in the fields. */
 } History_t;
 
+/**
+ *  Tail of a track: identifier and centroid of its last RoI. A new track is not created if a previous track has the
+ *  same tail (duplicated track).
+ */
+typedef struct {
+    uint32_t id; /**< RoI identifier (0 in the empty buckets of a `tails_set_t`). */
+    float x; /**< \f$x\f$ coordinate of the centroid. */
+    float y; /**< \f$y\f$ coordinate of the centroid. */
+    uint32_t frame; /**< Frame of the last RoI, or frame where the track has been finished (in `finished_tails`). It
+                         is not a part of the key. */
+} track_tail_t;
+
+/**
+ *  Open-addressing hash set (linear probing) of track tails, used to detect the duplicated tracks in \f$O(1)\f$.
+ */
+typedef struct {
+    track_tail_t* keys; /**< Buckets (\f$[\texttt{\_max\_size}]\f$). */
+    size_t size; /**< Number of tails in the set. */
+    size_t _max_size; /**< Number of buckets (power of 2). */
+} tails_set_t;
+
 /**
  *  Inner data used by the tracking.
  */
 typedef struct {
-    vec_track_t tracks; /**< Vector of tracks. */
+    vec_track_t tracks; /**< Vector of tracks (sorted by identifier). The finished tracks can be removed from it with
+                             `tracking_tracks_flush`. */
+    vec_uint32_t active; /**< Positions in `tracks` of the tracks that are not finished (in increasing order). */
+    uint32_t last_id; /**< Identifier of the last created track. */
+    size_t n_flushed; /**< Number of tracks that have been removed from `tracks` by `tracking_tracks_flush`. */
+    tails_set_t tails; /**< Tails of the tracks that are not finished, rebuilt after each frame (the tracks created
+                            during a frame are added as they are created). */
+    tails_set_t finished_tails; /**< Tails of the tracks finished during the last \f$\texttt{history->\_max\_size}\f$
+                                     frames: a new track is not created on the tail of a recently finished one. The
+                                     older tails are ignored and removed when the set is resized, so its size does not
+                                     grow with the length of the sequence. It is not cleared by
+                                     `tracking_tracks_flush`. */
     History_t* history; /**< RoIs and motions history. */
+    float grid_cell_size; /**< Side of the cells of the spatial grid over the RoIs of the current frame (at least
+                               \f$r_{extrapol} + 1\f$, so the RoIs closer than \f$r_{extrapol}\f$ to a point are in
+                               the 3x3 cells around it). */
+    uint32_t grid_n_cols; /**< Number of cells along the \f$x\f$ axis of the spatial grid. */
+    uint32_t grid_n_rows; /**< Number of cells along the \f$y\f$ axis of the spatial grid. */
+    uint32_t* grid_offset; /**< CSR offsets of the spatial grid: the RoIs of the cell \f$c\f$ are in
+                                `grid_id[grid_offset[c]:grid_offset[c + 1]]`
+                                (\f$[\texttt{grid\_n\_rows} \times \texttt{grid\_n\_cols} + 1]\f$). */
+    uint32_t* grid_id; /**< Positions in the most recent slot of `history` of the RoIs sorted by grid cell
+                            (\f$[\texttt{history->\_max\_n\_RoIs}]\f$). */
+    size_t _max_cells; /**< Number of cells that can be stored in `grid_offset` (grows on demand). */
     RoI4track_t* RoIs_list; /**< List of RoIs. This is a temporary array used to group all the RoIs belonging to a same
                                  track. */
 } tracking_data_t;
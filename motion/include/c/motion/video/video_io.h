@@ -9,14 +9,15 @@
 
 /**
  * Allocation and initialization of inner data required for a video reader.
- * @param path Path to the video or images.
+ * @param path Path to the video or images, or synthetic scene (see `VIDEO_SYNTH_PREFIX`).
  * @param start Start frame number (first frame is frame 0).
  * @param end Last frame number (if 0 then the video sequence is entirely read).
  * @param skip Number of frames to skip between two frames (0 means no frame is skipped).
  * @param bufferize Boolean to store the entire video sequence in memory first (this is useful for benchmarks
  *                  but usually the video sequences are too big to be stored in memory).
  * @param n_ffmpeg_threads Number of threads used in FFMPEG to decode the video sequence (0 means FFMPEG will decide).
- * @param codec_type Select the API to use for video codec (`VCDC_FFMPEG_IO` or `VCDC_VCODECS_IO`).
+ * @param codec_type Select the API to use for video codec (`VCDC_FFMPEG_IO`, `VCDC_VCODECS_IO`, `VCDC_LIBAV`,
+ *                   `VCDC_YUV_MMAP` or `VCDC_SYNTH`). A synthetic scene path always selects `VCDC_SYNTH`.
  * @param hwaccel Select Hardware accelerator (`VCDC_HWACCEL_NONE`, `VCDC_HWACCEL_NVDEC`, `VCDC_HWACCEL_VIDEOTOOLBOX`).
  *                A NULL value will default to `VCDC_HWACCEL_NONE`.
  * @param i0 Return the first \f$y\f$ index in the labels (included).
@@ -30,6 +31,20 @@ video_reader_t* video_reader_alloc_init(const char* path, const size_t start, co
                                         const enum video_codec_e codec_type, const enum video_codec_hwaccel_e hwaccel,
                                         int* i0, int* i1, int* j0, int* j1);
 
+/**
+ * Start to prefetch the frames: from now on a dedicated I/O thread reads up to `depth` frames ahead into a pool of
+ * preallocated images, so the decoding overlaps the processing of the current frame. This has no effect if the video
+ * sequence has been bufferized. The thread is stopped by `video_reader_free`.
+ * @param video A pointer of previously allocated inner video reader data (`loop_size` has to be set before).
+ * @param depth Maximum number of frames read in advance (has to be higher than 0).
+ * @param i0 First \f$y\f$ index in the images (included).
+ * @param i1 Last \f$y\f$ index in the images (included).
+ * @param j0 First \f$x\f$ index in the images (included).
+ * @param j1 Last \f$x\f$ index in the images (included).
+ */
+void video_reader_prefetch_start(video_reader_t* video, const size_t depth, const int i0, const int i1, const int j0,
+                                 const int j1);
+
 /**
  * Write grayscale image in a given 2D array.
  * @param video A pointer of previously allocated inner video reader data.
@@ -38,6 +53,21 @@ video_reader_t* video_reader_alloc_init(const char* path, const size_t start, co
  */
 int video_reader_get_frame(video_reader_t* video, uint8_t** img);
 
+/**
+ * Get a read-only view on the next grayscale image. If the video sequence has been bufferized, the view points
+ * directly into the frames buffer and `img` is left untouched (no copy), the view remains valid until the video reader
+ * is freed. When the frames are prefetched, the view points into the prefetching pool and remains valid until the
+ * second next call (the two last frames can be used together). With the `VCDC_YUV_MMAP` reader, the rows point into the
+ * file mapping: the pixels remain valid until the video reader is freed but the array of rows is reused after the
+ * second next call. Otherwise the image is decoded into `img` and the view is `img`.
+ * @param video A pointer of previously allocated inner video reader data.
+ * @param img Grayscale image used when the video sequence is not bufferized (2D array
+ *            \f$[i1 - i0 + 1][j1 - j0 + 1]\f$).
+ * @param frame Return the view on the grayscale image (2D array \f$[i1 - i0 + 1][j1 - j0 + 1]\f$).
+ * @return The frame id (positive integer) or -1 if there is no more frame to read.
+ */
+int video_reader_get_frame_view(video_reader_t* video, uint8_t** img, const uint8_t*** frame);
+
 /**
  * Deallocation of inner video reader data.
  * @param video A pointer of video reader inner data.
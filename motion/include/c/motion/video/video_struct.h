@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <pthread.h>
 
 /**
  *  Video codec enumeration
@@ -15,8 +16,25 @@ enum video_codec_e { VCDC_FFMPEG_IO = 0, /*!< Library calling the `ffmpeg` execu
                                               system pipes. */
                      VCDC_VCODECS_IO, /*!< Library based on `AVCodec` library calls. It should be faster than
                                            `VCDC_FFMPEG_IO`. */
+                     VCDC_LIBAV, /*!< In-process decoding with the `libavformat` and `libavcodec` libraries, the
+                                      grayscale image is the luma plane of the decoded frames (experimental, not
+                                      validated against `VCDC_FFMPEG_IO` yet). */
+                     VCDC_YUV_MMAP, /*!< Raw I420 (`.yuv`, the dimensions are given in the file name) or Y4M
+                                         (`.y4m`) file mapped in memory, the grayscale image is the Y plane of the
+                                         frames (no decoding and no copy). */
+                     VCDC_SYNTH, /*!< Synthetic scene rendered directly into the grayscale image (no file), selected
+                                      by a path starting with `VIDEO_SYNTH_PREFIX`. */
 };
 
+/**
+ *  Prefix of the paths of the synthetic scenes: 'synth://[WxH][?key=value[&key=value...]]', the keys are 'objs'
+ *  (number of moving objects), 'size' (mean diameter in pixels), 'speed' (maximum speed in pixels per frame), 'noise'
+ *  (ratio of noisy pixels per frame), 'seed' and 'frames' (number of frames, 0 means endless). For instance
+ *  'synth://1280x720?objs=500&size=6&noise=0.01&seed=42'. The frames are deterministic from the parameters (see
+ *  `synth_data_t`).
+ */
+#define VIDEO_SYNTH_PREFIX "synth://"
+
 /**
  * Video codec hardware acceleration enumeration
  */
@@ -26,11 +44,38 @@ enum video_codec_hwaccel_e {
     VCDC_HWACCEL_VIDEOTOOLBOX, /*!< Use Videotoolbox on Apple devices. */
 };
 
+/**
+ *  Frames prefetching: a dedicated I/O thread reads the next frames into a pool of preallocated slots while the chain
+ *  computes. The slots are used as a lock-free single-producer single-consumer ring: the frame \f$n\f$ is read in the
+ *  slot \f$n \bmod \texttt{n\_slots}\f$, the I/O thread only writes `produced` and the reader only writes `consumed`
+ *  and `released`. A thread that finds the ring full (or empty) spins briefly and then sleeps on a condition variable,
+ *  the other thread only takes the lock to wake it up.
+ */
+typedef struct {
+    size_t n_slots; /*!< Number of frame slots (prefetching depth + the frames still held by the reader). */
+    uint8_t*** slots; /*!< Frame slots (\f$[\texttt{n\_slots}][i1 - i0 + 1][j1 - j0 + 1]\f$). */
+    int* slots_frame; /*!< Frame id of each slot, -1 marks the end of the video sequence. */
+    int i0, i1, j0, j1; /*!< Dimension of the frames. */
+    size_t produced; /*!< Number of frames read by the I/O thread. */
+    uint8_t _pad0[64 - sizeof(size_t)]; /*!< Keep `produced` and `released` on separate cache lines. */
+    size_t released; /*!< Number of slots given back by the reader. */
+    uint8_t _pad1[64 - sizeof(size_t)]; /*!< Keep `released` and `consumed` on separate cache lines. */
+    size_t consumed; /*!< Number of frames returned to the reader. */
+    uint8_t stop; /*!< Boolean, set by the reader to stop the I/O thread before the end of the video sequence. */
+    uint8_t producer_waiting; /*!< Boolean, the I/O thread sleeps on `cond_released` (the ring is full). */
+    uint8_t consumer_waiting; /*!< Boolean, the reader sleeps on `cond_produced` (the ring is empty). */
+    pthread_mutex_t lock; /*!< Protects the sleeps on the condition variables. */
+    pthread_cond_t cond_produced; /*!< Signaled when a frame is produced and the reader sleeps. */
+    pthread_cond_t cond_released; /*!< Signaled when slots are released (or `stop` is set) and the I/O thread sleeps. */
+    pthread_t thread; /*!< I/O thread. */
+} video_prefetch_t;
+
 /**
  *  Video reader structure.
  */
 typedef struct {
-    enum video_codec_e codec_type; /*!< Video decoder type (`VCDC_FFMPEG_IO` or `VCDC_VCODECS_IO`). */
+    enum video_codec_e codec_type; /*!< Video decoder type (`VCDC_FFMPEG_IO`, `VCDC_VCODECS_IO`,
+                                        `VCDC_LIBAV`, `VCDC_YUV_MMAP` or `VCDC_SYNTH`). */
     void* metadata; /*!< Internal metadata used by the video decoder. */
     size_t frame_start; /*!< Start frame number (first frame is frame 0). */
     size_t frame_end; /*!< Last frame number. */
@@ -38,12 +83,16 @@ typedef struct {
     size_t frame_current; /*!< Current frame number (always starts to 0, even if `frame_start` > 0). */
     char path[2048]; /*!< Path to the video or images. */
 
-    uint8_t*** fra_buffer; /*!< Buffer containing the all frames in memory (may be allocated or not depending on the
-                                implementation). */
+    uint8_t* fra_arena; /*!< Contiguous memory area containing all the frames when the video sequence is bufferized
+                             (NULL otherwise), it is aligned on huge pages to limit the TLB misses. */
+    size_t fra_arena_size; /*!< Size of `fra_arena` in bytes. */
+    uint8_t*** fra_buffer; /*!< Rows of the buffered frames, they point into `fra_arena` (may be allocated or not
+                                depending on the implementation). */
     size_t fra_count; /*!< Number of frames in `fra_buffer` array. */
     size_t loop_size; /*!< Number of times the video sequence should be played in loop (1 means that the video sequence
                            is played once). */
     size_t cur_loop; /*!< Current loop. */
+    video_prefetch_t* prefetch; /*!< Frames prefetching, NULL if the frames are read synchronously. */
 } video_reader_t;
 
 /**
@@ -65,7 +114,8 @@ typedef struct {
 
 /**
  * Convert a string into an `video_codec_e` enum value
- * @param str String that can be "FFMPEG-IO" or "VCODECS-IO" (if the code has been linked with vcodecs-io library)
+ * @param str String that can be "FFMPEG-IO", "VCODECS-IO" (if the code has been linked with vcodecs-io library),
+ *            "LIBAV" (if the code has been compiled with `MOTION_USE_LIBAV`), "YUV-MMAP" or "SYNTH"
  * @return Corresponding enum value.
  */
 enum video_codec_e video_str_to_enum(const char* str);
@@ -39,7 +39,7 @@ visu_data_t* visu_alloc_init(const char* path, const size_t start, const size_t
  * @param tracks A vector of tracks.
  * @param frame_id the current frame id.
  */
-void visu_display(visu_data_t* visu, const uint8_t** img, const RoI_t* RoIs, const size_t n_RoIs,
+void visu_display(visu_data_t* visu, const uint8_t** img, const RoIs_t* RoIs, const size_t n_RoIs,
                   const vec_track_t tracks, const uint32_t frame_id);
 
 /**
@@ -68,6 +68,9 @@ typedef struct ffmpeg_handle {
   FILE* pipe;
   ffmpeg_descriptor input, output;
   ffmpeg_error error;
+  int eof; // the reader reached the end of the pipe
+  unsigned char* buffer; // page-aligned frame buffer of the reader (only for the frames with non-contiguous rows)
+  size_t buffer_size;
 } ffmpeg_handle;
 typedef struct ffmpeg_options {
   const char* window_title;
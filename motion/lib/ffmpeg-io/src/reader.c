@@ -1,12 +1,107 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // F_SETPIPE_SZ
+#endif
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "constants.h"
 #include "cmd.h"
 #include "formatter.h"
 #include "ffmpeg-io/reader.h"
 
+#define FFMPEG_PAGE_SIZE 4096
+#define FFMPEG_PIPE_MIN_SIZE 65536 // default capacity of a pipe on Linux
+
+// Enlarge the pipe capacity up to the size of a frame so ffmpeg can write a whole frame without waiting for the reader.
+// Unprivileged processes are limited by /proc/sys/fs/pipe-max-size, so the size is halved until the kernel accepts it.
+static void ffmpeg_enlarge_pipe(ffmpeg_handle* h) {
+#ifdef F_SETPIPE_SZ
+  size_t size = (size_t)h->output.width * h->output.height * ffmpeg_pixel_size(h->output.pixfmt);
+  int fd = fileno(h->pipe);
+  for (; size > FFMPEG_PIPE_MIN_SIZE; size /= 2) {
+    if (fcntl(fd, F_SETPIPE_SZ, (int)size) != -1) break;
+  }
+#else
+  (void)h;
+#endif
+}
+
+static void ffmpeg_reader_opened(ffmpeg_handle* h) {
+  h->eof = 0; // the pipe is only read with read(2), the stdio buffer of the FILE* is never used
+  ffmpeg_enlarge_pipe(h);
+}
+
+// Read exactly `size` bytes from the pipe (looping on the short reads), return the number of bytes read.
+static size_t ffmpeg_read_full(ffmpeg_handle* h, void* out, size_t size) {
+  int fd = fileno(h->pipe);
+  size_t n = 0;
+  while (n < size) {
+    ssize_t r = read(fd, (char*)out + n, size - n);
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    if (r == 0) {
+      h->eof = 1;
+      break;
+    }
+    n += (size_t)r;
+  }
+  return n;
+}
+
+// Read a whole frame of `height` rows of `row_size` bytes. When the rows are not contiguous, the frame is read in the
+// page-aligned buffer of the handle then dispatched in the rows.
+static int ffmpeg_read_frame(ffmpeg_handle* h, uint8_t* const* rows, uint8_t* data, size_t pitch, size_t row_size,
+                             size_t height) {
+  int contiguous = 1;
+  if (rows != NULL) {
+    data = rows[0];
+    for (size_t i = 1; i < height && contiguous; i++) contiguous = rows[i] == rows[i - 1] + row_size;
+  } else {
+    contiguous = pitch == row_size;
+  }
+
+  size_t size = row_size * height;
+  unsigned char* dst = data;
+  if (!contiguous) {
+    if (h->buffer_size < size) {
+      free(h->buffer);
+      h->buffer = NULL;
+      h->buffer_size = 0;
+      void* buffer;
+      if (posix_memalign(&buffer, FFMPEG_PAGE_SIZE, size) != 0) {
+        h->error = ffmpeg_unknown_error;
+        return 0;
+      }
+      h->buffer = (unsigned char*)buffer;
+      h->buffer_size = size;
+    }
+    dst = h->buffer;
+  }
+
+  size_t read = ffmpeg_read_full(h, dst, size);
+  if (read == 0 && h->eof) {
+    h->error = ffmpeg_eof_error;
+    return 0;
+  }
+  if (read < size) {
+    h->error = ffmpeg_partial_read;
+    return 0;
+  }
+
+  if (!contiguous) {
+    for (size_t i = 0; i < height; i++) {
+      memcpy(rows != NULL ? rows[i] : data + i * pitch, h->buffer + i * row_size, row_size);
+    }
+  }
+  return 1;
+}
+
 int ffmpeg_start_reader_cmd_raw(ffmpeg_handle* h, const char* command) {
   ffmpeg_formatter cmd;
   ffmpeg_formatter_init(&cmd);
@@ -17,6 +112,8 @@ int ffmpeg_start_reader_cmd_raw(ffmpeg_handle* h, const char* command) {
   if (!h->pipe) {
     h->error = ffmpeg_pipe_error;
     success = 0;
+  } else {
+    ffmpeg_reader_opened(h);
   }
   ffmpeg_formatter_fini(&cmd);
   return success;
@@ -148,6 +245,8 @@ int ffmpeg_start_reader(ffmpeg_handle* h, const char* filename, const ffmpeg_opt
   if (!h->pipe) {
     h->error = ffmpeg_pipe_error;
     success = 0;
+  } else {
+    ffmpeg_reader_opened(h);
   }
   ffmpeg_formatter_fini(&cmd);
   return success;
@@ -160,13 +259,14 @@ int ffmpeg_read_raw(ffmpeg_handle* h, size_t size, size_t nmemb, void* out) {
     h->error = ffmpeg_closed_pipe;
     return 0;
   }
-  if (feof(pipe)) {
+  if (h->eof) {
     h->error = ffmpeg_eof_error;
     return 0;
   }
+  if (size == 0) return 0;
 
-  size_t n = fread(out, size, nmemb, pipe);
-  if (n == 0 && feof(pipe)) {
+  size_t n = ffmpeg_read_full(h, out, size * nmemb) / size;
+  if (n == 0 && h->eof) {
     h->error = ffmpeg_eof_error;
   } else if (n < nmemb) {
     h->error = ffmpeg_partial_read;
@@ -185,7 +285,7 @@ int ffmpeg_read1d(ffmpeg_handle* h, uint8_t* data, size_t pitch) {
     h->error = ffmpeg_closed_pipe;
     return 0;
   }
-  if (feof(pipe)) {
+  if (h->eof) {
     h->error = ffmpeg_eof_error;
     return 0;
   }
@@ -202,19 +302,7 @@ int ffmpeg_read1d(ffmpeg_handle* h, uint8_t* data, size_t pitch) {
     return 0;
   }
 
-  for (size_t i = 0; i < height; i++) {
-    size_t read = fread(data, elsize, width, pipe);
-    if (i == 0 && read == 0 && feof(pipe)) {
-      h->error = ffmpeg_eof_error;
-      return 0;
-    }
-    if (read < width) {
-      h->error = ffmpeg_partial_read;
-      return 0;
-    }
-    data += pitch;
-  }
-  return 1;
+  return ffmpeg_read_frame(h, NULL, data, pitch, elsize * width, height);
 }
 
 int ffmpeg_read2d(ffmpeg_handle* h, uint8_t** data) {
@@ -228,7 +316,7 @@ int ffmpeg_read2d(ffmpeg_handle* h, uint8_t** data) {
     h->error = ffmpeg_closed_pipe;
     return 0;
   }
-  if (feof(pipe)) {
+  if (h->eof) {
     h->error = ffmpeg_eof_error;
     return 0;
   }
@@ -245,18 +333,7 @@ int ffmpeg_read2d(ffmpeg_handle* h, uint8_t** data) {
     return 0;
   }
 
-  for (size_t i = 0; i < height; i++) {
-    size_t read = fread(data[i], elsize, width, pipe);
-    if (i == 0 && read == 0 && feof(pipe)) {
-      h->error = ffmpeg_eof_error;
-      return 0;
-    }
-    if (read < width) {
-      h->error = ffmpeg_partial_read;
-      return 0;
-    }
-  }
-  return 1;
+  return ffmpeg_read_frame(h, data, NULL, 0, elsize * width, height);
 }
 
 int ffmpeg_stop_reader(ffmpeg_handle* h) {
@@ -265,5 +342,8 @@ int ffmpeg_stop_reader(ffmpeg_handle* h) {
   if (p != NULL) {
     pclose(p);
   }
+  free(h->buffer);
+  h->buffer = NULL;
+  h->buffer_size = 0;
   return 1;
 }
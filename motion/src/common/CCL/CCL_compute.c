@@ -3,7 +3,11 @@
 #include <string.h>
 #include <stdio.h>
 #include <nrc2.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
+#include "motion/macros.h"
 #include "motion/CCL/CCL_compute.h"
 
 CCL_data_t* CCL_LSL_alloc_data(int i0, int i1, int j0, int j1) {
@@ -15,8 +19,9 @@ CCL_data_t* CCL_LSL_alloc_data(int i0, int i1, int j0, int j1) {
     long n = (CCL_data->i1 - CCL_data->i0 + 1) * (CCL_data->j1 - CCL_data->j0 + 1);
     CCL_data->er = ui32matrix(CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
     //CCL_data->ea = ui32matrix(CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
-    CCL_data->era = ui32matrix(CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
-    CCL_data->rlc = ui32matrix(CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
+    // a row of width `w` can contain up to `w + 1` segment begins/ends (and so relative labels)
+    CCL_data->era = ui32matrix(CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1 + 1);
+    CCL_data->rlc = ui32matrix(CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1 + 1);
     CCL_data->eq = ui32vector(0, n);
     CCL_data->ner = ui32vector(CCL_data->i0, CCL_data->i1);
     return CCL_data;
@@ -24,8 +29,8 @@ CCL_data_t* CCL_LSL_alloc_data(int i0, int i1, int j0, int j1) {
 
 void CCL_LSL_init_data(CCL_data_t* CCL_data) {
     zero_ui32matrix(CCL_data->er , CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
-    zero_ui32matrix(CCL_data->era , CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
-    zero_ui32matrix(CCL_data->rlc , CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
+    zero_ui32matrix(CCL_data->era , CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1 + 1);
+    zero_ui32matrix(CCL_data->rlc , CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1 + 1);
     long n = (CCL_data->i1 - CCL_data->i0 + 1) * (CCL_data->j1 - CCL_data->j0 + 1);
     zero_ui32vector(CCL_data->eq, 0, n);
     zero_ui32vector(CCL_data->ner, CCL_data->i0, CCL_data->i1);
@@ -35,8 +40,8 @@ void CCL_LSL_free_data(CCL_data_t* CCL_data) {
     long n = (CCL_data->i1 - CCL_data->i0 + 1) * (CCL_data->j1 - CCL_data->j0 + 1);
     free_ui32matrix(CCL_data->er, CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
     //free_ui32matrix(CCL_data->ea, CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
-    free_ui32matrix(CCL_data->era, CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
-    free_ui32matrix(CCL_data->rlc, CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1);
+    free_ui32matrix(CCL_data->era, CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1 + 1);
+    free_ui32matrix(CCL_data->rlc, CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1 + 1);
     free_ui32vector(CCL_data->eq, 0, n);
     free_ui32vector(CCL_data->ner, CCL_data->i0, CCL_data->i1);
     free(CCL_data);
@@ -227,6 +232,18 @@ void _LSL_compute_final_image_labeling_features(const uint32_t** CCL_data_er, co
     }
 }
 
+static uint32_t _LSL_equivalence_resolution(uint32_t* CCL_data_eq, const uint32_t nea) {
+    uint32_t trueN = 0;
+    for (uint32_t i = 0; i < nea; i++) {
+        if (i != CCL_data_eq[i]) {
+            CCL_data_eq[i] = CCL_data_eq[CCL_data_eq[i]];
+        } else {
+            CCL_data_eq[i] = trueN++;
+        }
+    }
+    return trueN;
+}
+
 uint32_t __CCL_LSL_apply(uint32_t** CCL_data_er, uint32_t** CCL_data_era, uint32_t** CCL_data_rlc,
                          uint32_t* CCL_data_eq, uint32_t* CCL_data_ner, const uint8_t** img, const int i0, const int i1,
                          const int j0, const int j1) {
@@ -245,24 +262,15 @@ uint32_t __CCL_LSL_apply(uint32_t** CCL_data_er, uint32_t** CCL_data_era, uint32
     // Step #3 - Relative to Absolute label conversion
 
     // Step #4 - Resolution of equivalence classes
-    uint32_t trueN = 0;
-    for (uint32_t i = 0; i < nea; i++) {
-        if (i != CCL_data_eq[i]) {
-            CCL_data_eq[i] = CCL_data_eq[CCL_data_eq[i]];
-        } else {
-            CCL_data_eq[i] = trueN++;
-        }
-    }
-
-    return trueN;
+    return _LSL_equivalence_resolution(CCL_data_eq, nea);
 }
 
 uint32_t _CCL_LSL_apply(uint32_t** CCL_data_er, uint32_t** CCL_data_era, uint32_t** CCL_data_rlc, uint32_t* CCL_data_eq,
                         uint32_t* CCL_data_ner, const uint8_t** img, uint32_t** labels, const int i0, const int i1,
                         const int j0, const int j1, const uint8_t no_init_labels) {
-    if (!no_init_labels)
+    if (labels && !no_init_labels)
         for (int i = i0; i <= i1; i++)
-            memset(labels[i], 0, sizeof(uint32_t) * ((j1 - j0) + 1));
+            memset(labels[i] + j0, 0, sizeof(uint32_t) * ((j1 - j0) + 1));
 
     // Step #1 - Segment detection
     for (int i = i0; i <= i1; i++)
@@ -271,9 +279,10 @@ uint32_t _CCL_LSL_apply(uint32_t** CCL_data_er, uint32_t** CCL_data_era, uint32_
     uint32_t trueN = __CCL_LSL_apply(CCL_data_er, CCL_data_era, CCL_data_rlc, CCL_data_eq, CCL_data_ner, img, i0, i1,
                                      j0, j1);
 
-    _LSL_compute_final_image_labeling((const uint32_t**)CCL_data_er, (const uint32_t**)CCL_data_era,
-                                      (const uint32_t**)CCL_data_rlc, (const uint32_t*)CCL_data_eq,
-                                      (const uint32_t*)CCL_data_ner, labels, i0, i1);
+    if (labels)
+        _LSL_compute_final_image_labeling((const uint32_t**)CCL_data_er, (const uint32_t**)CCL_data_era,
+                                          (const uint32_t**)CCL_data_rlc, (const uint32_t*)CCL_data_eq,
+                                          (const uint32_t*)CCL_data_ner, labels, i0, i1);
     return trueN;
 }
 
@@ -281,3 +290,374 @@ uint32_t CCL_LSL_apply(CCL_data_t* CCL_data, const uint8_t** img, uint32_t** lab
     return _CCL_LSL_apply(CCL_data->er, CCL_data->era, CCL_data->rlc, CCL_data->eq, CCL_data->ner, img, labels,
                           CCL_data->i0, CCL_data->i1, CCL_data->j0, CCL_data->j1, no_init_labels);
 }
+
+// ============================================================================
+// 64-BIT PACKED INPUT
+// The binary image is packed 64 pixels per word (see PACKED_N_WORDS in
+// macros.h). The segments are directly extracted from the transitions between
+// neighbor bits, so the relative labels (`er`) are never written: the
+// adjacent segments of the previous line are found by walking its run-length
+// coding in parallel with the one of the current line.
+// ============================================================================
+
+static void _LSL_segment_detection_packed(uint32_t* line_rlc, uint32_t* line_ner, const uint64_t* img_line,
+                                          const int j0, const int j1) {
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    uint32_t er = 0;
+    uint64_t carry = 0;
+    for (int w = 0; w < n_words; w++) {
+        const uint64_t x = img_line[w];
+        uint64_t f = x ^ ((x << 1) | carry); // Xor: front detection (bit b is set if pixel b differs from pixel b - 1)
+        carry = x >> 63;
+        while (f) {
+            const int j = j0 + w * 64 + __builtin_ctzll(f);
+            line_rlc[er] = j - (er & 1); // Begin/End of segment
+            er++;
+            f &= f - 1;
+        }
+    }
+    if (er & 1) // The last segment ends on the last pixel
+        line_rlc[er++] = j1;
+    *line_ner = er;
+}
+
+static void _LSL_equivalence_construction_packed(uint32_t* CCL_data_eq, const uint32_t* line_rlc, uint32_t* line_era,
+                                                 const uint32_t* prevline_rlc, const uint32_t* prevline_era,
+                                                 const int n, const int prev_n, const int x0, const int x1,
+                                                 uint32_t* nea) {
+    int p = 0; // First segment of the previous line that can be adjacent to the current one
+    for (int k = 0; k < n; k += 2) {
+        const int er = k + 1;
+
+        int j0 = line_rlc[k];  // Segment begin
+        int j1 = line_rlc[er]; // Segment end (k+1)
+
+        // Extends for 8-connected
+        if (j0 > x0)
+            j0 -= 1;
+        if (j1 < x1)
+            j1 += 1;
+
+        // Skip the segments of the previous line that end before the current one
+        while (p < prev_n && (int)prevline_rlc[p + 1] < j0)
+            p += 2;
+
+        if (p < prev_n && (int)prevline_rlc[p] <= j1) { // Adjacency -> connect components
+            uint32_t a = CCL_data_eq[prevline_era[p + 1]];
+            for (int q = p + 2; q < prev_n && (int)prevline_rlc[q] <= j1; q += 2) {
+                uint32_t ak = CCL_data_eq[prevline_era[q + 1]];
+                while (ak != CCL_data_eq[ak]) {
+                    ak = CCL_data_eq[ak];
+                }
+                if (a < ak) {
+                    CCL_data_eq[ak] = a; // Minimum propagation
+                }
+
+                if (a > ak) {
+                    CCL_data_eq[a] = ak;
+                    a = ak;
+                }
+            }
+            line_era[er] = a; // Global minimum
+        } else {              // No adjacency -> new label
+            line_era[er] = *nea;
+            CCL_data_eq[*nea] = *nea;
+            (*nea)++;
+        }
+    }
+}
+
+static void _LSL_compute_final_image_labeling_packed(const uint32_t** CCL_data_era, const uint32_t** CCL_data_rlc,
+                                                     const uint32_t* CCL_data_eq, const uint32_t* CCL_data_ner,
+                                                     uint32_t** labels, const int i0, const int i1) {
+    for (int i = i0; i <= i1; i++) {
+        uint32_t n = CCL_data_ner[i];
+        for (uint32_t k = 0; k < n; k += 2) {
+            int a = CCL_data_rlc[i][k];
+            int b = CCL_data_rlc[i][k + 1];
+
+            // Step #3 merged with step #5 (the relative label of the segment is `k + 1`)
+            uint32_t val = CCL_data_eq[CCL_data_era[i][k + 1]] + 1;
+
+            for (int j = a; j <= b; j++) {
+                labels[i][j] = val;
+            }
+        }
+    }
+}
+
+uint32_t CCL_LSL_apply_packed(CCL_data_t* CCL_data, const uint64_t** img, uint32_t** labels,
+                              const uint8_t no_init_labels) {
+    const int i0 = CCL_data->i0, i1 = CCL_data->i1, j0 = CCL_data->j0, j1 = CCL_data->j1;
+    if (labels && !no_init_labels)
+        for (int i = i0; i <= i1; i++)
+            memset(labels[i] + j0, 0, sizeof(uint32_t) * ((j1 - j0) + 1));
+
+    // Step #1 - Segment detection
+    for (int i = i0; i <= i1; i++)
+        _LSL_segment_detection_packed(CCL_data->rlc[i], &CCL_data->ner[i], img[i], j0, j1);
+
+    // Step #2 - Equivalence construction
+    uint32_t nea = i0;
+    uint32_t n = CCL_data->ner[i0];
+    for (uint32_t k = 0; k < n; k += 2) {
+        CCL_data->eq[nea] = nea;
+        CCL_data->era[i0][k + 1] = nea++;
+    }
+    for (int i = i0 + 1; i <= i1; i++)
+        _LSL_equivalence_construction_packed(CCL_data->eq, CCL_data->rlc[i], CCL_data->era[i], CCL_data->rlc[i - 1],
+                                             CCL_data->era[i - 1], CCL_data->ner[i], CCL_data->ner[i - 1], j0, j1,
+                                             &nea);
+
+    // Step #4 - Resolution of equivalence classes
+    uint32_t trueN = _LSL_equivalence_resolution(CCL_data->eq, nea);
+
+    // Step #5 - Final image labeling
+    if (labels)
+        _LSL_compute_final_image_labeling_packed((const uint32_t**)CCL_data->era, (const uint32_t**)CCL_data->rlc,
+                                                 (const uint32_t*)CCL_data->eq, (const uint32_t*)CCL_data->ner,
+                                                 labels, i0, i1);
+    return trueN;
+}
+
+// ============================================================================
+// PARALLEL LSL
+// The image is split into horizontal bands labeled independently (one band
+// per thread). The band `b` starting at row `b0` uses the absolute labels from
+// `i0 + (b0 - i0) * max_runs`, so the labels of a band are all higher than the
+// ones of the previous bands and the labels are still sorted in the raster
+// order. Then the segments of the first row of each band are merged with the
+// adjacent segments of the last row of the previous band (union-find, the
+// lowest label is the root). As in the sequential version, each equivalence
+// class is represented by its lowest label, so the final numbering is the
+// same.
+// ============================================================================
+
+// Minimum number of rows in a band
+#define CCL_PAR_MIN_BAND 16
+
+static uint32_t _LSL_find_root(const uint32_t* CCL_data_eq, uint32_t a) {
+    while (a != CCL_data_eq[a])
+        a = CCL_data_eq[a];
+    return a;
+}
+
+static void _LSL_border_merge(uint32_t* CCL_data_eq, const uint32_t* line_rlc, const uint32_t* line_era,
+                              const uint32_t* prevline_rlc, const uint32_t* prevline_era, const int n,
+                              const int prev_n, const int x0, const int x1) {
+    int p = 0; // First segment of the previous line that can be adjacent to the current one
+    for (int k = 0; k < n; k += 2) {
+        int j0 = line_rlc[k];
+        int j1 = line_rlc[k + 1];
+
+        // Extends for 8-connected
+        if (j0 > x0)
+            j0 -= 1;
+        if (j1 < x1)
+            j1 += 1;
+
+        while (p < prev_n && (int)prevline_rlc[p + 1] < j0)
+            p += 2;
+
+        for (int q = p; q < prev_n && (int)prevline_rlc[q] <= j1; q += 2) {
+            const uint32_t a = _LSL_find_root(CCL_data_eq, line_era[k + 1]);
+            const uint32_t b = _LSL_find_root(CCL_data_eq, prevline_era[q + 1]);
+            if (a < b)
+                CCL_data_eq[b] = a;
+            else if (b < a)
+                CCL_data_eq[a] = b;
+        }
+    }
+}
+
+static uint32_t _CCL_LSL_apply_par(CCL_data_t* CCL_data, const uint8_t** img, const uint64_t** img_packed,
+                                   uint32_t** labels, const uint8_t no_init_labels) {
+    const int i0 = CCL_data->i0, i1 = CCL_data->i1, j0 = CCL_data->j0, j1 = CCL_data->j1;
+    const int height = i1 - i0 + 1;
+    const uint32_t max_runs = (j1 - j0 + 2) / 2; // maximum number of segments in a row
+#ifdef _OPENMP
+    const int max_bands = MAX(1, MIN(omp_get_max_threads(), height / CCL_PAR_MIN_BAND));
+#else
+    const int max_bands = 1;
+#endif
+    int* bands_b0 = (int*)malloc(max_bands * sizeof(int));
+    uint32_t* bands_nea = (uint32_t*)malloc(max_bands * sizeof(uint32_t));
+    int n_bands = 1;
+    uint32_t trueN = 0;
+
+    #pragma omp parallel num_threads(max_bands)
+    {
+#ifdef _OPENMP
+        const int t = omp_get_thread_num();
+        const int n_threads = omp_get_num_threads();
+#else
+        const int t = 0;
+        const int n_threads = 1;
+#endif
+        const int b0 = i0 + (int)(((long)height * t) / n_threads);
+        const int b1 = i0 + (int)(((long)height * (t + 1)) / n_threads) - 1;
+        bands_b0[t] = b0;
+        if (t == 0)
+            n_bands = n_threads;
+
+        // Step #1 - Segment detection
+        for (int i = b0; i <= b1; i++) {
+            if (labels && !no_init_labels)
+                memset(labels[i] + j0, 0, sizeof(uint32_t) * ((j1 - j0) + 1));
+            if (img_packed)
+                _LSL_segment_detection_packed(CCL_data->rlc[i], &CCL_data->ner[i], img_packed[i], j0, j1);
+            else
+                _LSL_segment_detection(CCL_data->er[i], CCL_data->rlc[i], &CCL_data->ner[i], img[i], j0, j1);
+        }
+
+        // Step #2 - Equivalence construction (in the band)
+        uint32_t nea = i0 + (b0 - i0) * max_runs;
+        uint32_t n = CCL_data->ner[b0];
+        for (uint32_t k = 0; k < n; k += 2) {
+            CCL_data->eq[nea] = nea;
+            CCL_data->era[b0][k + 1] = nea++;
+        }
+        for (int i = b0 + 1; i <= b1; i++)
+            _LSL_equivalence_construction_packed(CCL_data->eq, CCL_data->rlc[i], CCL_data->era[i],
+                                                 CCL_data->rlc[i - 1], CCL_data->era[i - 1], CCL_data->ner[i],
+                                                 CCL_data->ner[i - 1], j0, j1, &nea);
+        bands_nea[t] = nea;
+
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            // Step #2 bis - Equivalence construction (between the bands)
+            for (int b = 1; b < n_bands; b++) {
+                const int i = bands_b0[b];
+                _LSL_border_merge(CCL_data->eq, CCL_data->rlc[i], CCL_data->era[i], CCL_data->rlc[i - 1],
+                                  CCL_data->era[i - 1], CCL_data->ner[i], CCL_data->ner[i - 1], j0, j1);
+            }
+
+            // Step #4 - Resolution of equivalence classes (the labels are visited in increasing order)
+            for (int b = 0; b < n_bands; b++) {
+                for (uint32_t i = i0 + (bands_b0[b] - i0) * max_runs; i < bands_nea[b]; i++) {
+                    if (i != CCL_data->eq[i]) {
+                        CCL_data->eq[i] = CCL_data->eq[CCL_data->eq[i]];
+                    } else {
+                        CCL_data->eq[i] = trueN++;
+                    }
+                }
+            }
+        }
+
+        // Step #5 - Final image labeling
+        if (labels)
+            _LSL_compute_final_image_labeling_packed((const uint32_t**)CCL_data->era,
+                                                     (const uint32_t**)CCL_data->rlc, (const uint32_t*)CCL_data->eq,
+                                                     (const uint32_t*)CCL_data->ner, labels, b0, b1);
+    }
+
+    free(bands_b0);
+    free(bands_nea);
+    return trueN;
+}
+
+uint32_t CCL_LSL_apply_par(CCL_data_t* CCL_data, const uint8_t** img, uint32_t** labels,
+                           const uint8_t no_init_labels) {
+    return _CCL_LSL_apply_par(CCL_data, img, NULL, labels, no_init_labels);
+}
+
+uint32_t CCL_LSL_apply_packed_par(CCL_data_t* CCL_data, const uint64_t** img, uint32_t** labels,
+                                  const uint8_t no_init_labels) {
+    return _CCL_LSL_apply_par(CCL_data, NULL, img, labels, no_init_labels);
+}
+
+// ============================================================================
+// CCL + CCA
+// The features of the connected-components are computed from the segments
+// (one update per segment instead of one per pixel): the sum of the `x`
+// coordinates of the segment [a, b] is the arithmetic series (a + b) * n / 2.
+// ============================================================================
+
+static void _LSL_compute_features(const uint32_t** CCL_data_era, const uint32_t** CCL_data_rlc,
+                                  const uint32_t* CCL_data_eq, const uint32_t* CCL_data_ner, const int i0,
+                                  const int i1, const int j0, const int j1, RoIs_t* RoIs, const size_t n_RoIs) {
+    uint32_t* RoIs_xmin = RoIs->xmin;
+    uint32_t* RoIs_xmax = RoIs->xmax;
+    uint32_t* RoIs_ymin = RoIs->ymin;
+    uint32_t* RoIs_ymax = RoIs->ymax;
+    uint32_t* RoIs_S = RoIs->S;
+    uint32_t* RoIs_Sx = RoIs->Sx;
+    uint32_t* RoIs_Sy = RoIs->Sy;
+    for (size_t r = 0; r < n_RoIs; r++) {
+        RoIs->id[r] = r + 1;
+        RoIs_xmin[r] = j1;
+        RoIs_xmax[r] = j0;
+        RoIs_ymin[r] = i1;
+        RoIs_ymax[r] = i0;
+    }
+    memset(RoIs_S, 0, n_RoIs * sizeof(uint32_t));
+    memset(RoIs_Sx, 0, n_RoIs * sizeof(uint32_t));
+    memset(RoIs_Sy, 0, n_RoIs * sizeof(uint32_t));
+
+    for (int i = i0; i <= i1; i++) {
+        const uint32_t n = CCL_data_ner[i];
+        for (uint32_t k = 0; k < n; k += 2) {
+            const uint32_t a = CCL_data_rlc[i][k];
+            const uint32_t b = CCL_data_rlc[i][k + 1];
+            const uint32_t len = b - a + 1;
+            const uint32_t r = CCL_data_eq[CCL_data_era[i][k + 1]];
+            RoIs_S[r] += len;
+            RoIs_Sx[r] += ((a + b) * len) / 2;
+            RoIs_Sy[r] += (uint32_t)i * len;
+            if (a < RoIs_xmin[r])
+                RoIs_xmin[r] = a;
+            if (b > RoIs_xmax[r])
+                RoIs_xmax[r] = b;
+            if ((uint32_t)i < RoIs_ymin[r])
+                RoIs_ymin[r] = i;
+            if ((uint32_t)i > RoIs_ymax[r])
+                RoIs_ymax[r] = i;
+        }
+    }
+
+    for (size_t r = 0; r < n_RoIs; r++) {
+        RoIs->x[r] = (float)RoIs_Sx[r] / (float)RoIs_S[r];
+        RoIs->y[r] = (float)RoIs_Sy[r] / (float)RoIs_S[r];
+    }
+}
+
+uint32_t CCL_LSL_apply_features(CCL_data_t* CCL_data, const uint8_t** img, uint32_t** labels, RoIs_t* RoIs,
+                                const uint8_t par) {
+    const uint32_t n_RoIs = par ? CCL_LSL_apply_par(CCL_data, img, labels, 0) :
+                                  CCL_LSL_apply(CCL_data, img, labels, 0);
+    _LSL_compute_features((const uint32_t**)CCL_data->era, (const uint32_t**)CCL_data->rlc,
+                          (const uint32_t*)CCL_data->eq, (const uint32_t*)CCL_data->ner, CCL_data->i0, CCL_data->i1,
+                          CCL_data->j0, CCL_data->j1, RoIs, n_RoIs);
+    return n_RoIs;
+}
+
+uint32_t CCL_LSL_apply_packed_features(CCL_data_t* CCL_data, const uint64_t** img, uint32_t** labels, RoIs_t* RoIs,
+                                       const uint8_t par) {
+    const uint32_t n_RoIs = par ? CCL_LSL_apply_packed_par(CCL_data, img, labels, 0) :
+                                  CCL_LSL_apply_packed(CCL_data, img, labels, 0);
+    _LSL_compute_features((const uint32_t**)CCL_data->era, (const uint32_t**)CCL_data->rlc,
+                          (const uint32_t*)CCL_data->eq, (const uint32_t*)CCL_data->ner, CCL_data->i0, CCL_data->i1,
+                          CCL_data->j0, CCL_data->j1, RoIs, n_RoIs);
+    return n_RoIs;
+}
+
+void CCL_LSL_write_labels(const CCL_data_t* CCL_data, uint32_t** labels, const uint32_t* remap) {
+    const int j0 = CCL_data->j0, j1 = CCL_data->j1;
+    #pragma omp parallel for schedule(static)
+    for (int i = CCL_data->i0; i <= CCL_data->i1; i++) {
+        memset(labels[i] + j0, 0, sizeof(uint32_t) * ((j1 - j0) + 1));
+        const uint32_t n = CCL_data->ner[i];
+        for (uint32_t k = 0; k < n; k += 2) {
+            const uint32_t a = CCL_data->rlc[i][k];
+            const uint32_t b = CCL_data->rlc[i][k + 1];
+            uint32_t val = CCL_data->eq[CCL_data->era[i][k + 1]] + 1;
+            if (remap)
+                val = remap[val];
+            if (val)
+                for (uint32_t j = a; j <= b; j++)
+                    labels[i][j] = val;
+        }
+    }
+}
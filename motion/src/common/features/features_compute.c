@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
@@ -8,32 +9,75 @@
 
 #include "motion/features/features_compute.h"
 
-RoI_t* features_alloc_RoIs(const size_t max_size) {
-    RoI_t* RoIs = (RoI_t*)malloc(max_size * sizeof(RoI_t));
+#ifdef MOTION_USE_MIPP
+#include <mipp.h>
+#endif
+
+// number of arrays in `RoIs_t` (they are all made of 4-byte elements)
+#define RoIs_N_FIELDS 12
+
+RoIs_t* features_alloc_RoIs(const size_t max_size) {
+    RoIs_t* RoIs = (RoIs_t*)malloc(sizeof(RoIs_t));
+    // the capacity of each array is rounded up to 16 elements (64 bytes), so all the arrays are aligned on 64 bytes
+    const size_t capacity = (max_size + 15) & ~(size_t)15;
+    uint32_t* block = NULL;
+    if (posix_memalign((void**)&block, 64, RoIs_N_FIELDS * MAX(capacity, (size_t)16) * sizeof(uint32_t))) {
+        fprintf(stderr, "(EE) 'posix_memalign' failed to allocate the RoIs (max_size = %lu).\n",
+                (unsigned long)max_size);
+        exit(1);
+    }
+    RoIs->id = block;
+    RoIs->xmin = RoIs->id + capacity;
+    RoIs->xmax = RoIs->xmin + capacity;
+    RoIs->ymin = RoIs->xmax + capacity;
+    RoIs->ymax = RoIs->ymin + capacity;
+    RoIs->S = RoIs->ymax + capacity;
+    RoIs->Sx = RoIs->S + capacity;
+    RoIs->Sy = RoIs->Sx + capacity;
+    RoIs->x = (float*)(RoIs->Sy + capacity);
+    RoIs->y = RoIs->x + capacity;
+    RoIs->prev_id = (uint32_t*)(RoIs->y + capacity);
+    RoIs->next_id = RoIs->prev_id + capacity;
+    RoIs->_max_size = max_size;
     return RoIs;
 }
 
-void features_init_RoIs(RoI_t* RoIs, const size_t max_size) {
-    memset(RoIs, 0, max_size * sizeof(RoI_t));
+void features_init_RoIs(RoIs_t* RoIs) {
+    const size_t capacity = (RoIs->_max_size + 15) & ~(size_t)15;
+    memset(RoIs->id, 0, RoIs_N_FIELDS * capacity * sizeof(uint32_t));
 }
 
-void features_free_RoIs(RoI_t* RoIs) {
+void features_free_RoIs(RoIs_t* RoIs) {
+    free(RoIs->id); // the beginning of the block
     free(RoIs);
 }
 
-void features_extract(const uint32_t** labels, const int i0, const int i1, const int j0, const int j1, RoI_t* RoIs,
+RoI_t features_get_RoI(const RoIs_t* RoIs, const size_t i) {
+    RoI_t RoI;
+    RoI.id = RoIs->id[i];
+    RoI.xmin = RoIs->xmin[i];
+    RoI.xmax = RoIs->xmax[i];
+    RoI.ymin = RoIs->ymin[i];
+    RoI.ymax = RoIs->ymax[i];
+    RoI.S = RoIs->S[i];
+    RoI.x = RoIs->x[i];
+    RoI.y = RoIs->y[i];
+    RoI.prev_id = RoIs->prev_id[i];
+    RoI.next_id = RoIs->next_id[i];
+    return RoI;
+}
+
+void features_extract(const uint32_t** labels, const int i0, const int i1, const int j0, const int j1, RoIs_t* RoIs,
                       const size_t n_RoIs) {
     for (size_t i = 0; i < n_RoIs; i++) {
-        RoIs[i].xmin = j1;
-        RoIs[i].xmax = j0;
-        RoIs[i].ymin = i1;
-        RoIs[i].ymax = i0;
-        RoIs[i].S = 0;
-        uint32_t *RoIs_Sx = (uint32_t*)&RoIs[i].x;
-        uint32_t *RoIs_Sy = (uint32_t*)&RoIs[i].y;
-        *RoIs_Sx = 0;
-        *RoIs_Sy = 0;
+        RoIs->xmin[i] = j1;
+        RoIs->xmax[i] = j0;
+        RoIs->ymin[i] = i1;
+        RoIs->ymax[i] = i0;
     }
+    memset(RoIs->S, 0, n_RoIs * sizeof(uint32_t));
+    memset(RoIs->Sx, 0, n_RoIs * sizeof(uint32_t));
+    memset(RoIs->Sy, 0, n_RoIs * sizeof(uint32_t));
 
     uint32_t maxlbl = 0;
     for (int i = i0; i <= i1; i++) {
@@ -42,35 +86,31 @@ void features_extract(const uint32_t** labels, const int i0, const int i1, const
             if (e > 0) {
                 maxlbl = MAX(maxlbl, e);
                 uint32_t r = e - 1;
-                RoIs[r].S += 1;
-                RoIs[r].id = e;
-                uint32_t *RoIs_Sx = (uint32_t*)&RoIs[r].x;
-                uint32_t *RoIs_Sy = (uint32_t*)&RoIs[r].y;
-                *RoIs_Sx += j;
-                *RoIs_Sy += i;
-                if (j < (int)RoIs[r].xmin)
-                    RoIs[r].xmin = j;
-                if (j > (int)RoIs[r].xmax)
-                    RoIs[r].xmax = j;
-                if (i < (int)RoIs[r].ymin)
-                    RoIs[r].ymin = i;
-                if (i > (int)RoIs[r].ymax)
-                    RoIs[r].ymax = i;
+                RoIs->S[r] += 1;
+                RoIs->id[r] = e;
+                RoIs->Sx[r] += j;
+                RoIs->Sy[r] += i;
+                if (j < (int)RoIs->xmin[r])
+                    RoIs->xmin[r] = j;
+                if (j > (int)RoIs->xmax[r])
+                    RoIs->xmax[r] = j;
+                if (i < (int)RoIs->ymin[r])
+                    RoIs->ymin[r] = i;
+                if (i > (int)RoIs->ymax[r])
+                    RoIs->ymax[r] = i;
             }
         }
     }
     assert(maxlbl == n_RoIs);
 
     for (size_t i = 0; i < n_RoIs; i++) {
-        uint32_t *RoIs_Sx = (uint32_t*)&RoIs[i].x;
-        uint32_t *RoIs_Sy = (uint32_t*)&RoIs[i].y;
-        RoIs[i].x = (float)*RoIs_Sx / (float)RoIs[i].S;
-        RoIs[i].y = (float)*RoIs_Sy / (float)RoIs[i].S;
+        RoIs->x[i] = (float)RoIs->Sx[i] / (float)RoIs->S[i];
+        RoIs->y[i] = (float)RoIs->Sy[i] / (float)RoIs->S[i];
     }
 }
 
 uint32_t features_filter_surface(const uint32_t** in_labels, uint32_t** out_labels, const int i0, const int i1,
-                                 const int j0, const int j1, RoI_t* RoIs, const size_t n_RoIs, const uint32_t S_min,
+                                 const int j0, const int j1, RoIs_t* RoIs, const size_t n_RoIs, const uint32_t S_min,
                                  const uint32_t S_max) {
     if (out_labels != NULL && (void*)in_labels != (void*)out_labels)
         for (int i = i0; i <= i1; i++)
@@ -79,14 +119,14 @@ uint32_t features_filter_surface(const uint32_t** in_labels, uint32_t** out_labe
     uint32_t x0, x1, y0, y1, id;
     uint32_t cur_label = 1;
     for (size_t i = 0; i < n_RoIs; i++) {
-        if (RoIs[i].id) {
-            id = RoIs[i].id;
-            x0 = RoIs[i].ymin;
-            x1 = RoIs[i].ymax;
-            y0 = RoIs[i].xmin;
-            y1 = RoIs[i].xmax;
-            if (S_min > RoIs[i].S || RoIs[i].S > S_max) {
-                RoIs[i].id = 0;
+        if (RoIs->id[i]) {
+            id = RoIs->id[i];
+            x0 = RoIs->ymin[i];
+            x1 = RoIs->ymax[i];
+            y0 = RoIs->xmin[i];
+            y1 = RoIs->xmax[i];
+            if (S_min > RoIs->S[i] || RoIs->S[i] > S_max) {
+                RoIs->id[i] = 0;
                 if (out_labels != NULL && ((void*)in_labels == (void*)out_labels)) {
                     for (uint32_t k = x0; k <= x1; k++) {
                         for (uint32_t l = y0; l <= y1; l++) {
@@ -113,29 +153,67 @@ uint32_t features_filter_surface(const uint32_t** in_labels, uint32_t** out_labe
     return cur_label - 1;
 }
 
-void features_shrink_basic(const RoI_t* RoIs_src, const size_t n_RoIs_src, RoI_t* RoIs_dst) {
+uint32_t features_filter_surface_remap(RoIs_t* RoIs, const size_t n_RoIs, const uint32_t S_min, const uint32_t S_max,
+                                       uint32_t* remap) {
+    uint32_t* RoIs_id = RoIs->id;
+    const uint32_t* RoIs_S = RoIs->S;
+
+    // step 1: the identifiers of the RoIs that are too small or too big are set to 0
+    size_t i = 0;
+#ifdef MOTION_USE_MIPP
+    // the surfaces are compared as signed integers (a surface can not exceed 2^31 pixels)
+    const int vec_size = mipp::N<int32_t>();
+    const size_t vec_loop_size = (n_RoIs / vec_size) * vec_size;
+    const mipp::Reg<int32_t> S_min_reg = (int32_t)MIN(S_min, (uint32_t)INT32_MAX);
+    const mipp::Reg<int32_t> S_max_reg = (int32_t)MIN(S_max, (uint32_t)INT32_MAX);
+    const mipp::Reg<int32_t> zero_reg = (int32_t)0;
+    for (; i < vec_loop_size; i += vec_size) {
+        const mipp::Reg<int32_t> S_reg = mipp::Reg<int32_t>((const int32_t*)&RoIs_S[i]);
+        mipp::Reg<int32_t> id_reg = mipp::Reg<int32_t>((const int32_t*)&RoIs_id[i]);
+        const mipp::Msk<mipp::N<int32_t>()> out_mask = (S_reg < S_min_reg) | (S_reg > S_max_reg);
+        id_reg = mipp::blend(zero_reg, id_reg, out_mask);
+        id_reg.store((int32_t*)&RoIs_id[i]);
+    }
+#endif
+    for (; i < n_RoIs; i++)
+        if (S_min > RoIs_S[i] || RoIs_S[i] > S_max)
+            RoIs_id[i] = 0;
+
+    // step 2: the remaining RoIs are renumbered (the filtered and the missing identifiers are mapped to 0)
+    memset(remap, 0, (n_RoIs + 1) * sizeof(uint32_t));
+    uint32_t cur_label = 1;
+    for (i = 0; i < n_RoIs; i++)
+        if (RoIs_id[i])
+            remap[RoIs_id[i]] = cur_label++;
+
+    return cur_label - 1;
+}
+
+void features_shrink_basic(const RoIs_t* RoIs_src, const size_t n_RoIs_src, RoIs_t* RoIs_dst) {
     size_t cpt = 0;
     for (size_t i = 0; i < n_RoIs_src; i++) {
-        if (RoIs_src[i].id) {
-            RoIs_dst[cpt].id = cpt + 1;
-            RoIs_dst[cpt].xmin = RoIs_src[i].xmin;
-            RoIs_dst[cpt].xmax = RoIs_src[i].xmax;
-            RoIs_dst[cpt].ymin = RoIs_src[i].ymin;
-            RoIs_dst[cpt].ymax = RoIs_src[i].ymax;
-            RoIs_dst[cpt].S = RoIs_src[i].S;
-            RoIs_dst[cpt].x = RoIs_src[i].x;
-            RoIs_dst[cpt].y = RoIs_src[i].y;
+        if (RoIs_src->id[i]) {
+            RoIs_dst->id[cpt] = cpt + 1;
+            RoIs_dst->xmin[cpt] = RoIs_src->xmin[i];
+            RoIs_dst->xmax[cpt] = RoIs_src->xmax[i];
+            RoIs_dst->ymin[cpt] = RoIs_src->ymin[i];
+            RoIs_dst->ymax[cpt] = RoIs_src->ymax[i];
+            RoIs_dst->S[cpt] = RoIs_src->S[i];
+            RoIs_dst->Sx[cpt] = RoIs_src->Sx[i];
+            RoIs_dst->Sy[cpt] = RoIs_src->Sy[i];
+            RoIs_dst->x[cpt] = RoIs_src->x[i];
+            RoIs_dst->y[cpt] = RoIs_src->y[i];
             cpt++;
         }
     }
 }
 
-void features_labels_zero_init(const RoI_t* RoIs, const size_t n_RoIs, uint32_t** labels) {
+void features_labels_zero_init(const RoIs_t* RoIs, const size_t n_RoIs, uint32_t** labels) {
         for (size_t i = 0; i < n_RoIs; i++) {
-        uint32_t y0 = RoIs[i].ymin;
-        uint32_t y1 = RoIs[i].ymax;
-        uint32_t x0 = RoIs[i].xmin;
-        uint32_t x1 = RoIs[i].xmax;
+        uint32_t y0 = RoIs->ymin[i];
+        uint32_t y1 = RoIs->ymax[i];
+        uint32_t x0 = RoIs->xmin[i];
+        uint32_t x1 = RoIs->xmax[i];
         for (uint32_t k = y0; k <= y1; k++)
             for (uint32_t l = x0; l <= x1; l++)
                 labels[k][l] = 0;
@@ -7,9 +7,10 @@
 #include "vec.h"
 
 #include "motion/tracking/tracking_struct.h"
+#include "motion/features/features_compute.h"
 #include "motion/features/features_io.h"
 
-int find_corresponding_track(const int frame, const vec_track_t tracks, const RoI_t* RoIs, const int sel_RoIs_id,
+int find_corresponding_track(const int frame, const vec_track_t tracks, const RoIs_t* RoIs, const int sel_RoIs_id,
                              const size_t n_RoIs, const unsigned age) {
     assert(age == 0 || age == 1);
 
@@ -23,7 +24,7 @@ int find_corresponding_track(const int frame, const vec_track_t tracks, const Ro
                 else {
                     if (tracks[t].end.r.prev_id == 0)
                         continue;
-                    cur_RoIs_id = RoIs[tracks[t].end.r.prev_id - 1].id;
+                    cur_RoIs_id = RoIs->id[tracks[t].end.r.prev_id - 1];
                 }
                 assert(cur_RoIs_id <= (int)n_RoIs);
                 if (cur_RoIs_id <= 0)
@@ -36,11 +37,11 @@ int find_corresponding_track(const int frame, const vec_track_t tracks, const Ro
     return -1;
 }
 
-void features_RoIs_write(FILE* f, const int frame, const RoI_t* RoIs, const size_t n_RoIs, const vec_track_t tracks,
+void features_RoIs_write(FILE* f, const int frame, const RoIs_t* RoIs, const size_t n_RoIs, const vec_track_t tracks,
                          const unsigned age) {
     int cpt = 0;
     for (size_t i = 0; i < n_RoIs; i++)
-        if (RoIs[i].id != 0)
+        if (RoIs->id[i] != 0)
             cpt++;
 
     fprintf(f, "Regions of interest (RoI) [%d]: \n", cpt);
@@ -63,8 +64,9 @@ void features_RoIs_write(FILE* f, const int frame, const RoI_t* RoIs, const size
     // }
 
     for (size_t i = 0; i < n_RoIs; i++) {
-        if (RoIs[i].id != 0) {
-            int t = tracks ? find_corresponding_track(frame, tracks, RoIs, RoIs[i].id, n_RoIs, age) : -1;
+        if (RoIs->id[i] != 0) {
+            const RoI_t RoI = features_get_RoI(RoIs, i);
+            int t = tracks ? find_corresponding_track(frame, tracks, RoIs, RoI.id, n_RoIs, age) : -1;
             char track_id_str[16];
             if (t == -1)
                 strcpy(track_id_str, "    -");
@@ -73,19 +75,17 @@ void features_RoIs_write(FILE* f, const int frame, const RoI_t* RoIs, const size
 
             if (tracks) {
                 fprintf(f, "   %4u || %s || %4u | %4u | %4u | %4u || %7u || %7.1f | %7.1f \n",
-                        RoIs[i].id, track_id_str, RoIs[i].xmin, RoIs[i].xmax, RoIs[i].ymin, RoIs[i].ymax, RoIs[i].S,
-                        RoIs[i].x, RoIs[i].y);
+                        RoI.id, track_id_str, RoI.xmin, RoI.xmax, RoI.ymin, RoI.ymax, RoI.S, RoI.x, RoI.y);
             } else {
                 fprintf(f, "   %4u || %4u | %4u | %4u | %4u || %7u || %7.1f | %7.1f \n",
-                        RoIs[i].id, RoIs[i].xmin, RoIs[i].xmax, RoIs[i].ymin, RoIs[i].ymax, RoIs[i].S, RoIs[i].x,
-                        RoIs[i].y);
+                        RoI.id, RoI.xmin, RoI.xmax, RoI.ymin, RoI.ymax, RoI.S, RoI.x, RoI.y);
             }
         }
     }
 }
 
-void features_RoIs0_RoIs1_write(FILE* f, const int prev_frame, const int cur_frame, const RoI_t* RoIs0,
-                                const size_t n_RoIs0, const RoI_t* RoIs1, const size_t n_RoIs1,
+void features_RoIs0_RoIs1_write(FILE* f, const int prev_frame, const int cur_frame, const RoIs_t* RoIs0,
+                                const size_t n_RoIs0, const RoIs_t* RoIs1, const size_t n_RoIs1,
                                 const vec_track_t tracks) {
     if (prev_frame >= 0) {
         fprintf(f, "# Frame n°%05d (t-1) -- ", prev_frame);
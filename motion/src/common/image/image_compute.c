@@ -186,24 +186,24 @@ void image_draw_text(img_data_t* img_data, const BB_t* BBs, const enum color_e*
         image_draw_track_id(*cv_mat, BBs, BBs_color, nBB);
 }
 
-void _image_draw_RoIs_id(cv::Mat& cv_img, const RoI_t* RoIs, const size_t n_RoIs) {
+void _image_draw_RoIs_id(cv::Mat& cv_img, const RoIs_t* RoIs, const size_t n_RoIs) {
     //                       x    y  list of ids
     std::vector<std::tuple<int, int, std::vector<int>>> list_of_ids_grouped_by_pos;
     for (size_t i = 0; i < n_RoIs; i++) {
-        int x = RoIs[i].xmax + 3;
-        int y = RoIs[i].ymin + (RoIs[i].ymax - RoIs[i].ymin) / 2;
+        int x = RoIs->xmax[i] + 3;
+        int y = RoIs->ymin[i] + (RoIs->ymax[i] - RoIs->ymin[i]) / 2;
 
         bool found = false;
         for (auto& l : list_of_ids_grouped_by_pos) {
             if (std::get<0>(l) == x && std::get<1>(l) == y) {
-                std::get<2>(l).push_back(RoIs[i].id);
+                std::get<2>(l).push_back(RoIs->id[i]);
                 found = true;
             }
         }
 
         if (!found) {
             std::vector<int> v;
-            v.push_back(RoIs[i].id);
+            v.push_back(RoIs->id[i]);
             list_of_ids_grouped_by_pos.push_back(std::make_tuple(x, y, v));
         }
     }
@@ -285,7 +285,7 @@ img_data_t* image_gs_alloc(const size_t img_height, const size_t img_width) {
     return img_data;
 }
 
-void image_gs_draw_labels(img_data_t* img_data, const uint32_t** labels, const RoI_t* RoIs, const size_t n_RoIs,
+void image_gs_draw_labels(img_data_t* img_data, const uint32_t** labels, const RoIs_t* RoIs, const size_t n_RoIs,
                           const uint8_t show_id) {
 #ifdef MOTION_OPENCV_LINK
     cv::Mat* pixels = (cv::Mat*)img_data->pixels;
@@ -299,11 +299,11 @@ void image_gs_draw_labels(img_data_t* img_data, const uint32_t** labels, const R
             pixels->at<uint8_t>(i, j) = 0;
 
     for (size_t i = 0; i < n_RoIs; i++) {
-        uint32_t id = RoIs[i].id;
-        uint32_t x0 = RoIs[i].ymin;
-        uint32_t x1 = RoIs[i].ymax;
-        uint32_t y0 = RoIs[i].xmin;
-        uint32_t y1 = RoIs[i].xmax;
+        uint32_t id = RoIs->id[i];
+        uint32_t x0 = RoIs->ymin[i];
+        uint32_t x1 = RoIs->ymax[i];
+        uint32_t y0 = RoIs->xmin[i];
+        uint32_t y1 = RoIs->xmax[i];
         for (uint32_t k = x0; k <= x1; k++)
             for (uint32_t l = y0; l <= y1; l++)
                 if (labels[k][l] == id)
@@ -323,11 +323,11 @@ void image_gs_draw_labels(img_data_t* img_data, const uint32_t** labels, const R
         memset(pixels[i], 0, img_data->width * sizeof(uint8_t));
 
     for (size_t i = 0; i < n_RoIs; i++) {
-        uint32_t id = RoIs[i].id;
-        uint32_t x0 = RoIs[i].ymin;
-        uint32_t x1 = RoIs[i].ymax;
-        uint32_t y0 = RoIs[i].xmin;
-        uint32_t y1 = RoIs[i].xmax;
+        uint32_t id = RoIs->id[i];
+        uint32_t x0 = RoIs->ymin[i];
+        uint32_t x1 = RoIs->ymax[i];
+        uint32_t y0 = RoIs->xmin[i];
+        uint32_t y1 = RoIs->xmax[i];
         for (uint32_t k = x0; k <= x1; k++)
             for (uint32_t l = y0; l <= y1; l++)
                 if (labels[k][l] == id)
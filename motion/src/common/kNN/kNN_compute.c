@@ -4,161 +4,373 @@
 #include <math.h>
 #include <nrc2.h>
 
+#include "motion/macros.h"
 #include "motion/tools.h"
 
 #include "motion/kNN/kNN_compute.h"
 
+#ifdef MOTION_USE_MIPP
+#include <mipp.h>
+#endif
+
 kNN_data_t* kNN_alloc_data(const size_t max_size) {
     kNN_data_t* kNN_data = (kNN_data_t*)malloc(sizeof(kNN_data_t));
     kNN_data->_max_size = max_size;
-    kNN_data->nearest = (uint32_t**)ui32matrix(0, max_size - 1, 0, max_size - 1);
-    kNN_data->distances = (float**)f32matrix(0, max_size - 1, 0, max_size - 1);
-#ifdef MOTION_ENABLE_DEBUG
-    kNN_data->conflicts = (uint32_t*)ui32vector(0, max_size - 1);
-#else
+    // the working storage is allocated on demand by `kNN_match`, depending on the actual numbers of RoIs
+    kNN_data->_max_RoIs = 0;
+    kNN_data->_max_pairs = 0;
+    kNN_data->_max_cells = 0;
+    kNN_data->nearest_offset = NULL;
+    kNN_data->nearest_id = NULL;
+    kNN_data->nearest_dist = NULL;
+    kNN_data->nearest_ratio_S = NULL;
+    kNN_data->pair_S = NULL;
+    kNN_data->rev_offset = NULL;
+    kNN_data->rev_id = NULL;
+    kNN_data->rev_pos = NULL;
+    kNN_data->grid_offset = NULL;
+    kNN_data->grid_id = NULL;
+    kNN_data->grid_x = NULL;
+    kNN_data->grid_y = NULL;
+    kNN_data->cand_id = NULL;
+    kNN_data->cand_dist = NULL;
+    kNN_data->cand_sorted = NULL;
+    kNN_data->cand_cpt = NULL;
     kNN_data->conflicts = NULL;
-#endif
+    kNN_data->peak_bytes = 0;
     return kNN_data;
 }
 
 void kNN_init_data(kNN_data_t* kNN_data) {
-    zero_ui32matrix(kNN_data->nearest, 0, kNN_data->_max_size - 1, 0, kNN_data->_max_size - 1);
-    zero_f32matrix(kNN_data->distances, 0, kNN_data->_max_size - 1, 0, kNN_data->_max_size - 1);
+    if (kNN_data->nearest_offset) {
+        memset(kNN_data->nearest_offset, 0, (kNN_data->_max_RoIs + 1) * sizeof(uint32_t));
+        memset(kNN_data->rev_offset, 0, (kNN_data->_max_RoIs + 1) * sizeof(uint32_t));
 #ifdef MOTION_ENABLE_DEBUG
-    zero_ui32vector(kNN_data->conflicts, 0, kNN_data->_max_size - 1);
+        memset(kNN_data->conflicts, 0, kNN_data->_max_RoIs * sizeof(uint32_t));
 #endif
+    }
+    if (kNN_data->_max_cells)
+        memset(kNN_data->grid_offset, 0, (kNN_data->_max_cells + 1) * sizeof(uint32_t));
 }
 
 void kNN_free_data(kNN_data_t* kNN_data) {
-    free_ui32matrix(kNN_data->nearest, 0, kNN_data->_max_size - 1, 0, kNN_data->_max_size - 1);
-    free_f32matrix(kNN_data->distances, 0, kNN_data->_max_size - 1, 0, kNN_data->_max_size - 1);
-    free_ui32vector(kNN_data->conflicts, 0, kNN_data->_max_size - 1);
+    free(kNN_data->nearest_offset);
+    free(kNN_data->nearest_id);
+    free(kNN_data->nearest_dist);
+    free(kNN_data->nearest_ratio_S);
+    free(kNN_data->pair_S);
+    free(kNN_data->rev_offset);
+    free(kNN_data->rev_id);
+    free(kNN_data->rev_pos);
+    free(kNN_data->grid_offset);
+    free(kNN_data->grid_id);
+    free(kNN_data->grid_x);
+    free(kNN_data->grid_y);
+    free(kNN_data->cand_id);
+    free(kNN_data->cand_dist);
+    free(kNN_data->cand_sorted);
+    free(kNN_data->cand_cpt);
+    free(kNN_data->conflicts);
     free(kNN_data);
 }
 
-void _compute_distance(const RoI_t* RoIs0, const size_t n_RoIs0, const RoI_t* RoIs1, const size_t n_RoIs1,
-                       float** distances) {
-    // parcours des stats 0
-    for (size_t i = 0; i < n_RoIs0; i++) {
-        float x0 = RoIs0[i].x;
-        float y0 = RoIs0[i].y;
+/**
+ * Grow the working storage of the kNN (if needed) so it can hold `n_RoIs` RoIs, `n_pairs` associations and `n_cells`
+ * grid cells. The capacities are at least doubled to amortize the reallocations over the frames.
+ */
+static void _kNN_reserve(kNN_data_t* kNN_data, const size_t n_RoIs, const size_t n_pairs, const size_t n_cells) {
+    if (n_RoIs > kNN_data->_max_RoIs || kNN_data->nearest_offset == NULL) {
+        const size_t n = MAX(n_RoIs, 2 * kNN_data->_max_RoIs);
+        kNN_data->nearest_offset = (uint32_t*)realloc(kNN_data->nearest_offset, (n + 1) * sizeof(uint32_t));
+        kNN_data->rev_offset = (uint32_t*)realloc(kNN_data->rev_offset, (n + 1) * sizeof(uint32_t));
+        kNN_data->grid_id = (uint32_t*)realloc(kNN_data->grid_id, n * sizeof(uint32_t));
+        kNN_data->grid_x = (float*)realloc(kNN_data->grid_x, n * sizeof(float));
+        kNN_data->grid_y = (float*)realloc(kNN_data->grid_y, n * sizeof(float));
+        kNN_data->cand_id = (uint32_t*)realloc(kNN_data->cand_id, n * sizeof(uint32_t));
+        kNN_data->cand_dist = (float*)realloc(kNN_data->cand_dist, n * sizeof(float));
+        kNN_data->cand_sorted = (float*)realloc(kNN_data->cand_sorted, n * sizeof(float));
+        kNN_data->cand_cpt = (uint32_t*)realloc(kNN_data->cand_cpt, n * sizeof(uint32_t));
+#ifdef MOTION_ENABLE_DEBUG
+        kNN_data->conflicts = (uint32_t*)realloc(kNN_data->conflicts, n * sizeof(uint32_t));
+#endif
+        kNN_data->_max_RoIs = n;
+    }
+    if (n_pairs > kNN_data->_max_pairs) {
+        const size_t n = MAX(n_pairs, 2 * kNN_data->_max_pairs);
+        kNN_data->nearest_id = (uint32_t*)realloc(kNN_data->nearest_id, n * sizeof(uint32_t));
+        kNN_data->nearest_dist = (float*)realloc(kNN_data->nearest_dist, n * sizeof(float));
+        kNN_data->nearest_ratio_S = (float*)realloc(kNN_data->nearest_ratio_S, n * sizeof(float));
+        kNN_data->pair_S = (float*)realloc(kNN_data->pair_S, n * sizeof(float));
+        kNN_data->rev_id = (uint32_t*)realloc(kNN_data->rev_id, n * sizeof(uint32_t));
+        kNN_data->rev_pos = (uint32_t*)realloc(kNN_data->rev_pos, n * sizeof(uint32_t));
+        kNN_data->_max_pairs = n;
+    }
+    if (n_cells > kNN_data->_max_cells) {
+        const size_t n = MAX(n_cells, 2 * kNN_data->_max_cells);
+        kNN_data->grid_offset = (uint32_t*)realloc(kNN_data->grid_offset, (n + 1) * sizeof(uint32_t));
+        kNN_data->_max_cells = n;
+    }
+
+    size_t bytes = 2 * (kNN_data->_max_RoIs + 1) * sizeof(uint32_t) + 7 * kNN_data->_max_RoIs * sizeof(uint32_t) +
+                   6 * kNN_data->_max_pairs * sizeof(uint32_t) + (kNN_data->_max_cells + 1) * sizeof(uint32_t);
+#ifdef MOTION_ENABLE_DEBUG
+    bytes += kNN_data->_max_RoIs * sizeof(uint32_t);
+#endif
+    kNN_data->peak_bytes = MAX(kNN_data->peak_bytes, bytes);
+}
 
-        // parcours des stats 1
-        for (size_t j = 0; j < n_RoIs1; j++) {
-            float x1 = RoIs1[j].x;
-            float y1 = RoIs1[j].y;
+void _kNN_grid_build(kNN_data_t* kNN_data, const RoIs_t* RoIs1, const size_t n_RoIs1, const float cell_size,
+                     uint32_t* n_cells_x, uint32_t* n_cells_y) {
+    const float* RoIs1_x = RoIs1->x;
+    const float* RoIs1_y = RoIs1->y;
+    uint32_t ncx = 1, ncy = 1;
+    for (size_t j = 0; j < n_RoIs1; j++) {
+        ncx = MAX(ncx, (uint32_t)(RoIs1_x[j] / cell_size) + 1);
+        ncy = MAX(ncy, (uint32_t)(RoIs1_y[j] / cell_size) + 1);
+    }
+    const size_t n_cells = (size_t)ncx * (size_t)ncy;
+    _kNN_reserve(kNN_data, 0, 0, n_cells);
 
-            // distances au carré
-            float d = (x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0);
+    // counting sort of the RoIs (t) by cell, the RoIs of a cell are sorted by index
+    uint32_t* grid_offset = kNN_data->grid_offset;
+    memset(grid_offset, 0, (n_cells + 1) * sizeof(uint32_t));
+    for (size_t j = 0; j < n_RoIs1; j++) {
+        const uint32_t c = (uint32_t)(RoIs1_y[j] / cell_size) * ncx + (uint32_t)(RoIs1_x[j] / cell_size);
+        grid_offset[c + 1]++;
+    }
+    for (size_t c = 0; c < n_cells; c++)
+        grid_offset[c + 1] += grid_offset[c];
+    for (size_t j = 0; j < n_RoIs1; j++) {
+        const uint32_t c = (uint32_t)(RoIs1_y[j] / cell_size) * ncx + (uint32_t)(RoIs1_x[j] / cell_size);
+        const uint32_t g = grid_offset[c]++;
+        kNN_data->grid_id[g] = (uint32_t)j;
+        kNN_data->grid_x[g] = RoIs1_x[j];
+        kNN_data->grid_y[g] = RoIs1_y[j];
+    }
+    for (size_t c = n_cells; c > 0; c--)
+        grid_offset[c] = grid_offset[c - 1];
+    grid_offset[0] = 0;
 
-            // if d > max_dist_square, on peut economiser l'accès mémoire (a implementer)
-            distances[i][j] = d;
-        }
+    *n_cells_x = ncx;
+    *n_cells_y = ncy;
+}
+
+// squared distances between (`x0`, `y0`) and the points (`x[g]`, `y[g]`)
+static void _kNN_dist_square(const float* x, const float* y, const size_t n, const float x0, const float y0,
+                             float* dist) {
+    size_t g = 0;
+#ifdef MOTION_USE_MIPP
+    const int vec_size = mipp::N<float>();
+    const size_t vec_loop_size = (n / vec_size) * vec_size;
+    const mipp::Reg<float> x0_reg = x0;
+    const mipp::Reg<float> y0_reg = y0;
+    for (; g < vec_loop_size; g += vec_size) {
+        const mipp::Reg<float> dx_reg = mipp::Reg<float>(&x[g]) - x0_reg;
+        const mipp::Reg<float> dy_reg = mipp::Reg<float>(&y[g]) - y0_reg;
+        const mipp::Reg<float> d_reg = dx_reg * dx_reg + dy_reg * dy_reg;
+        d_reg.store(&dist[g]);
     }
+#endif
+    for (; g < n; g++)
+        dist[g] = (x[g] - x0) * (x[g] - x0) + (y[g] - y0) * (y[g] - y0);
 }
 
-void _kNN_match1(const RoI_t* RoIs0, const size_t n_RoIs0, const RoI_t* RoIs1, const size_t n_RoIs1,
-                 float** kNN_data_distances, uint32_t** kNN_data_nearest, uint32_t* kNN_data_conflicts, const int k,
-                 const uint32_t max_dist) {
-#ifdef MOTION_ENABLE_DEBUG
-    // vecteur de conflits pour debug
-    zero_ui32vector(kNN_data_conflicts, 0, n_RoIs1 - 1);
+// surface ratios min(S0, S1) / max(S0, S1), `ratio` can be the same buffer as `S0`
+static void _kNN_ratio_S(const float* S0, const float* S1, const size_t n, float* ratio) {
+    size_t p = 0;
+#ifdef MOTION_USE_MIPP
+    const int vec_size = mipp::N<float>();
+    const size_t vec_loop_size = (n / vec_size) * vec_size;
+    for (; p < vec_loop_size; p += vec_size) {
+        const mipp::Reg<float> S0_reg = mipp::Reg<float>(&S0[p]);
+        const mipp::Reg<float> S1_reg = mipp::Reg<float>(&S1[p]);
+        const mipp::Reg<float> r_reg = mipp::min(S0_reg, S1_reg) / mipp::max(S0_reg, S1_reg);
+        r_reg.store(&ratio[p]);
+    }
 #endif
-    zero_ui32matrix(kNN_data_nearest, 0, n_RoIs0 - 1, 0, n_RoIs1 - 1);
+    for (; p < n; p++)
+        ratio[p] = S0[p] < S1[p] ? S0[p] / S1[p] : S1[p] / S0[p];
+}
 
-    // calculs de toutes les distances euclidiennes au carré entre nc0 et nc1
-    _compute_distance(RoIs0, n_RoIs0, RoIs1, n_RoIs1, kNN_data_distances);
+void _kNN_match1(kNN_data_t* kNN_data, const RoIs_t* RoIs0, const size_t n_RoIs0, const RoIs_t* RoIs1,
+                 const size_t n_RoIs1, const int k, const uint32_t max_dist) {
+    _kNN_reserve(kNN_data, MAX(n_RoIs0, n_RoIs1), (size_t)k * n_RoIs0, 0);
 
     float max_dist_square = (float)max_dist * (float)max_dist;
 
-    // les k plus proches voisins dans l'ordre croissant
-    for (int rank = 1; rank <= k; rank++) {
-        // parcours des distances
-        for (size_t i = 0; i < n_RoIs0; i++) {
-            for (size_t j = 0; j < n_RoIs1; j++) {
-                // if une distance est calculée et ne fait pas pas déjà parti du tab kNN_data_nearest
-                if (kNN_data_nearest[i][j] == 0 && kNN_data_distances[i][j] < max_dist_square) {
-                    int dist_ij = kNN_data_distances[i][j];
-                    int cpt = 0;
-                    // compte le nombre de kNN_data_distances < dist_ij
-                    for (size_t l = 0; l < n_RoIs1; l++)
-                        if (kNN_data_distances[i][l] < dist_ij)
-                            cpt++;
-
-                    // k-ième voisin
-                    if (cpt < rank) {
-                        kNN_data_nearest[i][j] = rank;
-#ifdef MOTION_ENABLE_DEBUG
-                        // vecteur de conflits
-                        if (rank == 1)
-                           kNN_data_conflicts[j]++;
-#endif
-                        break;
-                    }
+    // the cells are a bit larger than the maximum distance: the RoIs closer than `max_dist` are always in the 3x3
+    // neighboring cells, even with the rounding of the cell coordinates
+    const float cell_size = (float)max_dist + 1.f;
+    uint32_t ncx, ncy;
+    _kNN_grid_build(kNN_data, RoIs1, n_RoIs1, cell_size, &ncx, &ncy);
+
+    uint32_t* cand_id = kNN_data->cand_id;
+    float* cand_dist = kNN_data->cand_dist;
+    float* cand_sorted = kNN_data->cand_sorted;
+    uint32_t* cand_cpt = kNN_data->cand_cpt;
+    uint32_t n_pairs = 0;
+    for (size_t i = 0; i < n_RoIs0; i++) {
+        kNN_data->nearest_offset[i] = n_pairs;
+        const float x0 = RoIs0->x[i];
+        const float y0 = RoIs0->y[i];
+        const uint32_t cx = (uint32_t)(x0 / cell_size);
+        const uint32_t cy = (uint32_t)(y0 / cell_size);
+
+        // candidates: the RoIs (t) closer than `max_dist` in the neighboring cells, the neighboring cells of a row
+        // are consecutive in the grid so their RoIs are contiguous in `grid_x` and `grid_y`
+        uint32_t n_cand = 0;
+        const uint32_t gx0 = cx > 0 ? cx - 1 : 0;
+        const uint32_t gx1 = MIN(cx + 1, ncx - 1);
+        for (uint32_t gy = cy > 0 ? cy - 1 : 0; gy <= cy + 1 && gy < ncy; gy++) {
+            if (gx0 > gx1)
+                break;
+            const uint32_t g0 = kNN_data->grid_offset[gy * ncx + gx0];
+            const uint32_t g1 = kNN_data->grid_offset[gy * ncx + gx1 + 1];
+            // distances au carré (temporarily stored after the current candidates)
+            float* dist = &cand_sorted[n_cand];
+            _kNN_dist_square(&kNN_data->grid_x[g0], &kNN_data->grid_y[g0], g1 - g0, x0, y0, dist);
+            for (uint32_t g = g0; g < g1; g++) {
+                const float d = dist[g - g0];
+                if (d < max_dist_square) {
+                    cand_id[n_cand] = kNN_data->grid_id[g];
+                    cand_dist[n_cand] = d;
+                    n_cand++;
                 }
             }
         }
+        if (n_cand == 0 || k == 0)
+            continue;
+
+        // the `k` smallest distances in increasing order (insertion in a bounded sorted array): only the candidates
+        // with less than `k` closer candidates can be ranked, the others are only known to have at least `k`
+        const uint32_t n_sorted = MIN((uint32_t)k, n_cand);
+        uint32_t n_top = 0;
+        for (uint32_t c = 0; c < n_cand; c++) {
+            const float d = cand_dist[c];
+            if (n_top == n_sorted && d >= cand_sorted[n_top - 1])
+                continue;
+            uint32_t pos = n_top < n_sorted ? n_top++ : n_top - 1;
+            for (; pos > 0 && cand_sorted[pos - 1] > d; pos--)
+                cand_sorted[pos] = cand_sorted[pos - 1];
+            cand_sorted[pos] = d;
+        }
+
+        // compte le nombre de distances < à la distance (tronquée) de chaque candidat (`n_sorted` means at least
+        // `n_sorted`, this is enough for the ranks up to `k`)
+        for (uint32_t c = 0; c < n_cand; c++) {
+            const int dist_ij = cand_dist[c];
+            uint32_t lo = 0, hi = n_sorted;
+            while (lo < hi) {
+                const uint32_t mid = (lo + hi) / 2;
+                if (cand_sorted[mid] < dist_ij)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            cand_cpt[c] = lo;
+        }
+
+        // les k plus proches voisins dans l'ordre croissant: the rank r goes to the candidate of lowest index with
+        // less than r closer candidates
+        const uint32_t n_ranks = MIN((uint32_t)k, n_cand);
+        for (uint32_t rank = 1; rank <= n_ranks; rank++) {
+            uint32_t best = n_cand;
+            for (uint32_t c = 0; c < n_cand; c++)
+                if (cand_cpt[c] < rank && (best == n_cand || cand_id[c] < cand_id[best]))
+                    best = c;
+            assert(best < n_cand);
+            kNN_data->nearest_id[n_pairs] = cand_id[best];
+            kNN_data->nearest_dist[n_pairs] = cand_dist[best];
+            kNN_data->nearest_ratio_S[n_pairs] = (float)RoIs0->S[i];
+            kNN_data->pair_S[n_pairs] = (float)RoIs1->S[cand_id[best]];
+            n_pairs++;
+            cand_cpt[best] = UINT32_MAX; // already ranked
+        }
     }
-}
+    kNN_data->nearest_offset[n_RoIs0] = n_pairs;
+    _kNN_ratio_S(kNN_data->nearest_ratio_S, kNN_data->pair_S, n_pairs, kNN_data->nearest_ratio_S);
 
-float _compute_ratio_S(const uint32_t S0, const uint32_t S1) {
-    return S0 < S1 ? (float)S0 / (float)S1 : (float)S1 / (float)S0;
+    // transposition of the associations, sorted by RoI (t-1)
+    uint32_t* rev_offset = kNN_data->rev_offset;
+    memset(rev_offset, 0, (n_RoIs1 + 1) * sizeof(uint32_t));
+    for (uint32_t p = 0; p < n_pairs; p++)
+        rev_offset[kNN_data->nearest_id[p] + 1]++;
+    for (size_t j = 0; j < n_RoIs1; j++)
+        rev_offset[j + 1] += rev_offset[j];
+    for (size_t i = 0; i < n_RoIs0; i++) {
+        for (uint32_t p = kNN_data->nearest_offset[i]; p < kNN_data->nearest_offset[i + 1]; p++) {
+            const uint32_t q = rev_offset[kNN_data->nearest_id[p]]++;
+            kNN_data->rev_id[q] = (uint32_t)i;
+            kNN_data->rev_pos[q] = p;
+        }
+    }
+    for (size_t j = n_RoIs1; j > 0; j--)
+        rev_offset[j] = rev_offset[j - 1];
+    rev_offset[0] = 0;
+
+#ifdef MOTION_ENABLE_DEBUG
+    // vecteur de conflits pour debug
+    for (size_t j = 0; j < n_RoIs1; j++) {
+        kNN_data->conflicts[j] = 0;
+        for (uint32_t q = rev_offset[j]; q < rev_offset[j + 1]; q++) {
+            const uint32_t p = kNN_data->rev_pos[q];
+            if (p == kNN_data->nearest_offset[kNN_data->rev_id[q]])
+                kNN_data->conflicts[j]++;
+        }
+    }
+#endif
 }
 
-void _kNN_match2(const float** kNN_data_distances, const uint32_t** kNN_data_nearest, RoI_t* RoIs0,
-                 const size_t n_RoIs0, RoI_t* RoIs1, const size_t n_RoIs1, const float min_ratio_S) {
-    uint32_t rank = 1;
+void _kNN_match2(const kNN_data_t* kNN_data, RoIs_t* RoIs0, const size_t n_RoIs0, RoIs_t* RoIs1,
+                 const float min_ratio_S) {
     for (size_t i = 0; i < n_RoIs0; i++) {
-    change:
-        for (size_t j = 0; j < n_RoIs1; j++) {
-            // si pas encore associé
-            if (!RoIs1[j].prev_id) {
-                // si RoIs1->kNN_data[j] est dans les voisins de RoIs0
-                if (kNN_data_nearest[i][j] == rank) {
-                    float dist_ij = kNN_data_distances[i][j];
-                    // test s'il existe une autre CC de RoIs0 de mm rang et plus proche
-                    for (size_t l = i + 1; l < n_RoIs0; l++) {
-                        if (kNN_data_nearest[l][j] == rank && kNN_data_distances[l][j] < dist_ij &&
-                            _compute_ratio_S(RoIs0[l].S, RoIs1[j].S) >= min_ratio_S) {
-                            rank++;
-                            goto change;
-                        }
-                    }
-
-                    if (_compute_ratio_S(RoIs0[i].S, RoIs1[j].S) >= min_ratio_S) {
-                        // association
-                        RoIs0[i].next_id = RoIs1[j].id;
-                        RoIs1[j].prev_id = RoIs0[i].id;
-                        break;
-                    } else {
-                        rank++;
-                        goto change;
-                    }
+        const uint32_t off = kNN_data->nearest_offset[i];
+        const uint32_t n_ranks = kNN_data->nearest_offset[i + 1] - off;
+        for (uint32_t rank = 1; rank <= n_ranks; rank++) {
+            const uint32_t j = kNN_data->nearest_id[off + rank - 1];
+            // si déjà associé
+            if (RoIs1->prev_id[j])
+                break;
+            const float dist_ij = kNN_data->nearest_dist[off + rank - 1];
+            // test s'il existe une autre CC de RoIs0 de mm rang et plus proche
+            uint8_t closer = 0;
+            for (uint32_t q = kNN_data->rev_offset[j]; q < kNN_data->rev_offset[j + 1]; q++) {
+                const uint32_t l = kNN_data->rev_id[q];
+                const uint32_t p = kNN_data->rev_pos[q];
+                if (l > i && p - kNN_data->nearest_offset[l] + 1 == rank && kNN_data->nearest_dist[p] < dist_ij &&
+                    kNN_data->nearest_ratio_S[p] >= min_ratio_S) {
+                    closer = 1;
+                    break;
                 }
             }
+            if (closer)
+                continue;
+
+            if (kNN_data->nearest_ratio_S[off + rank - 1] >= min_ratio_S) {
+                // association
+                RoIs0->next_id[i] = RoIs1->id[j];
+                RoIs1->prev_id[j] = RoIs0->id[i];
+                break;
+            }
         }
-        rank = 1;
     }
 }
 
-uint32_t kNN_match(kNN_data_t* kNN_data, RoI_t* RoIs0, const size_t n_RoIs0, RoI_t* RoIs1, const size_t n_RoIs1,
+uint32_t kNN_match(kNN_data_t* kNN_data, RoIs_t* RoIs0, const size_t n_RoIs0, RoIs_t* RoIs1, const size_t n_RoIs1,
                    const int k, const uint32_t max_dist, const float min_ratio_S) {
     assert(min_ratio_S >= 0.f && min_ratio_S <= 1.f);
+    assert(n_RoIs0 <= kNN_data->_max_size && n_RoIs1 <= kNN_data->_max_size);
 
-    for (size_t i = 0; i < n_RoIs0; i++)
-        RoIs0[i].next_id = 0;
-    for (size_t i = 0; i < n_RoIs1; i++)
-        RoIs1[i].prev_id = 0;
+    memset(RoIs0->next_id, 0, n_RoIs0 * sizeof(uint32_t));
+    memset(RoIs1->prev_id, 0, n_RoIs1 * sizeof(uint32_t));
 
-    _kNN_match1(RoIs0, n_RoIs0, RoIs1, n_RoIs1, kNN_data->distances, kNN_data->nearest, kNN_data->conflicts, k,
-                max_dist);
-    _kNN_match2((const float**)kNN_data->distances, (const uint32_t**)kNN_data->nearest, RoIs0, n_RoIs0, RoIs1, n_RoIs1,
-                min_ratio_S);
+    _kNN_match1(kNN_data, RoIs0, n_RoIs0, RoIs1, n_RoIs1, k, max_dist);
+    _kNN_match2(kNN_data, RoIs0, n_RoIs0, RoIs1, min_ratio_S);
 
     // compute the number of associations
     int n_assos = 0;
     for (size_t i = 0; i < n_RoIs0; i++)
-        if (RoIs0[i].next_id != 0)
+        if (RoIs0->next_id[i] != 0)
             n_assos++;
 
     return n_assos;
@@ -6,13 +6,12 @@
 
 #include "motion/kNN/kNN_io.h"
 
-void _kNN_conflicts_write(FILE* f, const uint32_t* kNN_data_conflicts, const float** kNN_data_distances,
-                          const uint32_t** kNN_data_nearest, int n_asso, int n_conflicts) {
+void _kNN_conflicts_write(FILE* f, const kNN_data_t* kNN_data, int n_conflicts) {
     // Conflicts
-    if (kNN_data_conflicts != NULL) {
+    if (kNN_data->conflicts != NULL) {
         size_t cpt = 0;
         for (int i = 0; i < n_conflicts; i++) {
-            if (kNN_data_conflicts[i] > 1)
+            if (kNN_data->conflicts[i] > 1)
                 cpt++;
         }
 
@@ -20,14 +19,16 @@ void _kNN_conflicts_write(FILE* f, const uint32_t* kNN_data_conflicts, const flo
         if (cpt) {
             fprintf(f, "# Association conflicts [%d]:\n", (int)cpt);
             for (int j = 0; j < n_conflicts; j++) {
-                if (kNN_data_conflicts[j] > 1) {
+                if (kNN_data->conflicts[j] > 1) {
                     fprintf(f, "RoI ID (t) = %d, list of possible RoI IDs (t-1): { ", j + 1);
                     int first = 1;
-                    for (int i = 0 ; i < n_asso; i++) {
-                        if (kNN_data_nearest[i][j] == 1) {
+                    for (uint32_t q = kNN_data->rev_offset[j]; q < kNN_data->rev_offset[j + 1]; q++) {
+                        const uint32_t i = kNN_data->rev_id[q];
+                        const uint32_t p = kNN_data->rev_pos[q];
+                        if (p == kNN_data->nearest_offset[i]) { // rank = 1
                             if (!first)
                                 fprintf(f, ", ");
-                            fprintf(f, "%d [dist = %2.2f]", i + 1, sqrtf(kNN_data_distances[i][j]));
+                            fprintf(f, "%d [dist = %2.2f]", i + 1, sqrtf(kNN_data->nearest_dist[p]));
                             first = 0;
                         }
                     }
@@ -40,12 +41,12 @@ void _kNN_conflicts_write(FILE* f, const uint32_t* kNN_data_conflicts, const flo
     }
 }
 
-void kNN_asso_conflicts_write(FILE* f, const kNN_data_t* kNN_data, const RoI_t* RoIs0, const size_t n_RoIs0,
-                              const RoI_t* RoIs1, const size_t n_RoIs1) {
+void kNN_asso_conflicts_write(FILE* f, const kNN_data_t* kNN_data, const RoIs_t* RoIs0, const size_t n_RoIs0,
+                              const RoIs_t* RoIs1, const size_t n_RoIs1) {
     // Asso
     int cpt = 0;
     for (size_t i = 0; i < n_RoIs0; i++) {
-        if (RoIs0[i].next_id != 0)
+        if (RoIs0->next_id[i] != 0)
             cpt++;
     }
     fprintf(f, "# Associations [%d]:\n", cpt);
@@ -60,16 +61,18 @@ void kNN_asso_conflicts_write(FILE* f, const kNN_data_t* kNN_data, const RoI_t*
     }
 
     for (size_t i = 0; i < n_RoIs0; i++) {
-        if (RoIs0[i].id == 0)
+        if (RoIs0->id[i] == 0)
             continue;
-        if (RoIs0[i].next_id) {
-            size_t j = (size_t)(RoIs0[i].next_id - 1);
-            float dist_ij = sqrtf(kNN_data->distances[i][j]);
-            fprintf(f, "  %4u | %4u || %6.3f | %4d \n", RoIs0[i].id, RoIs0[i].next_id, dist_ij,
-                                                        kNN_data->nearest[i][j]);
+        if (RoIs0->next_id[i]) {
+            uint32_t j = RoIs0->next_id[i] - 1;
+            uint32_t p = kNN_data->nearest_offset[i];
+            while (kNN_data->nearest_id[p] != j)
+                p++;
+            float dist_ij = sqrtf(kNN_data->nearest_dist[p]);
+            fprintf(f, "  %4u | %4u || %6.3f | %4u \n", RoIs0->id[i], RoIs0->next_id[i], dist_ij,
+                                                        p - kNN_data->nearest_offset[i] + 1);
         }
     }
 
-    _kNN_conflicts_write(f, kNN_data->conflicts, (const float**)kNN_data->distances,
-                         (const uint32_t**)kNN_data->nearest, n_RoIs0, n_RoIs1);
+    _kNN_conflicts_write(f, kNN_data, n_RoIs1);
 }
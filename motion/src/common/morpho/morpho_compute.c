@@ -1,5 +1,6 @@
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <nrc2.h>
 
@@ -32,6 +33,11 @@ morpho_data_t* morpho_alloc_data(const int i0, const int i1, const int j0, const
     morpho_data->IB_packed = ui8matrix(i0, i1, j0, jp1);
     morpho_data->IB_packed2 = ui8matrix(i0, i1, j0, jp1);
     morpho_data->IB_packed3 = ui8matrix(i0, i1, j0, jp1);
+
+    // Allocate 64-bit packed buffers (64 pixels per word)
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    morpho_data->IB_words = (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1);
+    morpho_data->IB_words2 = (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1);
     
     return morpho_data;
 }
@@ -47,6 +53,10 @@ void morpho_init_data(morpho_data_t* morpho_data) {
     zero_ui8matrix(morpho_data->IB_packed , morpho_data->i0, morpho_data->i1, morpho_data->j0, jp1);
     zero_ui8matrix(morpho_data->IB_packed2, morpho_data->i0, morpho_data->i1, morpho_data->j0, jp1);
     zero_ui8matrix(morpho_data->IB_packed3, morpho_data->i0, morpho_data->i1, morpho_data->j0, jp1);
+
+    const int n_words = PACKED_N_WORDS(morpho_data->j0, morpho_data->j1);
+    zero_ui64matrix((uint64**)morpho_data->IB_words, morpho_data->i0, morpho_data->i1, 0, n_words - 1);
+    zero_ui64matrix((uint64**)morpho_data->IB_words2, morpho_data->i0, morpho_data->i1, 0, n_words - 1);
 }
 
 void morpho_free_data(morpho_data_t* morpho_data) {
@@ -60,6 +70,10 @@ void morpho_free_data(morpho_data_t* morpho_data) {
     free_ui8matrix(morpho_data->IB_packed, morpho_data->i0, morpho_data->i1, morpho_data->j0, jp1);
     free_ui8matrix(morpho_data->IB_packed2, morpho_data->i0, morpho_data->i1, morpho_data->j0, jp1);
     free_ui8matrix(morpho_data->IB_packed3, morpho_data->i0, morpho_data->i1, morpho_data->j0, jp1);
+
+    const int n_words = PACKED_N_WORDS(morpho_data->j0, morpho_data->j1);
+    free_ui64matrix((uint64**)morpho_data->IB_words, morpho_data->i0, morpho_data->i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)morpho_data->IB_words2, morpho_data->i0, morpho_data->i1, 0, n_words - 1);
     
     free(morpho_data);
 }
@@ -364,13 +378,20 @@ void morpho_compute_closing3(morpho_data_t* morpho_data, const uint8_t** img_in,
 
 // Convert from 0/255 format to packed 1-bit format (8 pixels per byte)
 // Input: img_in[i][j] = 0 or 255
-// Output: img_packed[i][j/8] = 8 bits representing 8 consecutive pixels
+// Output: img_packed[i][j/8] = 8 bits representing 8 consecutive pixels, the bits after j1 are set to 0
 void morpho_pack_binary(const uint8_t** img_in, uint8_t** img_packed,
                         const int i0, const int i1, const int j0, const int j1) {
-    const int packed_j1 = (j1 - j0 + 1) / 8 + j0;
+    const int packed_j1 = (j1 - j0 + 1) / 8 + j0; // first byte not fully covered by the image
+    const int n_tail = (j1 - j0 + 1) % 8;
     
     #pragma omp parallel for schedule(static)
     for (int i = i0; i <= i1; i++) {
+        if (n_tail) {
+            uint8_t packed = 0;
+            for (int p = 0; p < n_tail; p++)
+                packed |= (img_in[i][j0 + (packed_j1 - j0) * 8 + p] ? 0x80 : 0) >> p;
+            img_packed[i][packed_j1] = packed;
+        }
         for (int jp = j0; jp < packed_j1; jp++) {
             int j = j0 + (jp - j0) * 8;
             uint8_t packed = 0;
@@ -391,10 +412,13 @@ void morpho_pack_binary(const uint8_t** img_in, uint8_t** img_packed,
 // Convert from packed 1-bit format back to 0/255 format
 void morpho_unpack_binary(const uint8_t** img_packed, uint8_t** img_out,
                           const int i0, const int i1, const int j0, const int j1) {
-    const int packed_j1 = (j1 - j0 + 1) / 8 + j0;
+    const int packed_j1 = (j1 - j0 + 1) / 8 + j0; // first byte not fully covered by the image
+    const int n_tail = (j1 - j0 + 1) % 8;
     
     #pragma omp parallel for schedule(static)
     for (int i = i0; i <= i1; i++) {
+        for (int p = 0; p < n_tail; p++)
+            img_out[i][j0 + (packed_j1 - j0) * 8 + p] = (img_packed[i][packed_j1] & (0x80 >> p)) ? 255 : 0;
         for (int jp = j0; jp < packed_j1; jp++) {
             int j = j0 + (jp - j0) * 8;
             uint8_t packed = img_packed[i][jp];
@@ -526,3 +550,238 @@ void morpho_compute_closing3_packed(uint8_t** img_packed, uint8_t** tmp1, uint8_
 // ============================================================================
 // END OF BIT-PACKING OPTIMIZATION
 // ============================================================================
+
+// ============================================================================
+// 64-BIT PACKED MORPHOLOGY
+// 64 pixels per word (LSB first, see PACKED_N_WORDS in macros.h). The
+// horizontal neighbors of the pixels of a word are obtained with 1-bit
+// shifts and the carry bits of the previous and next words. As in the byte
+// version, the first and last columns (and rows) are copied, and the bits
+// after the last column are kept to 0.
+// ============================================================================
+
+// Convert from 0/255 format to 64-bit packed format, the bits after j1 are set to 0
+void morpho_pack64(const uint8_t** img_in, uint64_t** img_out, const int i0, const int i1, const int j0,
+                   const int j1) {
+    const int n_words = PACKED_N_WORDS(j0, j1);
+
+    #pragma omp parallel for schedule(static)
+    for (int i = i0; i <= i1; i++)
+        for (int w = 0; w < n_words; w++) {
+            const int j = j0 + w * 64;
+            const int n_pixels = MIN(64, j1 - j + 1);
+            uint64_t word = 0;
+            for (int p = 0; p < n_pixels; p++)
+                word |= (uint64_t)(img_in[i][j + p] ? 1 : 0) << p;
+            img_out[i][w] = word;
+        }
+}
+
+// Convert from 64-bit packed format back to 0/255 format
+void morpho_unpack64(const uint64_t** img_in, uint8_t** img_out, const int i0, const int i1, const int j0,
+                     const int j1) {
+    #pragma omp parallel for schedule(static)
+    for (int i = i0; i <= i1; i++)
+        for (int j = j0; j <= j1; j++)
+            img_out[i][j] = (img_in[i][(j - j0) / 64] >> ((j - j0) % 64)) & 1 ? 255 : 0;
+}
+
+// Helper: horizontal erosion or dilation (1x3) of one packed word, `prev` and `next` are the neighbor words
+static inline uint64_t morpho_h3_packed64_word(const uint64_t prev, const uint64_t curr, const uint64_t next,
+                                               const int is_erosion) {
+    const uint64_t left = (curr << 1) | (prev >> 63);  // pixel j - 1
+    const uint64_t right = (curr >> 1) | (next << 63); // pixel j + 1
+    return is_erosion ? (curr & left & right) : (curr | left | right);
+}
+
+// Helper: horizontal erosion or dilation (1x3) of one packed row (`in` and `out` have to be different rows)
+static inline void morpho_h3_packed64_row(const uint64_t* in, uint64_t* out, const int j0, const int j1,
+                                          const int is_erosion) {
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    const uint64_t tail_mask = PACKED_TAIL_MASK(j0, j1);
+    const uint64_t last_bit = (uint64_t)1 << ((j1 - j0) % 64);
+    int w = 1;
+#ifdef MOTION_USE_MIPP
+    // the words `w - 1` and `w + 1` are loaded as unaligned registers: the carry bits come from the same lane
+    const int vec_size = mipp::N<int64_t>();
+    for (; w + vec_size <= n_words - 1; w += vec_size) {
+        const mipp::Reg<int64_t> prev = mipp::Reg<int64_t>((const int64_t*)&in[w - 1]);
+        const mipp::Reg<int64_t> curr = mipp::Reg<int64_t>((const int64_t*)&in[w]);
+        const mipp::Reg<int64_t> next = mipp::Reg<int64_t>((const int64_t*)&in[w + 1]);
+        const mipp::Reg<int64_t> left = (curr << 1) | (prev >> 63);  // pixel j - 1
+        const mipp::Reg<int64_t> right = (curr >> 1) | (next << 63); // pixel j + 1
+        const mipp::Reg<int64_t> result = is_erosion ? (curr & left & right) : (curr | left | right);
+        result.store((int64_t*)&out[w]);
+    }
+#endif
+    out[0] = morpho_h3_packed64_word(0, in[0], (n_words > 1) ? in[1] : 0, is_erosion);
+    for (; w < n_words; w++)
+        out[w] = morpho_h3_packed64_word(in[w - 1], in[w], (w + 1 < n_words) ? in[w + 1] : 0, is_erosion);
+    // copy the borders
+    out[0] = (out[0] & ~(uint64_t)1) | (in[0] & 1);
+    out[n_words - 1] = ((out[n_words - 1] & ~last_bit) | (in[n_words - 1] & last_bit)) & tail_mask;
+}
+
+// Helper: vertical erosion or dilation (3x1) of one packed row
+static inline void morpho_v3_packed64_row(const uint64_t* top, const uint64_t* center, const uint64_t* bottom,
+                                          uint64_t* out, const int n_words, const int is_erosion) {
+    int w = 0;
+#ifdef MOTION_USE_MIPP
+    const int vec_size = mipp::N<int64_t>();
+    for (; w <= n_words - vec_size; w += vec_size) {
+        const mipp::Reg<int64_t> t = mipp::Reg<int64_t>((const int64_t*)&top[w]);
+        const mipp::Reg<int64_t> c = mipp::Reg<int64_t>((const int64_t*)&center[w]);
+        const mipp::Reg<int64_t> b = mipp::Reg<int64_t>((const int64_t*)&bottom[w]);
+        const mipp::Reg<int64_t> result = is_erosion ? (t & c & b) : (t | c | b);
+        result.store((int64_t*)&out[w]);
+    }
+#endif
+    for (; w < n_words; w++)
+        out[w] = is_erosion ? (top[w] & center[w] & bottom[w]) : (top[w] | center[w] | bottom[w]);
+}
+
+// 64-bit packed horizontal erosion / dilation (1x3)
+static void morpho_compute_h3_packed64(const uint64_t** img_in, uint64_t** img_out, const int i0, const int i1,
+                                       const int j0, const int j1, const int is_erosion) {
+    #pragma omp parallel for schedule(static)
+    for (int i = i0; i <= i1; i++)
+        morpho_h3_packed64_row(img_in[i], img_out[i], j0, j1, is_erosion);
+}
+
+// 64-bit packed vertical erosion / dilation (3x1)
+static void morpho_compute_v3_packed64(const uint64_t** img_in, uint64_t** img_out, const int i0, const int i1,
+                                       const int j0, const int j1, const int is_erosion) {
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    // copy the border rows
+    memcpy(img_out[i0], img_in[i0], n_words * sizeof(uint64_t));
+    memcpy(img_out[i1], img_in[i1], n_words * sizeof(uint64_t));
+    #pragma omp parallel for schedule(static)
+    for (int i = i0 + 1; i <= i1 - 1; i++)
+        morpho_v3_packed64_row(img_in[i - 1], img_in[i], img_in[i + 1], img_out[i], n_words, is_erosion);
+}
+
+void morpho_compute_opening3_packed64(morpho_data_t* morpho_data, const uint64_t** img_in, uint64_t** img_out,
+                                      const int i0, const int i1, const int j0, const int j1) {
+    morpho_compute_h3_packed64(img_in, morpho_data->IB_words, i0, i1, j0, j1, 1);
+    morpho_compute_v3_packed64((const uint64_t**)morpho_data->IB_words, morpho_data->IB_words2, i0, i1, j0, j1, 1);
+    morpho_compute_h3_packed64((const uint64_t**)morpho_data->IB_words2, morpho_data->IB_words, i0, i1, j0, j1, 0);
+    morpho_compute_v3_packed64((const uint64_t**)morpho_data->IB_words, img_out, i0, i1, j0, j1, 0);
+}
+
+void morpho_compute_closing3_packed64(morpho_data_t* morpho_data, const uint64_t** img_in, uint64_t** img_out,
+                                      const int i0, const int i1, const int j0, const int j1) {
+    morpho_compute_h3_packed64(img_in, morpho_data->IB_words, i0, i1, j0, j1, 0);
+    morpho_compute_v3_packed64((const uint64_t**)morpho_data->IB_words, morpho_data->IB_words2, i0, i1, j0, j1, 0);
+    morpho_compute_h3_packed64((const uint64_t**)morpho_data->IB_words2, morpho_data->IB_words, i0, i1, j0, j1, 1);
+    morpho_compute_v3_packed64((const uint64_t**)morpho_data->IB_words, img_out, i0, i1, j0, j1, 1);
+}
+
+// ----------------------------------------------------------------------------
+// Fused opening + closing: each thread streams a horizontal band of the image
+// through the 4 passes (Eh->Ev, Dh->Dv, Dh->Dv, Eh->Ev). Each vertical pass
+// keeps the 3 last rows of its input in a ring (`ring[r % 3]` contains the
+// row `r`), so the pass `p` produces the row `k - 1 - p` when the row `k` of
+// the image enters the chain.
+// ----------------------------------------------------------------------------
+
+// Number of halo rows required on each side of a band: one per vertical pass
+#define MORPHO_PACKED64_HALO 4
+// Number of rows in the per-thread working set: one scratch row + 4 rings of 3 rows + 2 halos
+#define MORPHO_PACKED64_N_ROWS (1 + 4 * 3 + 2 * MORPHO_PACKED64_HALO)
+// Minimum height of a band (the rows of all the working sets have to fit in `IB_words`)
+#define MORPHO_PACKED64_MIN_BAND 32
+
+void morpho_compute_opening_closing3_packed64(morpho_data_t* morpho_data, const uint64_t** img_in,
+                                              uint64_t** img_out, const int i0, const int i1, const int j0,
+                                              const int j1) {
+    const int height = i1 - i0 + 1;
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    const size_t row_bytes = n_words * sizeof(uint64_t);
+    // erosion (1) or dilation (0) for each of the 4 passes
+    const int pass_is_erosion[4] = {1, 0, 0, 1};
+#ifdef _OPENMP
+    const int max_bands = MAX(1, MIN(omp_get_max_threads(), height / MORPHO_PACKED64_MIN_BAND));
+#else
+    const int max_bands = 1;
+#endif
+
+    #pragma omp parallel num_threads(max_bands)
+    {
+#ifdef _OPENMP
+        const int t = omp_get_thread_num();
+        const int n_bands = omp_get_num_threads();
+#else
+        const int t = 0;
+        const int n_bands = 1;
+#endif
+        const int b0 = i0 + (int)(((long)height * t) / n_bands);
+        const int b1 = i0 + (int)(((long)height * (t + 1)) / n_bands) - 1;
+
+        // working set of the thread in `IB_words` (or in a small buffer if the image is too small to contain it)
+        uint64_t* ws_buffer = NULL;
+        uint64_t* ws[MORPHO_PACKED64_N_ROWS];
+        for (int r = 0; r < MORPHO_PACKED64_N_ROWS; r++) {
+            if (height >= MORPHO_PACKED64_MIN_BAND) {
+                ws[r] = morpho_data->IB_words[i0 + t * MORPHO_PACKED64_N_ROWS + r];
+            } else {
+                if (!ws_buffer)
+                    ws_buffer = (uint64_t*)malloc(MORPHO_PACKED64_N_ROWS * row_bytes);
+                ws[r] = ws_buffer + r * (size_t)n_words;
+            }
+        }
+        uint64_t* scratch = ws[0];
+        uint64_t* ring[4][3];
+        for (int p = 0; p < 4; p++)
+            for (int r = 0; r < 3; r++)
+                ring[p][r] = ws[1 + 3 * p + r];
+        uint64_t** halo = &ws[1 + 4 * 3]; // rows `b0 - 4` to `b0 - 1`, then rows `b1 + 1` to `b1 + 4`
+
+        // 1. copy the input rows of the neighbor bands (in-place computing: the neighbors will overwrite them)
+        for (int h = 0; h < MORPHO_PACKED64_HALO; h++) {
+            if (b0 - MORPHO_PACKED64_HALO + h >= i0)
+                memcpy(halo[h], img_in[b0 - MORPHO_PACKED64_HALO + h], row_bytes);
+            if (b1 + 1 + h <= i1)
+                memcpy(halo[MORPHO_PACKED64_HALO + h], img_in[b1 + 1 + h], row_bytes);
+        }
+
+        #pragma omp barrier
+
+        // 2. streaming of the band, the frontier `k` is the last row of the image entered in the chain: the pass `p`
+        //    produces the row `k - 1 - p` and the first pass has to produce the rows up to `b1 + 3`, so the streaming
+        //    stops at the row `b1 + 3 + 1 = b1 + MORPHO_PACKED64_HALO` (the last pass then produces the row `b1`)
+        for (int k = b0 - MORPHO_PACKED64_HALO; k <= b1 + MORPHO_PACKED64_HALO; k++) {
+            // horizontal erosion of the input row
+            if (k >= i0 && k <= i1) {
+                const uint64_t* in_row;
+                if (k < b0)
+                    in_row = halo[k - (b0 - MORPHO_PACKED64_HALO)];
+                else if (k > b1)
+                    in_row = halo[MORPHO_PACKED64_HALO + k - (b1 + 1)];
+                else
+                    in_row = img_in[k];
+                morpho_h3_packed64_row(in_row, ring[0][k % 3], j0, j1, 1);
+            }
+            // vertical passes, the pass `p` produces the rows from `b0 - 3 + p` to `b1 + 3 - p`
+            for (int p = 0; p < 4; p++) {
+                const int r = k - 1 - p;
+                if (r < i0 || r > i1 || r < b0 - 3 + p || r > b1 + 3 - p)
+                    continue;
+                uint64_t* out_row = (p == 3) ? img_out[r] : scratch;
+                if (r == i0 || r == i1)
+                    memcpy(out_row, ring[p][r % 3], row_bytes);
+                else
+                    morpho_v3_packed64_row(ring[p][(r - 1) % 3], ring[p][r % 3], ring[p][(r + 1) % 3], out_row,
+                                           n_words, pass_is_erosion[p]);
+                if (p < 3)
+                    morpho_h3_packed64_row(out_row, ring[p + 1][r % 3], j0, j1, pass_is_erosion[p + 1]);
+            }
+        }
+
+        if (ws_buffer)
+            free(ws_buffer);
+    }
+}
+
+// ============================================================================
+// END OF 64-BIT PACKED MORPHOLOGY
+// ============================================================================
@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <nrc2.h>
+
+#include "motion/macros.h"
+#include "motion/features/features_compute.h"
+
+#include "motion/pipeline/pipeline_struct.h"
+
+pipeline_queue_t* pipeline_queue_alloc(const size_t max_size) {
+    assert(max_size > 0);
+    pipeline_queue_t* queue = (pipeline_queue_t*)malloc(sizeof(pipeline_queue_t));
+    queue->items = (size_t*)malloc(max_size * sizeof(size_t));
+    queue->head = 0;
+    queue->size = 0;
+    queue->_max_size = max_size;
+    queue->closed = 0;
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    return queue;
+}
+
+void pipeline_queue_free(pipeline_queue_t* queue) {
+    pthread_cond_destroy(&queue->not_full);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_mutex_destroy(&queue->mutex);
+    free(queue->items);
+    free(queue);
+}
+
+void pipeline_queue_push(pipeline_queue_t* queue, const size_t slot_id) {
+    pthread_mutex_lock(&queue->mutex);
+    assert(!queue->closed);
+    while (queue->size == queue->_max_size)
+        pthread_cond_wait(&queue->not_full, &queue->mutex);
+    queue->items[(queue->head + queue->size) % queue->_max_size] = slot_id;
+    queue->size++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+int pipeline_queue_pop(pipeline_queue_t* queue, size_t* slot_id) {
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->size == 0 && !queue->closed)
+        pthread_cond_wait(&queue->not_empty, &queue->mutex);
+    if (queue->size == 0) {
+        pthread_mutex_unlock(&queue->mutex);
+        return 0;
+    }
+    *slot_id = queue->items[queue->head];
+    queue->head = (queue->head + 1) % queue->_max_size;
+    queue->size--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->mutex);
+    return 1;
+}
+
+void pipeline_queue_close(pipeline_queue_t* queue) {
+    pthread_mutex_lock(&queue->mutex);
+    queue->closed = 1;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+pipeline_slot_t* pipeline_slots_alloc(const size_t n_slots, const int i0, const int i1, const int j0, const int j1,
+                                      const size_t max_RoIs_size, const uint8_t alloc_L2, const uint8_t packed) {
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    pipeline_slot_t* slots = (pipeline_slot_t*)malloc(n_slots * sizeof(pipeline_slot_t));
+    for (size_t s = 0; s < n_slots; s++) {
+        slots[s].frame = -1;
+        slots[s].IG = ui8matrix(i0, i1, j0, j1);
+        slots[s].IG_view = (const uint8_t**)slots[s].IG;
+        slots[s].IG_rows = (const uint8_t**)malloc((i1 - i0 + 1) * sizeof(const uint8_t*)) - i0;
+        slots[s].IB = packed ? NULL : ui8matrix(i0, i1, j0, j1);
+        slots[s].IB_packed = packed ? (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1) : NULL;
+        slots[s].L2 = alloc_L2 ? ui32matrix(i0, i1, j0, j1) : NULL;
+        slots[s].RoIs = features_alloc_RoIs(max_RoIs_size);
+        slots[s].n_RoIs = 0;
+        zero_ui8matrix(slots[s].IG, i0, i1, j0, j1);
+        if (packed)
+            zero_ui64matrix((uint64**)slots[s].IB_packed, i0, i1, 0, n_words - 1);
+        else
+            zero_ui8matrix(slots[s].IB, i0, i1, j0, j1);
+        if (alloc_L2)
+            zero_ui32matrix(slots[s].L2, i0, i1, j0, j1);
+        features_init_RoIs(slots[s].RoIs);
+    }
+    return slots;
+}
+
+void pipeline_slots_free(pipeline_slot_t* slots, const size_t n_slots, const int i0, const int i1, const int j0,
+                         const int j1) {
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    for (size_t s = 0; s < n_slots; s++) {
+        free_ui8matrix(slots[s].IG, i0, i1, j0, j1);
+        free(slots[s].IG_rows + i0);
+        if (slots[s].IB)
+            free_ui8matrix(slots[s].IB, i0, i1, j0, j1);
+        if (slots[s].IB_packed)
+            free_ui64matrix((uint64**)slots[s].IB_packed, i0, i1, 0, n_words - 1);
+        if (slots[s].L2)
+            free_ui32matrix(slots[s].L2, i0, i1, j0, j1);
+        features_free_RoIs(slots[s].RoIs);
+    }
+    free(slots);
+}
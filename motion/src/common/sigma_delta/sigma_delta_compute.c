@@ -1,6 +1,8 @@
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include <nrc2.h>
 
 #include "motion/macros.h"
@@ -14,6 +16,15 @@
 #include <omp.h>
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SD_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
 sigma_delta_data_t* sigma_delta_alloc_data(const int i0, const int i1, const int j0, const int j1, const uint8_t vmin,
                                            const uint8_t vmax) {
     sigma_delta_data_t* sd_data = (sigma_delta_data_t*)malloc(sizeof(sigma_delta_data_t));
@@ -47,27 +58,93 @@ void sigma_delta_free_data(sigma_delta_data_t* sd_data) {
 }
 
 // ============================================================================
-// OPERATOR FUSION: Sigma-Delta + Horizontal Erosion (Section 2.5.5)
-// This function computes Sigma-Delta and immediately applies horizontal 
-// erosion on the binary output, reducing memory traffic by keeping data
-// in cache between operations.
+// Sigma-Delta row kernels
+// One kernel per instruction set and per value of N: N * O is computed with
+// saturated additions for N from 1 to 4 and with a saturated multiplication
+// (double-and-add) for the other values. The instruction set is selected once
+// (from the CPUID on x86, whatever the compiler flags), then getting the
+// kernel of a given N is a lookup in `sigma_delta_row_kernels`.
 // ============================================================================
 
-// Helper: Compute Sigma-Delta for a single row and store to buffer
-static inline void sigma_delta_compute_row(sigma_delta_data_t *sd_data, 
-                                           const uint8_t* img_in_row,
-                                           uint8_t* binary_out_row,
-                                           uint8_t* M_row, uint8_t* O_row, uint8_t* V_row,
-                                           const int j0, const int j1, 
-                                           const uint8_t N, const uint8_t vmin, const uint8_t vmax) {
+#if defined(__GNUC__)
+#define SD_INLINE static inline __attribute__((always_inline))
+#else
+#define SD_INLINE static inline
+#endif
+
+#if defined(SD_X86_DISPATCH)
+#define SD_TARGET_AVX2 __attribute__((target("avx2")))
+#define SD_TARGET_AVX512BW __attribute__((target("avx512bw")))
+#endif
+
+#define SD_ROW_KERNEL_ARGS                                                                                             \
+    const uint8_t *img_in_row, uint8_t *binary_out_row, uint8_t *M_row, uint8_t *O_row, uint8_t *V_row, const int j0,  \
+        const int j1, const uint8_t N, const uint8_t vmin, const uint8_t vmax
+
+// Computes Sigma-Delta for the pixels `j0` to `j1` of a row (the row pointers are indexed by `j`)
+typedef void (*sigma_delta_row_kernel_t)(SD_ROW_KERNEL_ARGS);
+
+// Index of the most significant bit of N (-1 if N = 0), the double-and-add starts from there
+static inline int sigma_delta_n_msb(const uint8_t N) {
+    int b = 7;
+    while (b >= 0 && !((N >> b) & 1))
+        b--;
+    return b;
+}
+
+SD_INLINE void sigma_delta_row_scalar(SD_ROW_KERNEL_ARGS) {
+    for (int j = j0; j <= j1; j++) {
+        uint8_t m = M_row[j];
+        if (m < img_in_row[j]) m++;
+        else if (m > img_in_row[j]) m--;
+        M_row[j] = m;
+
+        uint8_t o = (m > img_in_row[j]) ? (m - img_in_row[j]) : (img_in_row[j] - m);
+        O_row[j] = o;
+
+        uint8_t v = V_row[j];
+        uint8_t no = (N * o > 255) ? 255 : N * o;
+        if (v < no) v++;
+        else if (v > no) v--;
+        v = (v > vmax) ? vmax : ((v < vmin) ? vmin : v);
+        V_row[j] = v;
+
+        binary_out_row[j] = (o < v) ? 0 : 255;
+    }
+}
+
 #ifdef MOTION_USE_MIPP
+// saturated N * O (the additions of `uint8_t` registers are saturated in MIPP)
+SD_INLINE mipp::Reg<uint8_t> sigma_delta_n_times_mipp(const mipp::Reg<uint8_t> O_reg, const uint8_t N,
+                                                      const int n_msb) {
+    if (N == 1)
+        return O_reg;
+    if (N == 2)
+        return O_reg + O_reg;
+    if (N == 3)
+        return O_reg + O_reg + O_reg;
+    if (N == 4) {
+        const mipp::Reg<uint8_t> O2_reg = O_reg + O_reg;
+        return O2_reg + O2_reg;
+    }
+    mipp::Reg<uint8_t> NO_reg = (uint8_t)0;
+    for (int b = n_msb; b >= 0; b--) {
+        NO_reg = NO_reg + NO_reg;
+        if ((N >> b) & 1)
+            NO_reg = NO_reg + O_reg;
+    }
+    return NO_reg;
+}
+
+SD_INLINE void sigma_delta_row_mipp(SD_ROW_KERNEL_ARGS) {
     const int vec_size = mipp::N<uint8_t>();
+    const int n_msb = sigma_delta_n_msb(N);
     const mipp::Reg<uint8_t> one = (uint8_t)1;
     const mipp::Reg<uint8_t> vmin_reg = vmin;
     const mipp::Reg<uint8_t> vmax_reg = vmax;
     const mipp::Reg<uint8_t> zero_reg = (uint8_t)0;
     const mipp::Reg<uint8_t> val_255 = (uint8_t)255;
-    
+
     int j;
     for (j = j0; j <= j1 - vec_size + 1; j += vec_size) {
         mipp::Reg<uint8_t> M_reg = mipp::Reg<uint8_t>(&M_row[j]);
@@ -87,7 +164,7 @@ static inline void sigma_delta_compute_row(sigma_delta_data_t *sd_data,
         O_reg.store(&O_row[j]);
 
         // Step 3: Variance update
-        mipp::Reg<uint8_t> NO_reg = O_reg + O_reg;
+        mipp::Reg<uint8_t> NO_reg = sigma_delta_n_times_mipp(O_reg, N, n_msb);
         mipp::Msk<mipp::N<uint8_t>()> v_lt_mask = V_reg < NO_reg;
         mipp::Msk<mipp::N<uint8_t>()> v_gt_mask = V_reg > NO_reg;
         inc = mipp::blend(one, zero_reg, v_lt_mask);
@@ -102,47 +179,247 @@ static inline void sigma_delta_compute_row(sigma_delta_data_t *sd_data,
         out_reg.store(&binary_out_row[j]);
     }
     // Scalar remainder
-    for (; j <= j1; j++) {
-        uint8_t m = M_row[j];
-        if (m < img_in_row[j]) m++;
-        else if (m > img_in_row[j]) m--;
-        M_row[j] = m;
+    sigma_delta_row_scalar(img_in_row, binary_out_row, M_row, O_row, V_row, j, j1, N, vmin, vmax);
+}
+#endif
 
-        uint8_t o = (m > img_in_row[j]) ? (m - img_in_row[j]) : (img_in_row[j] - m);
-        O_row[j] = o;
+#if defined(SD_X86_DISPATCH)
+// The AVX kernels only use saturated arithmetic, no comparison:
+//   M += min(I -sat M, 1) - min(M -sat I, 1), O = (M -sat I) | (I -sat M),
+//   V += min(NO -sat V, 1) - min(V -sat NO, 1) and O >= V <=> V -sat O = 0.
+
+SD_INLINE SD_TARGET_AVX2 __m256i sigma_delta_n_times_avx2(const __m256i O_reg, const uint8_t N, const int n_msb) {
+    if (N == 1)
+        return O_reg;
+    if (N == 2)
+        return _mm256_adds_epu8(O_reg, O_reg);
+    if (N == 3)
+        return _mm256_adds_epu8(_mm256_adds_epu8(O_reg, O_reg), O_reg);
+    if (N == 4) {
+        const __m256i O2_reg = _mm256_adds_epu8(O_reg, O_reg);
+        return _mm256_adds_epu8(O2_reg, O2_reg);
+    }
+    __m256i NO_reg = _mm256_setzero_si256();
+    for (int b = n_msb; b >= 0; b--) {
+        NO_reg = _mm256_adds_epu8(NO_reg, NO_reg);
+        if ((N >> b) & 1)
+            NO_reg = _mm256_adds_epu8(NO_reg, O_reg);
+    }
+    return NO_reg;
+}
 
-        uint8_t v = V_row[j];
-        uint8_t no = (N * o > 255) ? 255 : N * o;
-        if (v < no) v++;
-        else if (v > no) v--;
-        v = (v > vmax) ? vmax : ((v < vmin) ? vmin : v);
-        V_row[j] = v;
+SD_INLINE SD_TARGET_AVX2 void sigma_delta_row_avx2(SD_ROW_KERNEL_ARGS) {
+    const int n_msb = sigma_delta_n_msb(N);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i vmin_reg = _mm256_set1_epi8((char)vmin);
+    const __m256i vmax_reg = _mm256_set1_epi8((char)vmax);
+    const __m256i zero_reg = _mm256_setzero_si256();
 
-        binary_out_row[j] = (o < v) ? 0 : 255;
+    int j;
+    for (j = j0; j <= j1 - 32 + 1; j += 32) {
+        __m256i M_reg = _mm256_loadu_si256((const __m256i*)&M_row[j]);
+        const __m256i I_reg = _mm256_loadu_si256((const __m256i*)&img_in_row[j]);
+        __m256i V_reg = _mm256_loadu_si256((const __m256i*)&V_row[j]);
+
+        // Step 1: Mean update
+        M_reg = _mm256_sub_epi8(_mm256_add_epi8(M_reg, _mm256_min_epu8(_mm256_subs_epu8(I_reg, M_reg), one)),
+                                _mm256_min_epu8(_mm256_subs_epu8(M_reg, I_reg), one));
+        _mm256_storeu_si256((__m256i*)&M_row[j], M_reg);
+
+        // Step 2: Difference
+        const __m256i O_reg = _mm256_or_si256(_mm256_subs_epu8(M_reg, I_reg), _mm256_subs_epu8(I_reg, M_reg));
+        _mm256_storeu_si256((__m256i*)&O_row[j], O_reg);
+
+        // Step 3: Variance update
+        const __m256i NO_reg = sigma_delta_n_times_avx2(O_reg, N, n_msb);
+        V_reg = _mm256_sub_epi8(_mm256_add_epi8(V_reg, _mm256_min_epu8(_mm256_subs_epu8(NO_reg, V_reg), one)),
+                                _mm256_min_epu8(_mm256_subs_epu8(V_reg, NO_reg), one));
+        V_reg = _mm256_max_epu8(_mm256_min_epu8(V_reg, vmax_reg), vmin_reg);
+        _mm256_storeu_si256((__m256i*)&V_row[j], V_reg);
+
+        // Step 4: Binary output
+        const __m256i out_reg = _mm256_cmpeq_epi8(_mm256_subs_epu8(V_reg, O_reg), zero_reg);
+        _mm256_storeu_si256((__m256i*)&binary_out_row[j], out_reg);
     }
-#else
-    for (int j = j0; j <= j1; j++) {
-        uint8_t m = M_row[j];
-        if (m < img_in_row[j]) m++;
-        else if (m > img_in_row[j]) m--;
-        M_row[j] = m;
+    // Scalar remainder
+    sigma_delta_row_scalar(img_in_row, binary_out_row, M_row, O_row, V_row, j, j1, N, vmin, vmax);
+}
 
-        uint8_t o = (m > img_in_row[j]) ? (m - img_in_row[j]) : (img_in_row[j] - m);
-        O_row[j] = o;
+SD_INLINE SD_TARGET_AVX512BW __m512i sigma_delta_n_times_avx512bw(const __m512i O_reg, const uint8_t N,
+                                                                  const int n_msb) {
+    if (N == 1)
+        return O_reg;
+    if (N == 2)
+        return _mm512_adds_epu8(O_reg, O_reg);
+    if (N == 3)
+        return _mm512_adds_epu8(_mm512_adds_epu8(O_reg, O_reg), O_reg);
+    if (N == 4) {
+        const __m512i O2_reg = _mm512_adds_epu8(O_reg, O_reg);
+        return _mm512_adds_epu8(O2_reg, O2_reg);
+    }
+    __m512i NO_reg = _mm512_setzero_si512();
+    for (int b = n_msb; b >= 0; b--) {
+        NO_reg = _mm512_adds_epu8(NO_reg, NO_reg);
+        if ((N >> b) & 1)
+            NO_reg = _mm512_adds_epu8(NO_reg, O_reg);
+    }
+    return NO_reg;
+}
 
-        uint8_t v = V_row[j];
-        uint8_t no = (N * o > 255) ? 255 : N * o;
-        if (v < no) v++;
-        else if (v > no) v--;
-        v = (v > vmax) ? vmax : ((v < vmin) ? vmin : v);
-        V_row[j] = v;
+SD_INLINE SD_TARGET_AVX512BW void sigma_delta_row_avx512bw(SD_ROW_KERNEL_ARGS) {
+    const int n_msb = sigma_delta_n_msb(N);
+    const __m512i one = _mm512_set1_epi8(1);
+    const __m512i vmin_reg = _mm512_set1_epi8((char)vmin);
+    const __m512i vmax_reg = _mm512_set1_epi8((char)vmax);
+    const __m512i zero_reg = _mm512_setzero_si512();
 
-        binary_out_row[j] = (o < v) ? 0 : 255;
+    int j;
+    for (j = j0; j <= j1 - 64 + 1; j += 64) {
+        __m512i M_reg = _mm512_loadu_si512((const void*)&M_row[j]);
+        const __m512i I_reg = _mm512_loadu_si512((const void*)&img_in_row[j]);
+        __m512i V_reg = _mm512_loadu_si512((const void*)&V_row[j]);
+
+        // Step 1: Mean update
+        M_reg = _mm512_sub_epi8(_mm512_add_epi8(M_reg, _mm512_min_epu8(_mm512_subs_epu8(I_reg, M_reg), one)),
+                                _mm512_min_epu8(_mm512_subs_epu8(M_reg, I_reg), one));
+        _mm512_storeu_si512((void*)&M_row[j], M_reg);
+
+        // Step 2: Difference
+        const __m512i O_reg = _mm512_or_si512(_mm512_subs_epu8(M_reg, I_reg), _mm512_subs_epu8(I_reg, M_reg));
+        _mm512_storeu_si512((void*)&O_row[j], O_reg);
+
+        // Step 3: Variance update
+        const __m512i NO_reg = sigma_delta_n_times_avx512bw(O_reg, N, n_msb);
+        V_reg = _mm512_sub_epi8(_mm512_add_epi8(V_reg, _mm512_min_epu8(_mm512_subs_epu8(NO_reg, V_reg), one)),
+                                _mm512_min_epu8(_mm512_subs_epu8(V_reg, NO_reg), one));
+        V_reg = _mm512_max_epu8(_mm512_min_epu8(V_reg, vmax_reg), vmin_reg);
+        _mm512_storeu_si512((void*)&V_row[j], V_reg);
+
+        // Step 4: Binary output
+        const __mmask64 motion_mask = _mm512_cmpeq_epi8_mask(_mm512_subs_epu8(V_reg, O_reg), zero_reg);
+        _mm512_storeu_si512((void*)&binary_out_row[j], _mm512_movm_epi8(motion_mask));
     }
+    // Scalar remainder
+    sigma_delta_row_scalar(img_in_row, binary_out_row, M_row, O_row, V_row, j, j1, N, vmin, vmax);
+}
+#endif
+
+// Specialized kernels of an instruction set: `_nx` for any N, `_n1` to `_n4` for N = 1 to 4
+#define SD_ROW_KERNELS(isa, target)                                                                                    \
+    static target void sigma_delta_row_##isa##_nx(SD_ROW_KERNEL_ARGS) {                                                \
+        sigma_delta_row_##isa(img_in_row, binary_out_row, M_row, O_row, V_row, j0, j1, N, vmin, vmax);                 \
+    }                                                                                                                  \
+    static target void sigma_delta_row_##isa##_n1(SD_ROW_KERNEL_ARGS) {                                                \
+        (void)N;                                                                                                       \
+        sigma_delta_row_##isa(img_in_row, binary_out_row, M_row, O_row, V_row, j0, j1, 1, vmin, vmax);                 \
+    }                                                                                                                  \
+    static target void sigma_delta_row_##isa##_n2(SD_ROW_KERNEL_ARGS) {                                                \
+        (void)N;                                                                                                       \
+        sigma_delta_row_##isa(img_in_row, binary_out_row, M_row, O_row, V_row, j0, j1, 2, vmin, vmax);                 \
+    }                                                                                                                  \
+    static target void sigma_delta_row_##isa##_n3(SD_ROW_KERNEL_ARGS) {                                                \
+        (void)N;                                                                                                       \
+        sigma_delta_row_##isa(img_in_row, binary_out_row, M_row, O_row, V_row, j0, j1, 3, vmin, vmax);                 \
+    }                                                                                                                  \
+    static target void sigma_delta_row_##isa##_n4(SD_ROW_KERNEL_ARGS) {                                                \
+        (void)N;                                                                                                       \
+        sigma_delta_row_##isa(img_in_row, binary_out_row, M_row, O_row, V_row, j0, j1, 4, vmin, vmax);                 \
+    }
+
+#define SD_ROW_KERNELS_ENTRY(isa)                                                                                      \
+    { sigma_delta_row_##isa##_nx, sigma_delta_row_##isa##_n1, sigma_delta_row_##isa##_n2,                              \
+      sigma_delta_row_##isa##_n3, sigma_delta_row_##isa##_n4 }
+#define SD_ROW_KERNELS_NONE { NULL, NULL, NULL, NULL, NULL }
+
+SD_ROW_KERNELS(scalar, )
+#ifdef MOTION_USE_MIPP
+SD_ROW_KERNELS(mipp, )
+#endif
+#if defined(SD_X86_DISPATCH)
+SD_ROW_KERNELS(avx2, SD_TARGET_AVX2)
+SD_ROW_KERNELS(avx512bw, SD_TARGET_AVX512BW)
+#endif
+
+// Dispatch table indexed by `sigma_delta_isa_e` and by N (the column 0 is the kernel for N = 0 or N > 4), NULL if
+// the instruction set is not compiled
+static const sigma_delta_row_kernel_t sigma_delta_row_kernels[][5] = {
+    SD_ROW_KERNELS_NONE, // SD_ISA_AUTO
+    SD_ROW_KERNELS_ENTRY(scalar),
+#ifdef MOTION_USE_MIPP
+    SD_ROW_KERNELS_ENTRY(mipp),
+#else
+    SD_ROW_KERNELS_NONE,
+#endif
+#if defined(SD_X86_DISPATCH)
+    SD_ROW_KERNELS_ENTRY(avx2),
+    SD_ROW_KERNELS_ENTRY(avx512bw),
+#else
+    SD_ROW_KERNELS_NONE,
+    SD_ROW_KERNELS_NONE,
+#endif
+};
+
+static enum sigma_delta_isa_e sigma_delta_isa = SD_ISA_AUTO;
+static pthread_once_t sigma_delta_isa_once = PTHREAD_ONCE_INIT;
+
+int sigma_delta_isa_supported(const enum sigma_delta_isa_e isa) {
+    if (sigma_delta_row_kernels[isa][0] == NULL)
+        return 0;
+#if defined(SD_X86_DISPATCH)
+    if (isa == SD_ISA_AVX2)
+        return __builtin_cpu_supports("avx2");
+    if (isa == SD_ISA_AVX512BW)
+        return __builtin_cpu_supports("avx512bw");
+#endif
+    return 1;
+}
+
+static enum sigma_delta_isa_e sigma_delta_best_isa(void) {
+    // the AVX kernels are only worth it if the compiler flags did not already give MIPP registers as wide
+#ifdef MOTION_USE_MIPP
+    const int mipp_size = mipp::N<uint8_t>();
+#else
+    const int mipp_size = 0;
 #endif
+    if (mipp_size < 64 && sigma_delta_isa_supported(SD_ISA_AVX512BW))
+        return SD_ISA_AVX512BW;
+    if (mipp_size < 32 && sigma_delta_isa_supported(SD_ISA_AVX2))
+        return SD_ISA_AVX2;
+    if (sigma_delta_isa_supported(SD_ISA_MIPP))
+        return SD_ISA_MIPP;
+    return SD_ISA_SCALAR;
 }
 
-// Helper: Apply horizontal erosion to a single row
+static void sigma_delta_isa_init(void) {
+    if (sigma_delta_isa == SD_ISA_AUTO)
+        sigma_delta_isa = sigma_delta_best_isa();
+}
+
+enum sigma_delta_isa_e sigma_delta_select_isa(const enum sigma_delta_isa_e isa) {
+    const enum sigma_delta_isa_e selected = (isa == SD_ISA_AUTO) ? sigma_delta_best_isa() : isa;
+    if (!sigma_delta_isa_supported(selected)) {
+        fprintf(stderr, "(EE) '%s()' failed, the '%s' Sigma-Delta kernels are not supported (build or CPU).\n",
+                __func__, sigma_delta_isa_to_str(selected));
+        exit(-1);
+    }
+    pthread_once(&sigma_delta_isa_once, sigma_delta_isa_init);
+    sigma_delta_isa = selected;
+    return selected;
+}
+
+// Kernel of the selected instruction set specialized for N
+static inline sigma_delta_row_kernel_t sigma_delta_row_kernel(const uint8_t N) {
+    pthread_once(&sigma_delta_isa_once, sigma_delta_isa_init);
+    return sigma_delta_row_kernels[sigma_delta_isa][N <= 4 ? N : 0];
+}
+
+// ============================================================================
+// OPERATOR FUSION: Sigma-Delta + Horizontal Erosion (Section 2.5.5)
+// This function computes Sigma-Delta and immediately applies horizontal 
+// erosion on the binary output, reducing memory traffic by keeping data
+// in cache between operations.
+// ============================================================================
+
 static inline void erosion_h3_row(const uint8_t* in_row, uint8_t* out_row,
                                   const int j0, const int j1) {
 #ifdef MOTION_USE_MIPP
@@ -198,100 +475,183 @@ static inline void dilation_h3_row(const uint8_t* in_row, uint8_t* out_row,
 #endif
 }
 
+// Helper: Apply vertical erosion to a single row (from the rows above, current and below)
+static inline void erosion_v3_row(const uint8_t* in_row0, const uint8_t* in_row1, const uint8_t* in_row2,
+                                  uint8_t* out_row, const int j0, const int j1) {
+#ifdef MOTION_USE_MIPP
+    const int vec_size = mipp::N<uint8_t>();
+    int j;
+    for (j = j0; j <= j1 - vec_size + 1; j += vec_size) {
+        mipp::Reg<uint8_t> r0 = mipp::Reg<uint8_t>(&in_row0[j]);
+        mipp::Reg<uint8_t> r1 = mipp::Reg<uint8_t>(&in_row1[j]);
+        mipp::Reg<uint8_t> r2 = mipp::Reg<uint8_t>(&in_row2[j]);
+        mipp::Reg<uint8_t> result = r0 & r1 & r2;
+        result.store(&out_row[j]);
+    }
+    for (; j <= j1; j++)
+        out_row[j] = in_row0[j] & in_row1[j] & in_row2[j];
+#else
+    for (int j = j0; j <= j1; j++)
+        out_row[j] = in_row0[j] & in_row1[j] & in_row2[j];
+#endif
+}
+
+// Helper: Apply vertical dilation to a single row (from the rows above, current and below)
+static inline void dilation_v3_row(const uint8_t* in_row0, const uint8_t* in_row1, const uint8_t* in_row2,
+                                   uint8_t* out_row, const int j0, const int j1) {
+#ifdef MOTION_USE_MIPP
+    const int vec_size = mipp::N<uint8_t>();
+    int j;
+    for (j = j0; j <= j1 - vec_size + 1; j += vec_size) {
+        mipp::Reg<uint8_t> r0 = mipp::Reg<uint8_t>(&in_row0[j]);
+        mipp::Reg<uint8_t> r1 = mipp::Reg<uint8_t>(&in_row1[j]);
+        mipp::Reg<uint8_t> r2 = mipp::Reg<uint8_t>(&in_row2[j]);
+        mipp::Reg<uint8_t> result = r0 | r1 | r2;
+        result.store(&out_row[j]);
+    }
+    for (; j <= j1; j++)
+        out_row[j] = in_row0[j] | in_row1[j] | in_row2[j];
+#else
+    for (int j = j0; j <= j1; j++)
+        out_row[j] = in_row0[j] | in_row1[j] | in_row2[j];
+#endif
+}
+
+// Helper: Apply a vertical pass to the row `i` of a 3-row ring (`ring[r % 3]` contains the row `r`), the first and
+// the last rows of the image are copied
+static inline void morpho_v3_ring_row(uint8_t** ring, const int i, const int i0, const int i1, uint8_t* out_row,
+                                      const int j0, const int j1, const int is_erosion) {
+    if (i == i0 || i == i1)
+        memcpy(&out_row[j0], &ring[i % 3][j0], j1 - j0 + 1);
+    else if (is_erosion)
+        erosion_v3_row(ring[(i - 1) % 3], ring[i % 3], ring[(i + 1) % 3], out_row, j0, j1);
+    else
+        dilation_v3_row(ring[(i - 1) % 3], ring[i % 3], ring[(i + 1) % 3], out_row, j0, j1);
+}
+
 // ============================================================================
-// FUSED PIPELINE: Sigma-Delta + Opening + Closing
-// Processes the image in row chunks to maximize L1/L2 cache utilization.
-// Each chunk goes through all operations before moving to the next chunk.
+// FUSED PIPELINE: Sigma-Delta + Opening + Closing (strip-mining)
+// Each thread owns a horizontal band of the image and streams it row by row
+// through all the operators. Only a few rows per thread are alive at a time
+// (in rings of 3 rows, one ring per vertical pass), so the intermediate
+// images never go back to the main memory: only the final binary row is
+// written in `img_out`.
 // ============================================================================
 
+// Number of halo rows required on each side of a band: one per vertical pass
+#define SD_MORPHO_HALO 4
+// Number of rows in the per-thread working set: one scratch row + 4 rings of 3 rows
+#define SD_MORPHO_N_ROWS 13
+// Minimum height of a band (bands must be at least as high as the halo, and the rows of all the working sets have to
+// fit in `tmp2`)
+#define SD_MORPHO_MIN_BAND 16
+
 void sigma_delta_morpho_fused(sigma_delta_data_t *sd_data, 
                               const uint8_t** img_in, uint8_t** img_out,
                               uint8_t** tmp1, uint8_t** tmp2,
                               const int i0, const int i1, const int j0, const int j1, 
                               const uint8_t N) {
+    const sigma_delta_row_kernel_t sd_kernel = sigma_delta_row_kernel(N);
     const int height = i1 - i0 + 1;
-    const int width = j1 - j0 + 1;
-    
+#ifdef _OPENMP
+    const int max_bands = MAX(1, MIN(omp_get_max_threads(), height / SD_MORPHO_MIN_BAND));
+#else
+    const int max_bands = 1;
+#endif
+
     // ------------------------------------------------------------------------
-    // PIPELINE STRATEGY (Section 2.5.3)
-    // To stay in cache, we process the image in strips of rows.
-    // However, vertical operations (3x1) create dependencies between rows.
-    // Opening (Eh->Ev->Dh->Dv) + Closing (Dh->Dv->Eh->Ev) = 4 vertical passes.
-    // Each vertical pass needs 1 row above and 1 row below.
-    // Total vertical dependency: 4 rows.
+    // Opening (Eh->Ev->Dh->Dv) + Closing (Dh->Dv->Eh->Ev) = 4 vertical passes,
+    // each pass needs 1 row above and 1 row below: the output row `i` depends
+    // on the Sigma-Delta rows from `i - 4` to `i + 4`.
+    // Sigma-Delta updates M and V, so a Sigma-Delta row can't be recomputed by
+    // two threads: the 4 first and 4 last Sigma-Delta rows of each band are
+    // computed first (in `tmp1`), then after a barrier each thread reads the
+    // halo rows of its neighbors from there and recomputes only the cheap
+    // horizontal passes.
     // ------------------------------------------------------------------------
 
-    // For maximum performance and simplicity in this fused version, 
-    // we use the fused row-level operators with OpenMP.
-    
-    // 1. Sigma-Delta + Horizontal Erosion (Fused)
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        sigma_delta_compute_row(sd_data, img_in[i], tmp1[i],
-                                sd_data->M[i], sd_data->O[i], sd_data->V[i],
-                                j0, j1, N, sd_data->vmin, sd_data->vmax);
-        erosion_h3_row(tmp1[i], tmp2[i], j0, j1);
-    }
-    
-    // 2. Vertical Erosion -> tmp1
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        if (i == i0 || i == i1) {
-            memcpy(&tmp1[i][j0], &tmp2[i][j0], width);
-        } else {
-            for (int j = j0; j <= j1; j++)
-                tmp1[i][j] = tmp2[i-1][j] & tmp2[i][j] & tmp2[i+1][j];
+    #pragma omp parallel num_threads(max_bands)
+    {
+#ifdef _OPENMP
+        const int t = omp_get_thread_num();
+        const int n_bands = omp_get_num_threads();
+#else
+        const int t = 0;
+        const int n_bands = 1;
+#endif
+        const int b0 = i0 + (int)(((long)height * t) / n_bands);
+        const int b1 = i0 + (int)(((long)height * (t + 1)) / n_bands) - 1;
+
+        // 1. Sigma-Delta of the edge rows of the band
+        for (int i = b0; i <= b1; i++) {
+            if (i - b0 < SD_MORPHO_HALO || b1 - i < SD_MORPHO_HALO) {
+                sd_kernel(img_in[i], tmp1[i], sd_data->M[i], sd_data->O[i], sd_data->V[i], j0, j1, N, sd_data->vmin,
+                          sd_data->vmax);
+            }
         }
-    }
 
-    // 3. Horizontal Dilation + Vertical Dilation (Fused)
-    // We can fuse the horizontal pass of the next step
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        dilation_h3_row(tmp1[i], tmp2[i], j0, j1);
-    }
-    
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        if (i == i0 || i == i1) {
-            memcpy(&tmp1[i][j0], &tmp2[i][j0], width);
-        } else {
-            for (int j = j0; j <= j1; j++)
-                tmp1[i][j] = tmp2[i-1][j] | tmp2[i][j] | tmp2[i+1][j];
+        #pragma omp barrier
+
+        // 2. Streaming of the band: working set of the thread in `tmp2` (or in a small buffer if the image is too
+        //    small to contain it)
+        uint8_t* ws_buffer = NULL;
+        uint8_t* ws[SD_MORPHO_N_ROWS];
+        for (int r = 0; r < SD_MORPHO_N_ROWS; r++) {
+            if (height >= SD_MORPHO_N_ROWS) {
+                ws[r] = tmp2[i0 + t * SD_MORPHO_N_ROWS + r];
+            } else {
+                if (!ws_buffer)
+                    ws_buffer = (uint8_t*)malloc(SD_MORPHO_N_ROWS * (size_t)(j1 + 1));
+                ws[r] = ws_buffer + r * (size_t)(j1 + 1);
+            }
         }
-    }
-    // End of Opening. tmp1 contains the result.
-
-    // 4. Closing: Horizontal Dilation + Vertical Dilation
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        dilation_h3_row(tmp1[i], tmp2[i], j0, j1);
-    }
-    
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        if (i == i0 || i == i1) {
-            memcpy(&tmp1[i][j0], &tmp2[i][j0], width);
-        } else {
-            for (int j = j0; j <= j1; j++)
-                tmp1[i][j] = tmp2[i-1][j] | tmp2[i][j] | tmp2[i+1][j];
+        uint8_t* scratch = ws[0];
+        uint8_t* ring_eh[3], *ring_dh1[3], *ring_dh2[3], *ring_eh2[3];
+        for (int r = 0; r < 3; r++) {
+            ring_eh[r] = ws[1 + r];
+            ring_dh1[r] = ws[4 + r];
+            ring_dh2[r] = ws[7 + r];
+            ring_eh2[r] = ws[10 + r];
         }
-    }
 
-    // 5. Horizontal Erosion + Vertical Erosion -> img_out
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        erosion_h3_row(tmp1[i], tmp2[i], j0, j1);
-    }
-    
-    #pragma omp parallel for schedule(static)
-    for (int i = i0; i <= i1; i++) {
-        if (i == i0 || i == i1) {
-            memcpy(&img_out[i][j0], &tmp2[i][j0], width);
-        } else {
-            for (int j = j0; j <= j1; j++)
-                img_out[i][j] = tmp2[i-1][j] & tmp2[i][j] & tmp2[i+1][j];
+        // the frontier `k` is the last Sigma-Delta row computed, the row `k - p` is produced by the vertical pass `p`
+        for (int k = b0 - SD_MORPHO_HALO; k <= b1 + SD_MORPHO_HALO; k++) {
+            // Sigma-Delta + horizontal erosion
+            if (k >= i0 && k <= i1) {
+                const uint8_t* sd_row;
+                if (k >= b0 + SD_MORPHO_HALO && k <= b1 - SD_MORPHO_HALO) {
+                    sd_kernel(img_in[k], scratch, sd_data->M[k], sd_data->O[k], sd_data->V[k], j0, j1, N,
+                              sd_data->vmin, sd_data->vmax);
+                    sd_row = scratch;
+                } else {
+                    sd_row = tmp1[k];
+                }
+                erosion_h3_row(sd_row, ring_eh[(k - i0) % 3], j0, j1);
+            }
+            // vertical erosion + horizontal dilation
+            int i = k - 1;
+            if (i >= MAX(i0, b0 - 3) && i <= MIN(i1, b1 + 3)) {
+                morpho_v3_ring_row(ring_eh, i - i0, 0, i1 - i0, scratch, j0, j1, 1);
+                dilation_h3_row(scratch, ring_dh1[(i - i0) % 3], j0, j1);
+            }
+            // vertical dilation + horizontal dilation (end of the opening)
+            i = k - 2;
+            if (i >= MAX(i0, b0 - 2) && i <= MIN(i1, b1 + 2)) {
+                morpho_v3_ring_row(ring_dh1, i - i0, 0, i1 - i0, scratch, j0, j1, 0);
+                dilation_h3_row(scratch, ring_dh2[(i - i0) % 3], j0, j1);
+            }
+            // vertical dilation + horizontal erosion
+            i = k - 3;
+            if (i >= MAX(i0, b0 - 1) && i <= MIN(i1, b1 + 1)) {
+                morpho_v3_ring_row(ring_dh2, i - i0, 0, i1 - i0, scratch, j0, j1, 0);
+                erosion_h3_row(scratch, ring_eh2[(i - i0) % 3], j0, j1);
+            }
+            // vertical erosion (end of the closing) -> img_out
+            i = k - 4;
+            if (i >= b0 && i <= b1)
+                morpho_v3_ring_row(ring_eh2, i - i0, 0, i1 - i0, img_out[i], j0, j1, 1);
         }
+        free(ws_buffer);
     }
 }
 
@@ -314,6 +674,7 @@ void sigma_delta_morpho_pipelined(sigma_delta_data_t *sd_data,
                                   const int i0, const int i1,
                                   const int j0, const int j1,
                                   const uint8_t N) {
+    const sigma_delta_row_kernel_t sd_kernel = sigma_delta_row_kernel(N);
     const int width = j1 - j0 + 1;
 
     // ========================================================================
@@ -324,9 +685,8 @@ void sigma_delta_morpho_pipelined(sigma_delta_data_t *sd_data,
     // 1. Sigma-Delta (row-independent, fully parallelizable)
     #pragma omp parallel for schedule(static, 16)
     for (int i = i0; i <= i1; i++) {
-        sigma_delta_compute_row(sd_data, img_in[i], tmp1[i],
-                               sd_data->M[i], sd_data->O[i], sd_data->V[i],
-                               j0, j1, N, sd_data->vmin, sd_data->vmax);
+        sd_kernel(img_in[i], tmp1[i], sd_data->M[i], sd_data->O[i], sd_data->V[i], j0, j1, N, sd_data->vmin,
+                  sd_data->vmax);
     }
 
     // 2. Opening = Erosion then Dilation
@@ -406,116 +766,47 @@ void sigma_delta_morpho_pipelined(sigma_delta_data_t *sd_data,
 // END OF ROW-BLOCK PIPELINING
 // ============================================================================
 
-void sigma_delta_compute(sigma_delta_data_t *sd_data, const uint8_t** img_in, uint8_t** img_out, const int i0,
-                         const int i1, const int j0, const int j1, const uint8_t N) {
-#ifdef MOTION_USE_MIPP
-    // SIMD-optimized version using MIPP with OpenMP parallelization
-    const int vec_size = mipp::N<uint8_t>();
-
-    #pragma omp parallel for schedule(dynamic)
-    for (int i = i0; i <= i1; i++) {
-        // Thread-local SIMD constants
-        const mipp::Reg<uint8_t> one = (uint8_t)1;
-        const mipp::Reg<uint8_t> vmin_reg = sd_data->vmin;
-        const mipp::Reg<uint8_t> vmax_reg = sd_data->vmax;
-        const mipp::Reg<uint8_t> zero_reg = (uint8_t)0;
-        const mipp::Reg<uint8_t> val_255 = (uint8_t)255;
-        int j;
-        // Vectorized loop
-        for (j = j0; j <= j1 - vec_size + 1; j += vec_size) {
-            // Load data
-            mipp::Reg<uint8_t> M_reg = mipp::Reg<uint8_t>(&sd_data->M[i][j]);
-            mipp::Reg<uint8_t> I_reg = mipp::Reg<uint8_t>(&img_in[i][j]);
-            mipp::Reg<uint8_t> V_reg = mipp::Reg<uint8_t>(&sd_data->V[i][j]);
-
-            // Step 1: Mean update - M = M + (M < I) - (M > I)
-            mipp::Msk<mipp::N<uint8_t>()> lt_mask = M_reg < I_reg;
-            mipp::Msk<mipp::N<uint8_t>()> gt_mask = M_reg > I_reg;
-            mipp::Reg<uint8_t> inc = mipp::blend(one, zero_reg, lt_mask);
-            mipp::Reg<uint8_t> dec = mipp::blend(one, zero_reg, gt_mask);
-            M_reg = M_reg + inc - dec;
-            M_reg.store(&sd_data->M[i][j]);
-
-            // Step 2: Difference O = |M - I| using max(M,I) - min(M,I)
-            mipp::Reg<uint8_t> O_reg = mipp::max(M_reg, I_reg) - mipp::min(M_reg, I_reg);
-            O_reg.store(&sd_data->O[i][j]);
-
-            // Step 3: Variance update with saturation
-            // N * O (N=2) - use addition instead of multiplication for N=2
-            mipp::Reg<uint8_t> NO_reg = O_reg + O_reg; // N * O where N = 2
-            mipp::Msk<mipp::N<uint8_t>()> v_lt_mask = V_reg < NO_reg;
-            mipp::Msk<mipp::N<uint8_t>()> v_gt_mask = V_reg > NO_reg;
-            inc = mipp::blend(one, zero_reg, v_lt_mask);
-            dec = mipp::blend(one, zero_reg, v_gt_mask);
-            V_reg = V_reg + inc - dec;
-            // Clamp to [vmin, vmax]
-            V_reg = mipp::max(mipp::min(V_reg, vmax_reg), vmin_reg);
-            V_reg.store(&sd_data->V[i][j]);
-
-            // Step 4: Binary output
-            mipp::Msk<mipp::N<uint8_t>()> motion_mask = O_reg >= V_reg;
-            mipp::Reg<uint8_t> out_reg = mipp::blend(val_255, zero_reg, motion_mask);
-            out_reg.store(&img_out[i][j]);
-        }
-        // Scalar remainder
-        for (; j <= j1; j++) {
-            uint8_t new_m = sd_data->M[i][j];
-            if (sd_data->M[i][j] < img_in[i][j])
-                new_m += 1;
-            else if (sd_data->M[i][j] > img_in[i][j])
-                new_m -= 1;
-            sd_data->M[i][j] = new_m;
-
-            sd_data->O[i][j] = abs(sd_data->M[i][j] - img_in[i][j]);
-
-            uint8_t new_v = sd_data->V[i][j];
-            if (sd_data->V[i][j] < N * sd_data->O[i][j])
-                new_v += 1;
-            else if (sd_data->V[i][j] > N * sd_data->O[i][j])
-                new_v -= 1;
-            sd_data->V[i][j] = MAX(MIN(new_v, sd_data->vmax), sd_data->vmin);
-
-            img_out[i][j] = sd_data->O[i][j] < sd_data->V[i][j] ? 0 : 255;
-        }
-    }
+// Helper: Pack 64 binary pixels (0 or 255) into a word (pixel `p` is the bit `p`)
+static inline uint64_t sigma_delta_pack64(const uint8_t* bin) {
+    uint64_t word = 0;
+#if defined(__SSE2__)
+    // the movemask gathers the MSB of each byte
+    for (int q = 0; q < 4; q++)
+        word |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)&bin[16 * q])) << (16 * q);
 #else
-    // Original scalar implementation with OpenMP parallelization
-    #pragma omp parallel for schedule(dynamic)
-    for (int i = i0; i <= i1; i++) {
-        for (int j = j0; j <= j1; j++) {
-            uint8_t new_m = sd_data->M[i][j];
-            if (sd_data->M[i][j] < img_in[i][j])
-                new_m += 1;
-            else if (sd_data->M[i][j] > img_in[i][j])
-                new_m -= 1;
-            sd_data->M[i][j] = new_m;
-        }
-    }
+    for (int p = 0; p < 64; p++)
+        word |= (uint64_t)(bin[p] >> 7) << p;
+#endif
+    return word;
+}
 
-    #pragma omp parallel for schedule(dynamic)
-    for (int i = i0; i <= i1; i++) {
-        for (int j = j0; j <= j1; j++) {
-            sd_data->O[i][j] = abs(sd_data->M[i][j] - img_in[i][j]);
-        }
-    }
+void sigma_delta_compute_packed(sigma_delta_data_t *sd_data, const uint8_t** img_in, uint64_t** img_out, const int i0,
+                                const int i1, const int j0, const int j1, const uint8_t N) {
+    const sigma_delta_row_kernel_t sd_kernel = sigma_delta_row_kernel(N);
+    const int n_words = PACKED_N_WORDS(j0, j1);
 
-    #pragma omp parallel for schedule(dynamic)
+    #pragma omp parallel for schedule(static)
     for (int i = i0; i <= i1; i++) {
-        for (int j = j0; j <= j1; j++) {
-            uint8_t new_v = sd_data->V[i][j];
-            if (sd_data->V[i][j] < N * sd_data->O[i][j])
-                new_v += 1;
-            else if (sd_data->V[i][j] > N * sd_data->O[i][j])
-                new_v -= 1;
-            sd_data->V[i][j] = MAX(MIN(new_v, sd_data->vmax), sd_data->vmin);
+        // the binary pixels of one word only live in this small buffer (= in the L1 cache)
+        uint8_t bin[64];
+        for (int w = 0; w < n_words; w++) {
+            const int j = j0 + w * 64;
+            const int n = MIN(64, j1 - j + 1);
+            sd_kernel(&img_in[i][j], bin, &sd_data->M[i][j], &sd_data->O[i][j], &sd_data->V[i][j], 0, n - 1, N,
+                      sd_data->vmin, sd_data->vmax);
+            if (n < 64)
+                memset(&bin[n], 0, 64 - n);
+            img_out[i][w] = sigma_delta_pack64(bin);
         }
     }
+}
+
+void sigma_delta_compute(sigma_delta_data_t *sd_data, const uint8_t** img_in, uint8_t** img_out, const int i0,
+                         const int i1, const int j0, const int j1, const uint8_t N) {
+    const sigma_delta_row_kernel_t sd_kernel = sigma_delta_row_kernel(N);
 
     #pragma omp parallel for schedule(dynamic)
-    for (int i = i0; i <= i1; i++) {
-        for (int j = j0; j <= j1; j++) {
-            img_out[i][j] = sd_data->O[i][j] < sd_data->V[i][j] ? 0 : 255;
-        }
-    }
-#endif
+    for (int i = i0; i <= i1; i++)
+        sd_kernel(img_in[i], img_out[i], sd_data->M[i], sd_data->O[i], sd_data->V[i], j0, j1, N, sd_data->vmin,
+                  sd_data->vmax);
 }
@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "motion/sigma_delta/sigma_delta_struct.h"
+
+enum sigma_delta_isa_e sigma_delta_str_to_isa(const char* str) {
+    if (strcmp(str, "AUTO") == 0) {
+        return SD_ISA_AUTO;
+    } else if (strcmp(str, "SCALAR") == 0) {
+        return SD_ISA_SCALAR;
+    } else if (strcmp(str, "MIPP") == 0) {
+        return SD_ISA_MIPP;
+    } else if (strcmp(str, "AVX2") == 0) {
+        return SD_ISA_AVX2;
+    } else if (strcmp(str, "AVX512BW") == 0) {
+        return SD_ISA_AVX512BW;
+    } else {
+        fprintf(stderr, "(EE) '%s()' failed, unknow input ('%s').\n", __func__, str);
+        exit(-1);
+    }
+}
+
+const char* sigma_delta_isa_to_str(const enum sigma_delta_isa_e isa) {
+    switch (isa) {
+        case SD_ISA_AUTO:
+            return "AUTO";
+        case SD_ISA_SCALAR:
+            return "SCALAR";
+        case SD_ISA_MIPP:
+            return "MIPP";
+        case SD_ISA_AVX2:
+            return "AVX2";
+        case SD_ISA_AVX512BW:
+            return "AVX512BW";
+        default:
+            fprintf(stderr, "(EE) '%s()' failed, unknow input ('%d').\n", __func__, (int)isa);
+            exit(-1);
+    }
+}
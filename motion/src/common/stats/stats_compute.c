@@ -0,0 +1,65 @@
+#include <math.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "motion/stats/stats_compute.h"
+
+static inline size_t _stats_bucket_id(const uint64_t ns) {
+    if (ns < STATS_N_SUB)
+        return (size_t)ns;
+    // the highest bit selects the group of sub-buckets, the `STATS_SUB_BITS` next bits select the sub-bucket
+    const int shift = (63 - __builtin_clzll(ns)) - STATS_SUB_BITS;
+    return (size_t)(shift + 1) * STATS_N_SUB + (size_t)((ns >> shift) & (STATS_N_SUB - 1));
+}
+
+static inline uint64_t _stats_bucket_highest(const size_t b) {
+    if (b < STATS_N_SUB)
+        return (uint64_t)b;
+    const int shift = (int)(b / STATS_N_SUB) - 1;
+    const uint64_t lowest = (uint64_t)(STATS_N_SUB + b % STATS_N_SUB) << shift;
+    return lowest + (((uint64_t)1 << shift) - 1);
+}
+
+void stats_hist_add(stats_hist_t* hist, const uint64_t ns) {
+    hist->buckets[_stats_bucket_id(ns)]++;
+    hist->count++;
+    hist->sum_ns += ns;
+    hist->min_ns = MIN(hist->min_ns, ns);
+    hist->max_ns = MAX(hist->max_ns, ns);
+}
+
+void stats_hist_add_perf(stats_hist_t* hist, const uint64_t* start, const uint64_t* stop) {
+    for (int c = 0; c < STATS_N_PERF; c++)
+        hist->perf[c] += stop[c] - start[c];
+}
+
+void stats_perf_read(const stats_perf_t* perf, uint64_t* counters) {
+    for (int c = 0; c < STATS_N_PERF; c++)
+        counters[c] = 0;
+    if (perf == NULL)
+        return;
+#ifdef __linux__
+    // `PERF_FORMAT_GROUP` layout: number of counters followed by their values (in the order of opening)
+    uint64_t values[1 + STATS_N_PERF];
+    if (read(perf->leader, values, sizeof(values)) < (ssize_t)((1 + perf->n_open) * sizeof(uint64_t)))
+        return;
+    for (int c = 0; c < STATS_N_PERF; c++)
+        if (perf->pos[c] != -1)
+            counters[c] = values[1 + perf->pos[c]];
+#endif
+}
+
+uint64_t stats_hist_percentile(const stats_hist_t* hist, const double p) {
+    if (!hist->count)
+        return 0;
+    uint64_t rank = (uint64_t)ceil((p / 100.) * (double)hist->count);
+    rank = CLAMP(rank, (uint64_t)1, hist->count);
+    uint64_t acc = 0;
+    for (size_t b = 0; b < STATS_N_BUCKETS; b++) {
+        acc += hist->buckets[b];
+        if (acc >= rank)
+            return CLAMP(_stats_bucket_highest(b), hist->min_ns, hist->max_ns);
+    }
+    return hist->max_ns;
+}
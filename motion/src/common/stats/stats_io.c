@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "motion/stats/stats_compute.h"
+#include "motion/stats/stats_io.h"
+
+#define NS_TO_MS(ns) ((double)(ns) * 1e-6)
+// the bytes moved from the memory are estimated from the LLC misses: one cache line per miss
+#define CACHE_LINE_BYTES 64
+
+static const char* _stats_perf_names[STATS_N_PERF] = {"cycles", "instructions", "l1d_misses", "llc_misses",
+                                                      "branch_misses"};
+
+static double _stats_mean_ms(const stats_hist_t* hist) {
+    return hist->count ? NS_TO_MS(hist->sum_ns) / (double)hist->count : 0.;
+}
+
+// return 1 if `h` is the first histogram of its thread, the busy time of the thread is then accumulated in `busy_ns`
+static int _stats_thread_busy(const stats_data_t* stats, const size_t h, uint64_t* busy_ns) {
+    for (size_t g = 0; g < h; g++)
+        if (!strcmp(stats->hists[g].thread, stats->hists[h].thread))
+            return 0;
+    *busy_ns = 0;
+    for (size_t g = h; g < stats->n_hists; g++)
+        if (!strcmp(stats->hists[g].thread, stats->hists[h].thread))
+            *busy_ns += stats->hists[g].sum_ns;
+    return 1;
+}
+
+void stats_write_table(FILE* f, const stats_data_t* stats, const double wall_sec) {
+    fprintf(f, "# Latency distributions (in ms): \n");
+    fprintf(f, "# -> %-22s %-10s %8s %8s %8s %8s %8s %8s\n", "Task", "Thread", "Count", "Mean", "p50", "p90", "p99",
+            "Max");
+    for (size_t h = 0; h < stats->n_hists; h++) {
+        const stats_hist_t* hist = &stats->hists[h];
+        fprintf(f, "# -> %-22s %-10s %8lu %8.3f %8.3f %8.3f %8.3f %8.3f\n", hist->task, hist->thread,
+                (unsigned long)hist->count, _stats_mean_ms(hist), NS_TO_MS(stats_hist_percentile(hist, 50.)),
+                NS_TO_MS(stats_hist_percentile(hist, 90.)), NS_TO_MS(stats_hist_percentile(hist, 99.)),
+                NS_TO_MS(hist->max_ns));
+    }
+    fprintf(f, "#\n");
+    fprintf(f, "# Busy time per thread: \n");
+    for (size_t h = 0; h < stats->n_hists; h++) {
+        uint64_t busy_ns;
+        if (_stats_thread_busy(stats, h, &busy_ns))
+            fprintf(f, "# -> %-10s = %10.3f ms (%5.1f%% of the wall time)\n", stats->hists[h].thread,
+                    NS_TO_MS(busy_ns), wall_sec > 0. ? (NS_TO_MS(busy_ns) * 1e-1) / wall_sec : 0.);
+    }
+}
+
+static double _stats_perf_mean(const stats_hist_t* hist, const int c) {
+    return hist->count ? (double)hist->perf[c] / (double)hist->count : 0.;
+}
+
+// print a value in a `width` characters column, or "n/a" if the counter `c` has not been recorded
+static void _stats_perf_print(FILE* f, const stats_data_t* stats, const int c, const int width, const double value) {
+    if (stats->perf_mask & (1u << c))
+        fprintf(f, " %*.3f", width, value);
+    else
+        fprintf(f, " %*s", width, "n/a");
+}
+
+void stats_write_perf_table(FILE* f, const stats_data_t* stats) {
+    if (!stats->perf_mask)
+        return;
+    fprintf(f, "# Hardware counters (average per call): \n");
+    fprintf(f, "# -> %-22s %-10s %10s %10s %10s %10s %10s %10s %10s\n", "Task", "Thread", "kCycles", "IPC",
+            "kL1D-miss", "kLLC-miss", "kBr-miss", "Mem. MB", "Mem. GB/s");
+    const uint32_t ipc_mask = (1u << STATS_PERF_CYCLES) | (1u << STATS_PERF_INSTRUCTIONS);
+    for (size_t h = 0; h < stats->n_hists; h++) {
+        const stats_hist_t* hist = &stats->hists[h];
+        const double cycles = (double)hist->perf[STATS_PERF_CYCLES];
+        const double bytes = (double)hist->perf[STATS_PERF_LLC_MISSES] * CACHE_LINE_BYTES;
+        fprintf(f, "# -> %-22s %-10s", hist->task, hist->thread);
+        _stats_perf_print(f, stats, STATS_PERF_CYCLES, 10, _stats_perf_mean(hist, STATS_PERF_CYCLES) * 1e-3);
+        if ((stats->perf_mask & ipc_mask) == ipc_mask)
+            fprintf(f, " %10.3f", cycles > 0. ? (double)hist->perf[STATS_PERF_INSTRUCTIONS] / cycles : 0.);
+        else
+            fprintf(f, " %10s", "n/a");
+        _stats_perf_print(f, stats, STATS_PERF_L1D_MISSES, 10, _stats_perf_mean(hist, STATS_PERF_L1D_MISSES) * 1e-3);
+        _stats_perf_print(f, stats, STATS_PERF_LLC_MISSES, 10, _stats_perf_mean(hist, STATS_PERF_LLC_MISSES) * 1e-3);
+        _stats_perf_print(f, stats, STATS_PERF_BRANCH_MISSES, 10,
+                          _stats_perf_mean(hist, STATS_PERF_BRANCH_MISSES) * 1e-3);
+        _stats_perf_print(f, stats, STATS_PERF_LLC_MISSES, 10,
+                          hist->count ? bytes / (double)hist->count * 1e-6 : 0.);
+        // bytes per ns = GB/s
+        _stats_perf_print(f, stats, STATS_PERF_LLC_MISSES, 10, hist->sum_ns ? bytes / (double)hist->sum_ns : 0.);
+        fprintf(f, "\n");
+    }
+}
+
+void stats_write_csv(FILE* f, const stats_data_t* stats) {
+    fprintf(f, "Task,Thread,Count,Mean_ms,p50_ms,p90_ms,p99_ms,Max_ms");
+    if (stats->perf_mask)
+        for (int c = 0; c < STATS_N_PERF; c++)
+            fprintf(f, ",%s", _stats_perf_names[c]);
+    fprintf(f, "\n");
+    for (size_t h = 0; h < stats->n_hists; h++) {
+        const stats_hist_t* hist = &stats->hists[h];
+        fprintf(f, "%s,%s,%lu,%.6f,%.6f,%.6f,%.6f,%.6f", hist->task, hist->thread, (unsigned long)hist->count,
+                _stats_mean_ms(hist), NS_TO_MS(stats_hist_percentile(hist, 50.)),
+                NS_TO_MS(stats_hist_percentile(hist, 90.)), NS_TO_MS(stats_hist_percentile(hist, 99.)),
+                NS_TO_MS(hist->max_ns));
+        if (stats->perf_mask)
+            for (int c = 0; c < STATS_N_PERF; c++) {
+                if (stats->perf_mask & (1u << c))
+                    fprintf(f, ",%.1f", _stats_perf_mean(hist, c));
+                else
+                    fprintf(f, ",");
+            }
+        fprintf(f, "\n");
+    }
+}
+
+void stats_write_json(FILE* f, const stats_data_t* stats, const double wall_sec) {
+    fprintf(f, "{\n");
+    fprintf(f, "  \"wall_ms\": %.6f,\n", wall_sec * 1e3);
+    fprintf(f, "  \"tasks\": [");
+    for (size_t h = 0; h < stats->n_hists; h++) {
+        const stats_hist_t* hist = &stats->hists[h];
+        fprintf(f, "%s\n    {\"task\": \"%s\", \"thread\": \"%s\", \"count\": %lu, \"mean_ms\": %.6f, "
+                "\"p50_ms\": %.6f, \"p90_ms\": %.6f, \"p99_ms\": %.6f, \"max_ms\": %.6f", h ? "," : "", hist->task,
+                hist->thread, (unsigned long)hist->count, _stats_mean_ms(hist),
+                NS_TO_MS(stats_hist_percentile(hist, 50.)), NS_TO_MS(stats_hist_percentile(hist, 90.)),
+                NS_TO_MS(stats_hist_percentile(hist, 99.)), NS_TO_MS(hist->max_ns));
+        if (stats->perf_mask) {
+            fprintf(f, ", \"perf\": {");
+            for (int c = 0; c < STATS_N_PERF; c++) {
+                if (stats->perf_mask & (1u << c))
+                    fprintf(f, "%s\"%s\": %.1f", c ? ", " : "", _stats_perf_names[c], _stats_perf_mean(hist, c));
+                else
+                    fprintf(f, "%s\"%s\": null", c ? ", " : "", _stats_perf_names[c]);
+            }
+            fprintf(f, "}");
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ],\n");
+    fprintf(f, "  \"threads\": [");
+    int first = 1;
+    for (size_t h = 0; h < stats->n_hists; h++) {
+        uint64_t busy_ns;
+        if (_stats_thread_busy(stats, h, &busy_ns)) {
+            fprintf(f, "%s\n    {\"thread\": \"%s\", \"busy_ms\": %.6f}", first ? "" : ",", stats->hists[h].thread,
+                    NS_TO_MS(busy_ns));
+            first = 0;
+        }
+    }
+    fprintf(f, "\n  ]\n");
+    fprintf(f, "}\n");
+}
+
+void stats_write_file(const char* path, const stats_data_t* stats, const double wall_sec) {
+    FILE* f = fopen(path, "w");
+    if (f == NULL) {
+        fprintf(stderr, "(EE) error while opening '%s'\n", path);
+        exit(1);
+    }
+    const size_t len = strlen(path);
+    if (len >= 5 && !strcmp(path + len - 5, ".json"))
+        stats_write_json(f, stats, wall_sec);
+    else
+        stats_write_csv(f, stats);
+    fclose(f);
+}
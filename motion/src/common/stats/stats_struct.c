@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "motion/stats/stats_struct.h"
+
+stats_data_t* stats_alloc_data(const size_t max_size) {
+    assert(max_size > 0);
+    stats_data_t* stats = (stats_data_t*)malloc(sizeof(stats_data_t));
+    stats->hists = (stats_hist_t*)malloc(max_size * sizeof(stats_hist_t));
+    for (size_t h = 0; h < max_size; h++)
+        stats->hists[h].buckets = (uint64_t*)malloc(STATS_N_BUCKETS * sizeof(uint64_t));
+    stats->n_hists = 0;
+    stats->_max_size = max_size;
+    stats->perf_mask = 0;
+    return stats;
+}
+
+void stats_init_data(stats_data_t* stats) {
+    stats->n_hists = 0;
+}
+
+stats_hist_t* stats_add_hist(stats_data_t* stats, const char* task, const char* thread) {
+    if (stats->n_hists >= stats->_max_size) {
+        fprintf(stderr, "(EE) Too many tasks in the statistics (max = %lu).\n", (unsigned long)stats->_max_size);
+        exit(1);
+    }
+    stats_hist_t* hist = &stats->hists[stats->n_hists++];
+    hist->task = task;
+    hist->thread = thread;
+    hist->count = 0;
+    hist->sum_ns = 0;
+    hist->min_ns = UINT64_MAX;
+    hist->max_ns = 0;
+    for (size_t b = 0; b < STATS_N_BUCKETS; b++)
+        hist->buckets[b] = 0;
+    for (int c = 0; c < STATS_N_PERF; c++)
+        hist->perf[c] = 0;
+    return hist;
+}
+
+void stats_free_data(stats_data_t* stats) {
+    for (size_t h = 0; h < stats->_max_size; h++)
+        free(stats->hists[h].buckets);
+    free(stats->hists);
+    free(stats);
+}
+
+#ifdef __linux__
+static int _stats_perf_event_open(const uint32_t type, const uint64_t config, const int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = group_fd == -1; // the leader starts the whole group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0 /* calling thread */, -1 /* any CPU */, group_fd, 0);
+}
+#endif
+
+stats_perf_t* stats_perf_alloc(void) {
+#ifdef __linux__
+    const uint32_t types[STATS_N_PERF] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                           PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE };
+    const uint64_t configs[STATS_N_PERF] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+                                             PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    stats_perf_t* perf = (stats_perf_t*)malloc(sizeof(stats_perf_t));
+    perf->n_open = 0;
+    perf->mask = 0;
+    int leader = -1;
+    for (int c = 0; c < STATS_N_PERF; c++) {
+        perf->fds[c] = _stats_perf_event_open(types[c], configs[c], leader);
+        perf->pos[c] = -1;
+        if (perf->fds[c] != -1) {
+            if (leader == -1)
+                leader = perf->fds[c];
+            perf->pos[c] = perf->n_open++;
+            perf->mask |= 1u << c;
+        }
+    }
+    if (leader == -1) {
+        fprintf(stderr, "(WW) The hardware performance counters can't be opened (check "
+                        "'/proc/sys/kernel/perf_event_paranoid'), they will not be recorded.\n");
+        free(perf);
+        return NULL;
+    }
+    if (perf->n_open < STATS_N_PERF)
+        fprintf(stderr, "(WW) Some hardware performance counters are not available on this platform.\n");
+    perf->leader = leader;
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return perf;
+#else
+    fprintf(stderr, "(WW) The hardware performance counters are only supported on Linux, they will not be "
+                    "recorded.\n");
+    return NULL;
+#endif
+}
+
+void stats_perf_free(stats_perf_t* perf) {
+    if (perf == NULL)
+        return;
+#ifdef __linux__
+    // close the members before the leader of the group
+    for (int c = STATS_N_PERF - 1; c >= 0; c--)
+        if (perf->fds[c] != -1)
+            close(perf->fds[c]);
+#endif
+    free(perf);
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "motion/macros.h"
+
+#include "motion/synth/synth_compute.h"
+
+// SplitMix64 pseudo-random generator: fast and identical on all the platforms
+static inline uint64_t _synth_rand(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// position at `frame` of a point that starts at `p0` with the speed `dp` and bounces between `lo` and `hi` (all in
+// fixed-point), the result is rounded to the nearest pixel
+static int _synth_bounce(const int64_t p0, const int64_t dp, const int64_t lo, const int64_t hi, const size_t frame) {
+    const int64_t len = hi - lo;
+    int64_t pos = lo;
+    if (len > 0) {
+        int64_t u = (p0 - lo + dp * (int64_t)frame) % (2 * len);
+        if (u < 0)
+            u += 2 * len;
+        pos = lo + (u <= len ? u : 2 * len - u);
+    }
+    return (int)((pos + (1 << (SYNTH_FP_BITS - 1))) >> SYNTH_FP_BITS);
+}
+
+// largest `w` such that `(w * ry)^2 + (di * rx)^2 <= (rx * ry)^2` (half width of the ellipse row at `di` from center)
+static int _synth_ellipse_half_width(const int rx, const int ry, const int di) {
+    const int64_t rhs = (int64_t)rx * rx * ((int64_t)ry * ry - (int64_t)di * di);
+    if (rhs < 0)
+        return -1;
+    const int64_t ry2 = (int64_t)ry * ry;
+    int64_t w = (int64_t)sqrt((double)rhs / (double)ry2);
+    // the floating-point estimate can be off by one, the result is made exact with integer comparisons
+    while (w > 0 && w * w * ry2 > rhs)
+        w--;
+    while ((w + 1) * (w + 1) * ry2 <= rhs)
+        w++;
+    return (int)w;
+}
+
+synth_data_t* synth_alloc_data(const int i0, const int i1, const int j0, const int j1, const size_t n_objs,
+                               const float obj_size, const float obj_speed, const float noise, const uint64_t seed) {
+    assert(i1 >= i0 && j1 >= j0);
+    synth_data_t* synth_data = (synth_data_t*)malloc(sizeof(synth_data_t));
+    synth_data->i0 = i0;
+    synth_data->i1 = i1;
+    synth_data->j0 = j0;
+    synth_data->j1 = j1;
+    synth_data->n_objs = n_objs;
+    synth_data->obj_size = obj_size;
+    synth_data->obj_speed = obj_speed;
+    synth_data->noise = CLAMP(noise, 0.f, 1.f);
+    synth_data->seed = seed;
+    synth_data->objs = (synth_obj_t*)malloc(MAX(n_objs, (size_t)1) * sizeof(synth_obj_t));
+    return synth_data;
+}
+
+void synth_init_data(synth_data_t* synth_data) {
+    const int width = synth_data->j1 - synth_data->j0 + 1;
+    const int height = synth_data->i1 - synth_data->i0 + 1;
+    const int half = MAX(1, (int)(synth_data->obj_size / 2.f));
+    const int64_t speed = (int64_t)(synth_data->obj_speed * (1 << SYNTH_FP_BITS));
+    uint64_t state = synth_data->seed;
+    for (size_t o = 0; o < synth_data->n_objs; o++) {
+        synth_obj_t* obj = &synth_data->objs[o];
+        // the radii are in [size / 4; 3 * size / 4], the objects always fit in the image
+        obj->rx = MIN(MAX(1, half / 2 + (int)(_synth_rand(&state) % (uint64_t)(half + 1))), (width - 1) / 2);
+        obj->ry = MIN(MAX(1, half / 2 + (int)(_synth_rand(&state) % (uint64_t)(half + 1))), (height - 1) / 2);
+        const int64_t x_len = (int64_t)(width - 1 - 2 * obj->rx) << SYNTH_FP_BITS;
+        const int64_t y_len = (int64_t)(height - 1 - 2 * obj->ry) << SYNTH_FP_BITS;
+        obj->x = ((int64_t)obj->rx << SYNTH_FP_BITS) + (int64_t)(_synth_rand(&state) % (uint64_t)(x_len + 1));
+        obj->y = ((int64_t)obj->ry << SYNTH_FP_BITS) + (int64_t)(_synth_rand(&state) % (uint64_t)(y_len + 1));
+        obj->dx = (int64_t)(_synth_rand(&state) % (uint64_t)(2 * speed + 1)) - speed;
+        obj->dy = (int64_t)(_synth_rand(&state) % (uint64_t)(2 * speed + 1)) - speed;
+        obj->value = (uint8_t)(160 + _synth_rand(&state) % 96);
+    }
+}
+
+void synth_free_data(synth_data_t* synth_data) {
+    free(synth_data->objs);
+    free(synth_data);
+}
+
+// draw the objects at their position in `frame`, `value` = 0 means that each object is drawn with its own value
+static void _synth_draw_objs(const synth_data_t* synth_data, const size_t frame, uint8_t** img, const uint8_t value) {
+    const int width = synth_data->j1 - synth_data->j0 + 1;
+    const int height = synth_data->i1 - synth_data->i0 + 1;
+    for (size_t o = 0; o < synth_data->n_objs; o++) {
+        const synth_obj_t* obj = &synth_data->objs[o];
+        const int cx = _synth_bounce(obj->x, obj->dx, (int64_t)obj->rx << SYNTH_FP_BITS,
+                                     (int64_t)(width - 1 - obj->rx) << SYNTH_FP_BITS, frame);
+        const int cy = _synth_bounce(obj->y, obj->dy, (int64_t)obj->ry << SYNTH_FP_BITS,
+                                     (int64_t)(height - 1 - obj->ry) << SYNTH_FP_BITS, frame);
+        const uint8_t v = value ? value : obj->value;
+        for (int di = -obj->ry; di <= obj->ry; di++) {
+            const int i = cy + di;
+            const int hw = _synth_ellipse_half_width(obj->rx, obj->ry, di);
+            if (i < 0 || i >= height || hw < 0)
+                continue;
+            const int jb = MAX(cx - hw, 0), je = MIN(cx + hw, width - 1);
+            if (jb <= je)
+                memset(&img[synth_data->i0 + i][synth_data->j0 + jb], v, (size_t)(je - jb + 1));
+        }
+    }
+}
+
+// replace the ratio `noise` of the pixels by a random value (`value` = 0) or by `value`
+static void _synth_draw_noise(const synth_data_t* synth_data, const size_t frame, uint8_t** img, const uint8_t value) {
+    const uint64_t width = (uint64_t)(synth_data->j1 - synth_data->j0 + 1);
+    const uint64_t n_pixels = width * (uint64_t)(synth_data->i1 - synth_data->i0 + 1);
+    const uint64_t n_noise = (uint64_t)((double)synth_data->noise * (double)n_pixels);
+    // the generator is re-seeded for each frame: the noise of a frame does not depend on the previous frames
+    uint64_t state = synth_data->seed ^ ((uint64_t)(frame + 1) * 0xD1B54A32D192ED03ull);
+    for (uint64_t n = 0; n < n_noise; n++) {
+        const uint64_t r = _synth_rand(&state);
+        const uint64_t p = (r >> 8) % n_pixels;
+        img[synth_data->i0 + (int)(p / width)][synth_data->j0 + (int)(p % width)] = value ? value : (uint8_t)r;
+    }
+}
+
+void synth_render_gray(const synth_data_t* synth_data, const size_t frame, uint8_t** img) {
+    const int height = synth_data->i1 - synth_data->i0 + 1;
+    // static background: vertical gradient in [32;128[
+    for (int i = synth_data->i0; i <= synth_data->i1; i++)
+        memset(&img[i][synth_data->j0], 32 + (96 * (i - synth_data->i0)) / height,
+               (size_t)(synth_data->j1 - synth_data->j0 + 1));
+    _synth_draw_objs(synth_data, frame, img, 0);
+    _synth_draw_noise(synth_data, frame, img, 0);
+}
+
+void synth_render_binary(const synth_data_t* synth_data, const size_t frame, uint8_t** img) {
+    for (int i = synth_data->i0; i <= synth_data->i1; i++)
+        memset(&img[i][synth_data->j0], 0, (size_t)(synth_data->j1 - synth_data->j0 + 1));
+    _synth_draw_objs(synth_data, frame, img, 255);
+    _synth_draw_noise(synth_data, frame, img, 255);
+}
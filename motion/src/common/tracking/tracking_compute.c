@@ -9,24 +9,19 @@
 #include "motion/macros.h"
 #include "vec.h"
 
+#include "motion/features/features_compute.h"
+#include "motion/tracking/tracking_io.h"
 #include "motion/tracking/tracking_compute.h"
 
 History_t* alloc_history(const size_t max_history_size, const size_t max_RoIs_size) {
     History_t* history = (History_t*)malloc(sizeof(History_t));
     history->_max_size = max_history_size;
-    history->RoIs = (RoI4track_t**)malloc(history->_max_size * sizeof(RoI4track_t*));
-    history->n_RoIs = (uint32_t*)malloc(history->_max_size * sizeof(uint32_t));
+    // the slots are allocated on first use (see `_history_push`)
+    history->RoIs = (RoI4track_t**)calloc(history->_max_size, sizeof(RoI4track_t*));
+    history->n_RoIs = (uint32_t*)calloc(history->_max_size, sizeof(uint32_t));
     history->_max_n_RoIs = max_RoIs_size;
+    history->_head = 0;
     history->_size = 0;
-    for (size_t i = 0; i < history->_max_size; i++) {
-        history->RoIs[i] = (RoI4track_t*)malloc(max_RoIs_size * sizeof(RoI4track_t));
-        history->n_RoIs[i] = 0;
-        for (size_t j = 0; j < max_RoIs_size; j++) {
-            memset(&history->RoIs[i][j], 0, sizeof(RoI4track_t));
-            history->RoIs[i][j].r.x = NAN;
-            history->RoIs[i][j].r.y = NAN;
-        }
-    }
     return history;
 }
 
@@ -38,33 +33,69 @@ void free_history(History_t* history) {
     free(history);
 }
 
-void rotate_history(History_t* history) {
-    RoI4track_t* last_RoIs_tmp = history->RoIs[history->_max_size -1];
-    uint32_t last_n_RoIs_tmp = history->n_RoIs[history->_max_size -1];
-    for (int i = (int)(history->_max_size -2); i >= 0; i--) {
-        history->RoIs[i + 1] = history->RoIs[i];
-        history->n_RoIs[i + 1] = history->n_RoIs[i];
-    }
-    history->RoIs[0] = last_RoIs_tmp;
-    history->n_RoIs[0] = last_n_RoIs_tmp;
+static inline size_t _history_slot(const History_t* history, const size_t age) {
+    const size_t slot = history->_head + age;
+    return slot < history->_max_size ? slot : slot - history->_max_size;
+}
+
+static inline RoI4track_t* _history_RoIs(const History_t* history, const size_t age) {
+    return history->RoIs[_history_slot(history, age)];
+}
+
+static inline uint32_t _history_n_RoIs(const History_t* history, const size_t age) {
+    return history->n_RoIs[_history_slot(history, age)];
+}
+
+// Make room for a new frame: the oldest slot is recycled and becomes the age 0 slot (its content is overwritten)
+static void _history_push(History_t* history, const uint32_t n_RoIs) {
+    assert(n_RoIs <= history->_max_n_RoIs);
+    history->_head = history->_head ? history->_head - 1 : history->_max_size - 1;
+    if (history->RoIs[history->_head] == NULL)
+        history->RoIs[history->_head] = (RoI4track_t*)malloc(history->_max_n_RoIs * sizeof(RoI4track_t));
+    history->n_RoIs[history->_head] = n_RoIs;
+}
+
+static void _tails_alloc(tails_set_t* set, const size_t max_size) {
+    set->keys = (track_tail_t*)calloc(max_size, sizeof(track_tail_t));
+    set->size = 0;
+    set->_max_size = max_size;
 }
 
 tracking_data_t* tracking_alloc_data(const size_t max_history_size, const size_t max_RoIs_size) {
     tracking_data_t* tracking_data = (tracking_data_t*)malloc(sizeof(tracking_data_t));
     tracking_data->tracks = (vec_track_t)vector_create();
+    tracking_data->active = (vec_uint32_t)vector_create();
+    tracking_data->last_id = 0;
+    tracking_data->n_flushed = 0;
+    _tails_alloc(&tracking_data->tails, 64);
+    _tails_alloc(&tracking_data->finished_tails, 64);
     tracking_data->history = alloc_history(max_history_size, max_RoIs_size);
+    tracking_data->grid_cell_size = 1.f;
+    tracking_data->grid_n_cols = 0;
+    tracking_data->grid_n_rows = 0;
+    tracking_data->_max_cells = 0;
+    tracking_data->grid_offset = NULL;
+    tracking_data->grid_id = (uint32_t*)malloc(max_RoIs_size * sizeof(uint32_t));
     tracking_data->RoIs_list = (RoI4track_t*)malloc(max_history_size * sizeof(RoI4track_t));
     return tracking_data;
 }
 
 void tracking_init_data(tracking_data_t* tracking_data) {
     memset(tracking_data->RoIs_list, 0, tracking_data->history->_max_size * sizeof(RoI4track_t));
-    for (size_t i = 0; i < tracking_data->history->_max_size; i++) {
-        memset(tracking_data->history->RoIs[i], 0, tracking_data->history->_max_n_RoIs *
-               sizeof(RoI4track_t));
-        tracking_data->history->n_RoIs[i] = 0;
+    History_t* history = tracking_data->history;
+    for (size_t i = 0; i < history->_max_size; i++) {
+        if (history->RoIs[i] != NULL)
+            memset(history->RoIs[i], 0, history->n_RoIs[i] * sizeof(RoI4track_t));
+        history->n_RoIs[i] = 0;
     }
-    tracking_data->history->_size = 0;
+    history->_head = 0;
+    history->_size = 0;
+    tracking_data->last_id = 0;
+    tracking_data->n_flushed = 0;
+    memset(tracking_data->tails.keys, 0, tracking_data->tails._max_size * sizeof(track_tail_t));
+    tracking_data->tails.size = 0;
+    memset(tracking_data->finished_tails.keys, 0, tracking_data->finished_tails._max_size * sizeof(track_tail_t));
+    tracking_data->finished_tails.size = 0;
 }
 
 void tracking_free_data(tracking_data_t* tracking_data) {
@@ -73,39 +104,185 @@ void tracking_free_data(tracking_data_t* tracking_data) {
         if (tracking_data->tracks[t].RoIs_id != NULL)
             vector_free(tracking_data->tracks[t].RoIs_id);
     vector_free(tracking_data->tracks);
+    vector_free(tracking_data->active);
+    free(tracking_data->tails.keys);
+    free(tracking_data->finished_tails.keys);
     free_history(tracking_data->history);
+    free(tracking_data->grid_offset);
+    free(tracking_data->grid_id);
     free(tracking_data->RoIs_list);
     free(tracking_data);
 }
 
-// Returns 0 if no RoI matches or returns the RoI id found (RoI id >= 1)
-size_t _find_matching_RoI(const History_t* history, const track_t* cur_track, const size_t r_extrapol,
+static inline size_t _tails_bucket(const track_tail_t* tail, const size_t max_size) {
+    uint32_t x_bits, y_bits;
+    memcpy(&x_bits, &tail->x, sizeof(uint32_t));
+    memcpy(&y_bits, &tail->y, sizeof(uint32_t));
+    const uint64_t key = ((uint64_t)x_bits << 32 | y_bits) ^ (uint64_t)tail->id * 0x9E3779B97F4A7C15ull;
+    // Fibonacci hashing
+    return (size_t)((key * 11400714819323198485ull) >> 32) & (max_size - 1);
+}
+
+static inline void _tails_from_RoI(const RoI4track_t* RoI, track_tail_t* tail) {
+    tail->id = RoI->r.id;
+    tail->x = RoI->r.x;
+    tail->y = RoI->r.y;
+    tail->frame = RoI->frame;
+}
+
+static inline uint8_t _tails_equal(const track_tail_t* a, const track_tail_t* b) {
+    return a->id == b->id && a->x == b->x && a->y == b->y;
+}
+
+// the tails of the tracks finished during the `_max_size` previous frames are kept in `finished_tails`
+static inline uint32_t _tails_min_frame(const History_t* history, const size_t frame) {
+    return frame > history->_max_size ? (uint32_t)(frame - history->_max_size) : 0;
+}
+
+// the tails stamped before `min_frame` are ignored (they are removed the next time the set is resized)
+static uint8_t _tails_contains(const tails_set_t* set, const track_tail_t* tail, const uint32_t min_frame) {
+    size_t b = _tails_bucket(tail, set->_max_size);
+    while (set->keys[b].id) {
+        if (set->keys[b].frame >= min_frame && _tails_equal(&set->keys[b], tail))
+            return 1;
+        b = (b + 1) & (set->_max_size - 1);
+    }
+    return 0;
+}
+
+static void _tails_insert(tails_set_t* set, const track_tail_t* tail, const uint32_t min_frame) {
+    // keep the load factor below 1/2: first drop the tails stamped before `min_frame`, then grow the set if the
+    // remaining tails still fill more than 1/4 of the buckets
+    if (2 * (set->size + 1) > set->_max_size) {
+        size_t n_kept = 0;
+        for (size_t b = 0; b < set->_max_size; b++)
+            if (set->keys[b].id && set->keys[b].frame >= min_frame)
+                n_kept++;
+        const size_t old_max_size = set->_max_size;
+        track_tail_t* old_keys = set->keys;
+        _tails_alloc(set, 4 * (n_kept + 1) > old_max_size ? 2 * old_max_size : old_max_size);
+        for (size_t b = 0; b < old_max_size; b++)
+            if (old_keys[b].id && old_keys[b].frame >= min_frame)
+                _tails_insert(set, &old_keys[b], min_frame);
+        free(old_keys);
+    }
+    size_t b = _tails_bucket(tail, set->_max_size);
+    while (set->keys[b].id) {
+        if (_tails_equal(&set->keys[b], tail)) {
+            if (set->keys[b].frame < tail->frame)
+                set->keys[b].frame = tail->frame;
+            return;
+        }
+        b = (b + 1) & (set->_max_size - 1);
+    }
+    set->keys[b] = *tail;
+    set->size++;
+}
+
+static void _RoIs_grid_build(tracking_data_t* tracking_data, const size_t r_extrapol) {
+    const History_t* history = tracking_data->history;
+    const RoI4track_t* RoIs = _history_RoIs(history, 0);
+    const size_t n_RoIs = _history_n_RoIs(history, 0);
+
+    float x_max = 0.f, y_max = 0.f;
+    for (size_t j = 0; j < n_RoIs; j++) {
+        x_max = MAX(x_max, RoIs[j].r.x);
+        y_max = MAX(y_max, RoIs[j].r.y);
+    }
+
+    // the cells are enlarged (this is always correct) to keep the number of cells proportional to the number of RoIs
+    float cell_size = (float)r_extrapol + 1.f;
+    size_t n_cols, n_rows;
+    for (;;) {
+        n_cols = (size_t)(x_max / cell_size) + 1;
+        n_rows = (size_t)(y_max / cell_size) + 1;
+        if (n_cols * n_rows <= 4 * n_RoIs + 16)
+            break;
+        cell_size *= 2.f;
+    }
+    const size_t n_cells = n_cols * n_rows;
+    if (n_cells + 1 > tracking_data->_max_cells) {
+        tracking_data->_max_cells = MAX(2 * tracking_data->_max_cells, n_cells + 1);
+        free(tracking_data->grid_offset);
+        tracking_data->grid_offset = (uint32_t*)malloc(tracking_data->_max_cells * sizeof(uint32_t));
+    }
+    tracking_data->grid_cell_size = cell_size;
+    tracking_data->grid_n_cols = (uint32_t)n_cols;
+    tracking_data->grid_n_rows = (uint32_t)n_rows;
+
+    // counting sort of the RoIs by cell (the RoIs of a cell remain sorted by position)
+    uint32_t* offset = tracking_data->grid_offset;
+    memset(offset, 0, (n_cells + 1) * sizeof(uint32_t));
+    for (size_t j = 0; j < n_RoIs; j++) {
+        const size_t c = (size_t)(RoIs[j].r.y / cell_size) * n_cols + (size_t)(RoIs[j].r.x / cell_size);
+        offset[c + 1]++;
+    }
+    for (size_t c = 0; c < n_cells; c++)
+        offset[c + 1] += offset[c];
+    for (size_t j = 0; j < n_RoIs; j++) {
+        const size_t c = (size_t)(RoIs[j].r.y / cell_size) * n_cols + (size_t)(RoIs[j].r.x / cell_size);
+        tracking_data->grid_id[offset[c]++] = (uint32_t)j;
+    }
+    for (size_t c = n_cells; c > 0; c--)
+        offset[c] = offset[c - 1];
+    offset[0] = 0;
+}
+
+// Returns 0 if no RoI matches or returns the id of the closest RoI found (RoI id >= 1)
+size_t _find_matching_RoI(const tracking_data_t* tracking_data, const track_t* cur_track, const size_t r_extrapol,
                           const float min_extrapol_ratio_S) {
-    for (size_t j = 0; j < history->n_RoIs[0]; j++) {
-        if (!history->RoIs[0][j].r.prev_id && !history->RoIs[0][j].is_extrapolated) {
-            float x0_0 = history->RoIs[0][j].r.x;
-            float y0_0 = history->RoIs[0][j].r.y;
-
-            // motion compensation from t - 1 to t
-            float x1_0 = cur_track->extrapol_x1;
-            float y1_0 = cur_track->extrapol_y1;
-
-            float x_diff = x0_0 - (x1_0 + cur_track->extrapol_dx);
-            float y_diff = y0_0 - (y1_0 + cur_track->extrapol_dy);
-            float dist = sqrtf(x_diff * x_diff + y_diff * y_diff);
-
-            float ratio_S_ij = cur_track->end.r.S < history->RoIs[0][j].r.S ?
-                               (float)cur_track->end.r.S / (float)history->RoIs[0][j].r.S :
-                               (float)history->RoIs[0][j].r.S / (float)cur_track->end.r.S;
-
-            if (dist < r_extrapol && ratio_S_ij >= min_extrapol_ratio_S) {
-                // in the current implementation, the first RoI that matches is used for extrapolation
-                // TODO: this behavior is dangerous, we should associate the closest RoI
-                return j + 1;
+    const RoI4track_t* RoIs_t0 = _history_RoIs(tracking_data->history, 0);
+
+    // motion compensation from t - 1 to t
+    float x1_0 = cur_track->extrapol_x1;
+    float y1_0 = cur_track->extrapol_y1;
+
+    const float x = x1_0 + cur_track->extrapol_dx;
+    const float y = y1_0 + cur_track->extrapol_dy;
+    if (isnan(x) || isnan(y))
+        return 0;
+
+    // only the 3x3 cells around the extrapolated position can contain RoIs closer than `r_extrapol`
+    const float cell_size = tracking_data->grid_cell_size;
+    const float fx = x / cell_size, fy = y / cell_size;
+    if (fx < -1.f || fy < -1.f || fx >= (float)tracking_data->grid_n_cols + 1.f ||
+        fy >= (float)tracking_data->grid_n_rows + 1.f)
+        return 0;
+    const int cx = (int)floorf(fx), cy = (int)floorf(fy);
+    const int c0 = MAX(cx - 1, 0), c1 = MIN(cx + 1, (int)tracking_data->grid_n_cols - 1);
+    const int r0 = MAX(cy - 1, 0), r1 = MIN(cy + 1, (int)tracking_data->grid_n_rows - 1);
+
+    const float r2_extrapol = (float)r_extrapol * (float)r_extrapol;
+    float best_dist2 = 0.f;
+    size_t best_id = 0;
+    for (int r = r0; r <= r1; r++) {
+        for (int c = c0; c <= c1; c++) {
+            const size_t cell = (size_t)r * tracking_data->grid_n_cols + (size_t)c;
+            for (uint32_t p = tracking_data->grid_offset[cell]; p < tracking_data->grid_offset[cell + 1]; p++) {
+                const uint32_t j = tracking_data->grid_id[p];
+                if (RoIs_t0[j].r.prev_id || RoIs_t0[j].is_extrapolated)
+                    continue;
+
+                float x_diff = RoIs_t0[j].r.x - x;
+                float y_diff = RoIs_t0[j].r.y - y;
+                float dist2 = x_diff * x_diff + y_diff * y_diff;
+                if (dist2 >= r2_extrapol)
+                    continue;
+                // in case of equality, the RoI with the smallest id is kept
+                if (best_id && (dist2 > best_dist2 || (dist2 == best_dist2 && j + 1 > best_id)))
+                    continue;
+
+                float ratio_S_ij = cur_track->end.r.S < RoIs_t0[j].r.S ?
+                                   (float)cur_track->end.r.S / (float)RoIs_t0[j].r.S :
+                                   (float)RoIs_t0[j].r.S / (float)cur_track->end.r.S;
+                if (ratio_S_ij >= min_extrapol_ratio_S) {
+                    best_dist2 = dist2;
+                    best_id = j + 1;
+                }
             }
         }
     }
-    return 0;
+    return best_id;
 }
 
 void _track_extrapolate(const History_t* history, track_t* cur_track) {
@@ -145,45 +322,52 @@ void _update_extrapol_vars(const History_t* history, track_t* cur_track) {
     cur_track->extrapol_y1 = cur_track->end.r.y;
 }
 
-void _update_existing_tracks(History_t* history, vec_track_t track_array, const size_t frame, const size_t r_extrapol,
+void _update_existing_tracks(tracking_data_t* tracking_data, const size_t frame, const size_t r_extrapol,
                              const uint8_t extrapol_order_max, const float min_extrapol_ratio_S) {
-    size_t n_tracks = vector_size(track_array);
-    for (size_t i = 0; i < n_tracks; i++) {
-        track_t* cur_track = &track_array[i];
+    History_t* history = tracking_data->history;
+    RoI4track_t* RoIs_t0 = _history_RoIs(history, 0);
+    const RoI4track_t* RoIs_t1 = _history_RoIs(history, 1);
+    vec_track_t track_array = tracking_data->tracks;
+    vec_uint32_t active = tracking_data->active;
+    // only the tracks that are not finished are visited
+    size_t n_active = vector_size(active);
+    size_t n_kept = 0;
+    for (size_t a = 0; a < n_active; a++) {
+        track_t* cur_track = &track_array[active[a]];
         if (cur_track->id && cur_track->state != STATE_FINISHED) {
             if (cur_track->state == STATE_LOST) {
-                size_t RoI_id = _find_matching_RoI(history, cur_track, r_extrapol, min_extrapol_ratio_S);
+                size_t RoI_id = _find_matching_RoI(tracking_data, cur_track, r_extrapol, min_extrapol_ratio_S);
                 if (RoI_id) {
                     cur_track->state = STATE_UPDATED;
-                    history->RoIs[0][RoI_id - 1].is_extrapolated = 1;
-                    memcpy(&cur_track->end, &history->RoIs[0][RoI_id - 1], sizeof(RoI4track_t));
+                    RoIs_t0[RoI_id - 1].is_extrapolated = 1;
+                    memcpy(&cur_track->end, &RoIs_t0[RoI_id - 1], sizeof(RoI4track_t));
                     _update_extrapol_vars(history, cur_track);
 
                     if (cur_track->RoIs_id != NULL) {
                         // no RoI id when the RoI has been extrapolated
                         for (uint8_t e = cur_track->extrapol_order; e >= 1; e--)
                             vector_add(&cur_track->RoIs_id, (uint32_t)0);
-                        vector_add(&cur_track->RoIs_id, history->RoIs[0][RoI_id - 1].r.id);
+                        vector_add(&cur_track->RoIs_id, RoIs_t0[RoI_id - 1].r.id);
                     }
                     cur_track->extrapol_order = 0;
                 }
             }
             else if (cur_track->state == STATE_UPDATED) {
-                int next_id = history->RoIs[1][cur_track->end.r.id - 1].r.next_id;
+                int next_id = RoIs_t1[cur_track->end.r.id - 1].r.next_id;
                 if (next_id) {
-                    memcpy(&cur_track->end, &history->RoIs[0][next_id - 1], sizeof(RoI4track_t));
+                    memcpy(&cur_track->end, &RoIs_t0[next_id - 1], sizeof(RoI4track_t));
                     _update_extrapol_vars(history, cur_track);
                     if (cur_track->RoIs_id != NULL)
-                        vector_add(&cur_track->RoIs_id, history->RoIs[0][next_id - 1].r.id);
+                        vector_add(&cur_track->RoIs_id, RoIs_t0[next_id - 1].r.id);
                 } else {
-                    size_t RoI_id = _find_matching_RoI(history, cur_track, r_extrapol, min_extrapol_ratio_S);
+                    size_t RoI_id = _find_matching_RoI(tracking_data, cur_track, r_extrapol, min_extrapol_ratio_S);
                     if (RoI_id) {
-                        history->RoIs[0][RoI_id - 1].is_extrapolated = 1;
-                        memcpy(&cur_track->end, &history->RoIs[0][RoI_id - 1], sizeof(RoI4track_t));
+                        RoIs_t0[RoI_id - 1].is_extrapolated = 1;
+                        memcpy(&cur_track->end, &RoIs_t0[RoI_id - 1], sizeof(RoI4track_t));
                         _update_extrapol_vars(history, cur_track);
 
                         if (cur_track->RoIs_id != NULL)
-                            vector_add(&cur_track->RoIs_id, history->RoIs[0][RoI_id - 1].r.id);
+                            vector_add(&cur_track->RoIs_id, RoIs_t0[RoI_id - 1].r.id);
                     } else {
                         cur_track->state = STATE_LOST;
                     }
@@ -199,14 +383,25 @@ void _update_existing_tracks(History_t* history, vec_track_t track_array, const
                 }
             }
         }
+        if (cur_track->state != STATE_FINISHED) {
+            active[n_kept++] = active[a];
+        } else {
+            // the tail of a finished track is stamped with the current frame (see `finished_tails`)
+            track_tail_t tail;
+            _tails_from_RoI(&cur_track->end, &tail);
+            tail.frame = frame;
+            _tails_insert(&tracking_data->finished_tails, &tail, _tails_min_frame(history, frame));
+        }
     }
+    for (size_t a = n_kept; a < n_active; a++)
+        vector_pop(active);
 }
 
-void _insert_new_track(const RoI4track_t* RoIs_list, const unsigned n_RoIs, vec_track_t* track_array, const int frame,
-                       const uint8_t save_RoIs_id) {
+void _insert_new_track(const RoI4track_t* RoIs_list, const unsigned n_RoIs, vec_track_t* track_array,
+                       vec_uint32_t* active, const uint32_t track_id, const int frame, const uint8_t save_RoIs_id) {
     assert(n_RoIs >= 1);
 
-    size_t track_id = vector_size(*track_array) + 1;
+    vector_add(active, (uint32_t)vector_size(*track_array));
     track_t* tmp_track = vector_add_asg(track_array);
     tmp_track->id = track_id;
     memcpy(&tmp_track->begin, &RoIs_list[n_RoIs - 1], sizeof(RoI4track_t));
@@ -228,43 +423,46 @@ void _insert_new_track(const RoI4track_t* RoIs_list, const unsigned n_RoIs, vec_
     tmp_track = NULL; // stop using temp now that the element is initialized
 }
 
-void _create_new_tracks(History_t* history, RoI4track_t* RoIs_list, vec_track_t* track_array, const size_t frame,
-                        const size_t fra_obj_min, const uint8_t save_RoIs_id) {
-    for (size_t i = 0; i < history->n_RoIs[1]; i++) {
-        int asso = history->RoIs[1][i].r.next_id;
+void _create_new_tracks(tracking_data_t* tracking_data, const size_t frame, const size_t fra_obj_min,
+                        const uint8_t save_RoIs_id) {
+    const History_t* history = tracking_data->history;
+    RoI4track_t* RoIs_t0 = _history_RoIs(history, 0);
+    const RoI4track_t* RoIs_t1 = _history_RoIs(history, 1);
+    const uint32_t n_RoIs_t1 = _history_n_RoIs(history, 1);
+    for (size_t i = 0; i < n_RoIs_t1; i++) {
+        int asso = RoIs_t1[i].r.next_id;
         if (asso) {
-            if (history->RoIs[1][i].is_extrapolated)
+            if (RoIs_t1[i].is_extrapolated)
                 continue; // Extrapolated
-            int time = history->RoIs[1][i].time_motion + 1;
-            history->RoIs[0][asso - 1].time_motion = time;
+            int time = RoIs_t1[i].time_motion + 1;
+            RoIs_t0[asso - 1].time_motion = time;
             int fra_min = fra_obj_min;
             if (time == fra_min - 1) {
-                // this loop prevent adding duplicated tracks
-                size_t n_tracks = vector_size(*track_array);
-                size_t j = 0;
-                while (j < n_tracks && ((*track_array)[j].end.r.id != history->RoIs[1][i].r.id ||
-                       (*track_array)[j].end.r.x != history->RoIs[1][i].r.x ||
-                       (*track_array)[j].end.r.y != history->RoIs[1][i].r.y))
-                    j++;
-
-                if (j == n_tracks || n_tracks == 0) {
-                    memcpy(&RoIs_list[0], &history->RoIs[1][i], sizeof(RoI4track_t));
+                // prevent adding duplicated tracks: is there already a track (finished or not) with the same tail?
+                track_tail_t tail;
+                _tails_from_RoI(&RoIs_t1[i], &tail);
+                if (!_tails_contains(&tracking_data->tails, &tail, 0) &&
+                    !_tails_contains(&tracking_data->finished_tails, &tail, _tails_min_frame(history, frame))) {
+                    RoI4track_t* RoIs_list = tracking_data->RoIs_list;
+                    memcpy(&RoIs_list[0], &RoIs_t1[i], sizeof(RoI4track_t));
 
                     const size_t n_RoIs = fra_min - 1;
                     for (size_t ii = 1; ii < n_RoIs; ii++)
-                        memcpy(&RoIs_list[ii], &history->RoIs[ii + 1][RoIs_list[ii - 1].r.prev_id - 1],
+                        memcpy(&RoIs_list[ii], &_history_RoIs(history, ii + 1)[RoIs_list[ii - 1].r.prev_id - 1],
                                sizeof(RoI4track_t));
 
-                     _insert_new_track(RoIs_list, fra_min - 1, track_array, frame, save_RoIs_id);
+                    _insert_new_track(RoIs_list, fra_min - 1, &tracking_data->tracks, &tracking_data->active,
+                                      ++tracking_data->last_id, frame, save_RoIs_id);
+                    _tails_insert(&tracking_data->tails, &tail, 0);
                 }
             }
         }
     }
 }
 
-void _light_copy_RoIs(const RoI_t* RoIs_src, const size_t n_RoIs_src, RoI4track_t* RoIs_dst, const uint32_t frame) {
+void _light_copy_RoIs(const RoIs_t* RoIs_src, const size_t n_RoIs_src, RoI4track_t* RoIs_dst, const uint32_t frame) {
     for (size_t i = 0; i < n_RoIs_src; i++) {
-        RoIs_dst[i].r = RoIs_src[i];
+        RoIs_dst[i].r = features_get_RoI(RoIs_src, i);
         RoIs_dst[i].r.next_id = 0;
         RoIs_dst[i].frame = frame;
         RoIs_dst[i].time_motion = 0;
@@ -272,34 +470,73 @@ void _light_copy_RoIs(const RoI_t* RoIs_src, const size_t n_RoIs_src, RoI4track_
     }
 }
 
-void _update_RoIs_next_id(const RoI_t* RoIs, RoI4track_t* RoIs_dst, const size_t n_RoIs) {
+void _update_RoIs_next_id(const RoIs_t* RoIs, RoI4track_t* RoIs_dst, const size_t n_RoIs) {
     for (size_t i = 0; i < n_RoIs; i++)
-        if (RoIs[i].prev_id)
-            RoIs_dst[RoIs[i].prev_id - 1].r.next_id = i + 1;
+        if (RoIs->prev_id[i])
+            RoIs_dst[RoIs->prev_id[i] - 1].r.next_id = i + 1;
 }
 
-void tracking_perform(tracking_data_t* tracking_data, const RoI_t* RoIs, const size_t n_RoIs, const size_t frame,
+void tracking_perform(tracking_data_t* tracking_data, const RoIs_t* RoIs, const size_t n_RoIs, const size_t frame,
                       const size_t r_extrapol, const size_t fra_obj_min, const uint8_t save_RoIs_id,
                       const uint8_t extrapol_order_max, const float min_extrapol_ratio_S) {
     assert(extrapol_order_max < tracking_data->history->_max_size);
     assert(min_extrapol_ratio_S >= 0.f && min_extrapol_ratio_S <= 1.f);
 
-    tracking_data->history->n_RoIs[0] = n_RoIs;
-    _light_copy_RoIs(RoIs, n_RoIs, tracking_data->history->RoIs[0], frame);
+    _history_push(tracking_data->history, n_RoIs);
+    _light_copy_RoIs(RoIs, n_RoIs, _history_RoIs(tracking_data->history, 0), frame);
 
     if (tracking_data->history->_size > 0)
-        _update_RoIs_next_id(RoIs, tracking_data->history->RoIs[1], n_RoIs);
+        _update_RoIs_next_id(RoIs, _history_RoIs(tracking_data->history, 1), n_RoIs);
     if (tracking_data->history->_size < tracking_data->history->_max_size)
         tracking_data->history->_size++;
 
     if (tracking_data->history->_size >= 2) {
-        _create_new_tracks(tracking_data->history, tracking_data->RoIs_list, &tracking_data->tracks, frame,
-                           fra_obj_min, save_RoIs_id);
-        _update_existing_tracks(tracking_data->history, tracking_data->tracks, frame, r_extrapol,
-                                extrapol_order_max, min_extrapol_ratio_S);
+        _create_new_tracks(tracking_data, frame, fra_obj_min, save_RoIs_id);
+        if (vector_size(tracking_data->active))
+            _RoIs_grid_build(tracking_data, r_extrapol);
+        _update_existing_tracks(tracking_data, frame, r_extrapol, extrapol_order_max, min_extrapol_ratio_S);
+    }
+
+    // the tails of the tracks that are not finished (the tails of the finished tracks are kept in `finished_tails`)
+    memset(tracking_data->tails.keys, 0, tracking_data->tails._max_size * sizeof(track_tail_t));
+    tracking_data->tails.size = 0;
+    const size_t n_active = vector_size(tracking_data->active);
+    for (size_t a = 0; a < n_active; a++) {
+        track_tail_t tail;
+        _tails_from_RoI(&tracking_data->tracks[tracking_data->active[a]].end, &tail);
+        _tails_insert(&tracking_data->tails, &tail, 0);
+    }
+}
+
+size_t tracking_tracks_flush(tracking_data_t* tracking_data, FILE* f, const uint8_t only_finished) {
+    vec_track_t tracks = tracking_data->tracks;
+    vec_uint32_t active = tracking_data->active;
+    const size_t n_tracks = vector_size(tracks);
+    const size_t n_active = vector_size(active);
+
+    // compact the tracks vector (the order is kept) and update the positions of the active tracks
+    size_t n_kept = 0, a = 0;
+    for (size_t t = 0; t < n_tracks; t++) {
+        const uint8_t is_active = a < n_active && active[a] == t;
+        if (!only_finished || !is_active) {
+            tracking_track_write(f, &tracks[t]);
+            if (tracks[t].RoIs_id != NULL)
+                vector_free(tracks[t].RoIs_id);
+        } else {
+            if (n_kept != t)
+                memcpy(&tracks[n_kept], &tracks[t], sizeof(track_t));
+            active[a] = n_kept++;
+        }
+        if (is_active)
+            a++;
     }
 
-    rotate_history(tracking_data->history);
-    memset(tracking_data->history->RoIs[0], 0, tracking_data->history->n_RoIs[0] * sizeof(RoI4track_t));
-    tracking_data->history->n_RoIs[0] = 0;
+    const size_t n_flushed = n_tracks - n_kept;
+    for (size_t t = n_kept; t < n_tracks; t++)
+        vector_pop(tracks);
+    if (!only_finished)
+        while (vector_size(active))
+            vector_pop(active);
+    tracking_data->n_flushed += n_flushed;
+    return n_flushed;
 }
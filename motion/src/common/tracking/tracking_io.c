@@ -7,6 +7,20 @@
 #include "vec.h"
 #include "motion/tracking/tracking_io.h"
 
+void tracking_tracks_write_header(FILE* f) {
+    fprintf(f, "# -------||---------------------------||---------------------------\n");
+    fprintf(f, "#  Track ||           Begin           ||            End            \n");
+    fprintf(f, "# -------||---------------------------||---------------------------\n");
+    fprintf(f, "# -------||---------|--------|--------||---------|--------|--------\n");
+    fprintf(f, "#     Id || Frame # |      x |      y || Frame # |      x |      y \n");
+    fprintf(f, "# -------||---------|--------|--------||---------|--------|--------\n");
+}
+
+void tracking_track_write(FILE* f, const track_t* track) {
+    fprintf(f, "   %5d || %7u | %6.1f | %6.1f || %7u | %6.1f | %6.1f \n", track->id, track->begin.frame,
+            track->begin.r.x, track->begin.r.y, track->end.frame, track->end.r.x, track->end.r.y);
+}
+
 void tracking_tracks_write(FILE* f, const vec_track_t tracks) {
     size_t real_n_tracks = 0;
     size_t n_tracks = vector_size(tracks);
@@ -15,19 +29,11 @@ void tracking_tracks_write(FILE* f, const vec_track_t tracks) {
             real_n_tracks++;
 
     fprintf(f, "# Tracks [%lu]:\n", (unsigned long)real_n_tracks);
-    fprintf(f, "# -------||---------------------------||---------------------------\n");
-    fprintf(f, "#  Track ||           Begin           ||            End            \n");
-    fprintf(f, "# -------||---------------------------||---------------------------\n");
-    fprintf(f, "# -------||---------|--------|--------||---------|--------|--------\n");
-    fprintf(f, "#     Id || Frame # |      x |      y || Frame # |      x |      y \n");
-    fprintf(f, "# -------||---------|--------|--------||---------|--------|--------\n");
+    tracking_tracks_write_header(f);
 
     for (size_t i = 0; i < n_tracks; i++)
-        if (tracks[i].id) {
-            fprintf(f, "   %5d || %7u | %6.1f | %6.1f || %7u | %6.1f | %6.1f \n", tracks[i].id, tracks[i].begin.frame,
-                    tracks[i].begin.r.x, tracks[i].begin.r.y, tracks[i].end.frame, tracks[i].end.r.x,
-                    tracks[i].end.r.y);
-        }
+        if (tracks[i].id)
+            tracking_track_write(f, &tracks[i]);
 }
 
 void tracking_tracks_write_full(FILE* f, const vec_track_t tracks) {
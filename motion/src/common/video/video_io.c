@@ -2,11 +2,109 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <nrc2.h>
 
+#include "motion/macros.h"
+#include "motion/synth.h"
 #include "motion/video/video_io.h"
 
-#define MAX_BUFF_SIZE 16384
+#define ARENA_ALIGN (2 * 1024 * 1024) // size of a huge page
+#define FRAME_ALIGN 64 // each buffered frame starts on a new cache line
+#define ARENA_ROUND(size, align) ((((size) + (align) - 1) / (align)) * (align))
+
+static int _video_reader_decode_frame(video_reader_t* video, uint8_t** img);
+
+static uint8_t* _video_arena_alloc(const size_t size) {
+    // over-allocate to be able to align the arena on a huge page boundary, then unmap the unused head and tail
+    uint8_t* map = (uint8_t*)mmap(NULL, size + ARENA_ALIGN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                                  0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "(EE) can't allocate the frames buffer (%lu bytes)\n", (unsigned long)size);
+        exit(1);
+    }
+    uint8_t* arena = (uint8_t*)ARENA_ROUND((uintptr_t)map, (uintptr_t)ARENA_ALIGN);
+    if (arena != map)
+        munmap(map, arena - map);
+    munmap(arena + size, (map + size + ARENA_ALIGN) - (arena + size));
+#ifdef MADV_HUGEPAGE
+    madvise(arena, size, MADV_HUGEPAGE);
+#endif
+    return arena;
+}
+
+/* Read all the frames of the video sequence into one contiguous arena and build the rows of each frame. The arena is
+   doubled when it is full, this only happens during the initialization. */
+static void _video_reader_bufferize(video_reader_t* video, const size_t height, const size_t width) {
+    const size_t fra_size = ARENA_ROUND(height * width, (size_t)FRAME_ALIGN);
+    size_t max_count = 16;
+    if (video->frame_end)
+        max_count = MIN((size_t)1024, (video->frame_end - video->frame_start) / (1 + video->frame_skip) + 1);
+    video->fra_arena_size = ARENA_ROUND(max_count * fra_size, (size_t)ARENA_ALIGN);
+    video->fra_arena = _video_arena_alloc(video->fra_arena_size);
+
+    uint8_t** rows = (uint8_t**)malloc(height * sizeof(uint8_t*));
+    int frame_id;
+    do {
+        if ((video->fra_count + 1) * fra_size > video->fra_arena_size) {
+            uint8_t* arena = _video_arena_alloc(2 * video->fra_arena_size);
+            memcpy(arena, video->fra_arena, video->fra_count * fra_size);
+            munmap(video->fra_arena, video->fra_arena_size);
+            video->fra_arena = arena;
+            video->fra_arena_size *= 2;
+        }
+        uint8_t* frame = video->fra_arena + video->fra_count * fra_size;
+        for (size_t l = 0; l < height; l++)
+            rows[l] = frame + l * width;
+        frame_id = _video_reader_decode_frame(video, rows);
+    } while (frame_id != -1);
+    free(rows);
+
+    // give back the unused part of the arena
+    const size_t used_size = ARENA_ROUND(MAX(video->fra_count, (size_t)1) * fra_size, (size_t)ARENA_ALIGN);
+    if (used_size < video->fra_arena_size) {
+        munmap(video->fra_arena + used_size, video->fra_arena_size - used_size);
+        video->fra_arena_size = used_size;
+    }
+
+    const size_t n_frames = MAX(video->fra_count, (size_t)1);
+    video->fra_buffer = (uint8_t***)malloc(n_frames * sizeof(uint8_t**));
+    video->fra_buffer[0] = (uint8_t**)malloc(n_frames * height * sizeof(uint8_t*));
+    for (size_t f = 0; f < n_frames; f++) {
+        video->fra_buffer[f] = video->fra_buffer[0] + f * height;
+        for (size_t l = 0; l < height; l++)
+            video->fra_buffer[f][l] = video->fra_arena + f * fra_size + l * width;
+    }
+    video->frame_current = 0;
+    video->cur_loop = 1;
+}
+
+/* Return the next buffered frame (no copy), the frame rows point into the arena. */
+static int _video_reader_buffer_next(video_reader_t* video, const uint8_t*** frame) {
+    if (video->fra_count && (video->frame_current < video->fra_count || video->cur_loop < video->loop_size)) {
+        if (video->frame_current == video->fra_count) {
+            video->cur_loop++;
+            video->frame_current = 0;
+        }
+        *frame = (const uint8_t**)video->fra_buffer[video->frame_current];
+        int cur_fra = video->frame_start + (video->frame_current + (video->cur_loop -1) * video->fra_count) *
+                      (1 + video->frame_skip);
+        video->frame_current++;
+        return cur_fra;
+    } else
+        return -1;
+}
+
+static void _video_reader_free_buffer(video_reader_t* video) {
+    if (video->fra_buffer) {
+        free(video->fra_buffer[0]);
+        free(video->fra_buffer);
+        munmap(video->fra_arena, video->fra_arena_size);
+    }
+}
 
 #if MOTION_USE_FFMPEG_IO
 
@@ -81,35 +179,17 @@ video_reader_t* video_reader_ffio_alloc_init(const char* path, const size_t star
     *i1 = metadata->ffmpeg.input.height - 1;
     *j1 = metadata->ffmpeg.input.width - 1;
 
+    video->fra_arena = NULL;
+    video->fra_arena_size = 0;
     video->fra_buffer = NULL;
     video->fra_count = 0;
 
     video->cur_loop = 1;
     video->loop_size = 1;
+    video->prefetch = NULL;
 
-    int frame_id = 0;
-    if (bufferize) {
-        uint8_t*** fra_buffer_tmp;
-        fra_buffer_tmp = (uint8_t***)malloc(MAX_BUFF_SIZE * sizeof(uint8_t***));
-        do {
-            if (video->fra_count >= MAX_BUFF_SIZE) {
-                fprintf(stderr, "(EE) 'video->fra_count' has to be smaller than 'MAX_BUFF_SIZE' "
-                                "('video->fra_count' = %d, 'MAX_BUFF_SIZE' = %d\n)", (int)video->fra_count,
-                                (int)MAX_BUFF_SIZE);
-                exit(-1);
-            }
-            uint8_t **I = ui8matrix(*i0, *i1, *j0, *j1);
-            frame_id = video_reader_get_frame(video, I);
-            if (frame_id != -1) {
-                fra_buffer_tmp[video->fra_count -1] = I;
-            } else
-                free_ui8matrix(I, *i0, *i1, *j0, *j1);
-        } while (frame_id != -1);
-
-        video->fra_buffer = fra_buffer_tmp;
-        video->frame_current = 0;
-        video->cur_loop = 1;
-    }
+    if (bufferize)
+        _video_reader_bufferize(video, metadata->ffmpeg.input.height, metadata->ffmpeg.input.width);
 
     return video;
 }
@@ -157,19 +237,12 @@ retry:
         return (r == -1) ? r : video->frame_start + r + (video->cur_loop -1) * video->fra_count *
                                (1 + video->frame_skip);
     } else {
-        if (video->frame_current < video->fra_count || video->cur_loop < video->loop_size) {
-            if (video->frame_current == video->fra_count) {
-                video->cur_loop++;
-                video->frame_current = 0;
-            }
+        const uint8_t** frame;
+        const int cur_fra = _video_reader_buffer_next(video, &frame);
+        if (cur_fra != -1)
             for (unsigned l = 0; l < metadata->ffmpeg.input.height; l++)
-                memcpy(img[l], video->fra_buffer[video->frame_current][l], metadata->ffmpeg.input.width);
-            int cur_fra = video->frame_start + (video->frame_current + (video->cur_loop -1) * video->fra_count) *
-                          (1 + video->frame_skip);
-            video->frame_current++;
-            return cur_fra;
-        } else
-            return -1;
+                memcpy(img[l], frame[l], metadata->ffmpeg.input.width);
+        return cur_fra;
     }
 }
 
@@ -177,12 +250,7 @@ void video_reader_ffio_free(video_reader_t* video) {
     assert(video->codec_type == VCDC_FFMPEG_IO);
     video_metadata_ffio_t* metadata = (video_metadata_ffio_t*)video->metadata;
     ffmpeg_stop_reader(&metadata->ffmpeg);
-    if (video->fra_buffer) {
-        for (size_t i = 0; i < video->fra_count; i++)
-            free_ui8matrix(video->fra_buffer[i], 0, metadata->ffmpeg.input.height - 1, 0,
-                           metadata->ffmpeg.input.width - 1);
-        free(video->fra_buffer);
-    }
+    _video_reader_free_buffer(video);
     free(metadata);
     free(video);
 }
@@ -354,34 +422,18 @@ video_reader_t* video_reader_vcio_alloc_init(const char* path, const size_t star
     *i1 = metadata->reader.height - 1;
     *j1 = metadata->reader.width - 1;
 
+    video->fra_arena = NULL;
+    video->fra_arena_size = 0;
     video->fra_buffer = NULL;
     video->fra_count = 0;
 
     video->cur_loop = 1;
     video->loop_size = 1;
+    video->prefetch = NULL;
 
-    int frame_id = 0;
     if (bufferize) {
         fprintf(stdout, "Bufferizing image sequence\n");
-        uint8_t*** fra_buffer_tmp;
-        fra_buffer_tmp = (uint8_t***)malloc(MAX_BUFF_SIZE * sizeof(uint8_t***));
-        do {
-            if (video->fra_count >= MAX_BUFF_SIZE) {
-                fprintf(stderr, "(EE) 'video->fra_count' has to be smaller than 'MAX_BUFF_SIZE' "
-                                "('video->fra_count' = %d, 'MAX_BUFF_SIZE' = %d\n)", (int)video->fra_count,
-                                (int)MAX_BUFF_SIZE);
-                exit(-1);
-            }
-            uint8_t **I = ui8matrix(*i0, *i1, *j0, *j1);
-            frame_id = video_reader_vcio_get_frame(video, I);
-            if (frame_id != -1) {
-                fra_buffer_tmp[video->fra_count -1] = I;
-            } else
-                free_ui8matrix(I, *i0, *i1, *j0, *j1);
-        } while (frame_id != -1);
-        video->fra_buffer = fra_buffer_tmp;
-        video->frame_current = 0;
-        video->cur_loop = 1;
+        _video_reader_bufferize(video, metadata->reader.height, metadata->reader.width);
     }
 
     return video;
@@ -434,19 +486,12 @@ int video_reader_vcio_get_frame(video_reader_t* video, uint8_t** img) {
         return (status < 0) ? status : video->frame_start + cur_fra + (video->cur_loop) * video->fra_count
             * (1 + video->frame_skip);
     } else {
-        if (video->frame_current < video->fra_count || video->cur_loop < video->loop_size) {
-            if (video->frame_current == video->fra_count) {
-                video->cur_loop++;
-                video->frame_current = 0;
-            }
+        const uint8_t** frame;
+        const int cur_fra = _video_reader_buffer_next(video, &frame);
+        if (cur_fra != -1)
             for (unsigned l = 0; l < metadata->reader.height; l++)
-                memcpy(img[l], video->fra_buffer[video->frame_current][l], metadata->reader.width);
-            int cur_fra = video->frame_start + (video->frame_current + (video->cur_loop -1) * video->fra_count) *
-                (1 + video->frame_skip);
-            video->frame_current++;
-            return cur_fra;
-        } else
-            return -1;
+                memcpy(img[l], frame[l], metadata->reader.width);
+        return cur_fra;
     }
 }
 
@@ -454,17 +499,669 @@ void video_reader_vcio_free(video_reader_t* video) {
     assert(video->codec_type == VCDC_VCODECS_IO);
     video_metadata_vcio_t* metadata = (video_metadata_vcio_t*)video->metadata;
     vcio_reader_free(&metadata->reader);
-    if (video->fra_buffer) {
-        for (size_t i = 0; i < video->fra_count; i++)
-            free_ui8matrix(video->fra_buffer[i], 0, metadata->reader.height - 1, 0, metadata->reader.width - 1);
-        free(video->fra_buffer);
+    _video_reader_free_buffer(video);
+    free(metadata);
+    free(video);
+}
+
+#endif
+
+#if MOTION_USE_LIBAV
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+#ifdef __cplusplus
+}
+#endif
+
+typedef struct {
+    AVFormatContext* format; /*!< Demuxer context. */
+    AVCodecContext* codec; /*!< Decoder context. */
+    AVPacket* packet; /*!< Last demuxed packet. */
+    AVFrame* frame; /*!< Last decoded frame. */
+    int stream_id; /*!< Index of the decoded video stream. */
+    int draining; /*!< Boolean, the demuxer reached the end of the file and the decoder is flushed. */
+    size_t n_threads; /*!< Number of threads used by the decoder (0 means libavcodec will decide). */
+    size_t start; /*!< Start frame number. */
+} video_metadata_libav_t;
+
+static const char* _video_reader_libav_error(const int err, char* str) {
+    av_strerror(err, str, AV_ERROR_MAX_STRING_SIZE);
+    return str;
+}
+
+static void _video_reader_libav_close(video_metadata_libav_t* metadata) {
+    av_frame_free(&metadata->frame);
+    av_packet_free(&metadata->packet);
+    avcodec_free_context(&metadata->codec);
+    avformat_close_input(&metadata->format);
+}
+
+/* Return 1 if a new frame has been decoded in `metadata->frame`, 0 at the end of the video sequence. */
+static int _video_reader_libav_decode(video_metadata_libav_t* metadata) {
+    while (1) {
+        int ret = avcodec_receive_frame(metadata->codec, metadata->frame);
+        if (ret == 0)
+            return 1;
+        if (ret == AVERROR_EOF)
+            return 0;
+        char err[AV_ERROR_MAX_STRING_SIZE];
+        if (ret != AVERROR(EAGAIN)) {
+            fprintf(stderr, "(EE) %s\n", _video_reader_libav_error(ret, err));
+            return 0;
+        }
+        // the decoder needs more data
+        if (metadata->draining)
+            return 0;
+        ret = av_read_frame(metadata->format, metadata->packet);
+        if (ret < 0) { // end of file (or read error): flush the frames buffered in the decoder
+            metadata->draining = 1;
+            avcodec_send_packet(metadata->codec, NULL);
+            continue;
+        }
+        if (metadata->packet->stream_index == metadata->stream_id) {
+            ret = avcodec_send_packet(metadata->codec, metadata->packet);
+            if (ret < 0 && ret != AVERROR_INVALIDDATA)
+                fprintf(stderr, "(WW) %s\n", _video_reader_libav_error(ret, err));
+        }
+        av_packet_unref(metadata->packet);
+    }
+}
+
+static void _video_reader_libav_open(video_reader_t* video, video_metadata_libav_t* metadata) {
+    metadata->format = NULL;
+    AVDictionary* options = NULL;
+    if (metadata->start) // images sequence: the image2 demuxer starts at the right image
+        av_dict_set_int(&options, "start_number", (int64_t)metadata->start, 0);
+    int ret = avformat_open_input(&metadata->format, video->path, NULL, &options);
+    av_dict_free(&options);
+    if (ret < 0) {
+        char err[AV_ERROR_MAX_STRING_SIZE];
+        fprintf(stderr, "(EE) can't open file %s (%s)\n", video->path, _video_reader_libav_error(ret, err));
+        exit(1);
+    }
+    if (avformat_find_stream_info(metadata->format, NULL) < 0) {
+        fprintf(stderr, "(EE) can't find the streams of %s\n", video->path);
+        exit(1);
+    }
+
+    // `av_find_best_stream` returns a `const AVCodec*` since FFmpeg 5 (libavformat 59) but a `AVCodec*` before
+#if LIBAVFORMAT_VERSION_MAJOR >= 59
+    const AVCodec* decoder = NULL;
+#else
+    AVCodec* decoder = NULL;
+#endif
+    metadata->stream_id = av_find_best_stream(metadata->format, AVMEDIA_TYPE_VIDEO, -1, -1, &decoder, 0);
+    if (metadata->stream_id < 0 || decoder == NULL) {
+        fprintf(stderr, "(EE) can't find a decodable video stream in %s\n", video->path);
+        exit(1);
+    }
+    metadata->codec = avcodec_alloc_context3(decoder);
+    avcodec_parameters_to_context(metadata->codec, metadata->format->streams[metadata->stream_id]->codecpar);
+    metadata->codec->thread_count = (int)metadata->n_threads;
+    if (avcodec_open2(metadata->codec, decoder, NULL) < 0) {
+        fprintf(stderr, "(EE) can't open the '%s' decoder for %s\n", decoder->name, video->path);
+        exit(1);
+    }
+
+    // only the luma plane is used as the grayscale image, it has to be 8-bit and planar
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(metadata->codec->pix_fmt);
+    if (desc == NULL || (desc->flags & AV_PIX_FMT_FLAG_RGB) || (desc->flags & AV_PIX_FMT_FLAG_PAL) ||
+        desc->comp[0].depth != 8 || desc->comp[0].step != 1) {
+        fprintf(stderr, "(EE) the '%s' pixel format is not supported by the libav reader, use 'FFMPEG-IO' instead\n",
+                desc ? desc->name : "unknown");
+        exit(1);
+    }
+
+    metadata->packet = av_packet_alloc();
+    metadata->frame = av_frame_alloc();
+    metadata->draining = 0;
+
+    // video file: decode and drop the frames before the start frame (frame accurate)
+    if (metadata->start && strcmp(metadata->format->iformat->name, "image2") != 0)
+        for (size_t f = 0; f < metadata->start && _video_reader_libav_decode(metadata); f++)
+            av_frame_unref(metadata->frame);
+}
+
+video_reader_t* video_reader_libav_alloc_init(const char* path, const size_t start, const size_t end, const size_t skip,
+                                              const int bufferize, const size_t n_threads,
+                                              const enum video_codec_hwaccel_e hwaccel, int* i0, int* i1, int* j0,
+                                              int* j1) {
+    assert(!end || start <= end);
+    video_reader_t* video = (video_reader_t*)malloc(sizeof(video_reader_t));
+    if (!video) {
+        fprintf(stderr, "(EE) can't allocate video structure\n");
+        exit(1);
+    }
+
+    if (hwaccel != VCDC_HWACCEL_NONE) {
+        fprintf(stderr, "(EE) Only 'VCDC_HWACCEL_NONE' is supported at this time.\n");
+        exit(1);
+    }
+
+    fprintf(stderr, "(WW) the 'LIBAV' reader is experimental, 'FFMPEG-IO' remains the reference reader\n");
+
+    snprintf(video->path, sizeof(video->path), "%s", path);
+
+    video->codec_type = VCDC_LIBAV;
+    video_metadata_libav_t* metadata = (video_metadata_libav_t*)malloc(sizeof(video_metadata_libav_t));
+    video->metadata = (void*)metadata;
+    metadata->n_threads = n_threads;
+    metadata->start = start;
+    _video_reader_libav_open(video, metadata);
+
+    video->frame_start = start;
+    video->frame_end = end;
+    video->frame_skip = skip;
+    video->frame_current = 0;
+
+    *i0 = 0;
+    *j0 = 0;
+    *i1 = metadata->codec->height - 1;
+    *j1 = metadata->codec->width - 1;
+
+    video->fra_arena = NULL;
+    video->fra_arena_size = 0;
+    video->fra_buffer = NULL;
+    video->fra_count = 0;
+
+    video->cur_loop = 1;
+    video->loop_size = 1;
+    video->prefetch = NULL;
+
+    if (bufferize)
+        _video_reader_bufferize(video, metadata->codec->height, metadata->codec->width);
+
+    return video;
+}
+
+static int _video_reader_libav_get_frame(video_reader_t* video, uint8_t** img) {
+    video_metadata_libav_t* metadata = (video_metadata_libav_t*)video->metadata;
+
+    if (video->frame_end && video->frame_start + video->frame_current > video->frame_end)
+        return -1;
+
+    if (!_video_reader_libav_decode(metadata))
+        return -1;
+
+    // grayscale = luma plane, copied directly into the image of the chain
+    const AVFrame* frame = metadata->frame;
+    assert(frame->width == metadata->codec->width && frame->height == metadata->codec->height);
+    for (int l = 0; l < frame->height; l++)
+        memcpy(img[l], frame->data[0] + (ptrdiff_t)l * frame->linesize[0], frame->width);
+    av_frame_unref(metadata->frame);
+
+    int cur_fra = (int)video->frame_current;
+    video->frame_current++;
+    return cur_fra;
+}
+
+int video_reader_libav_get_frame(video_reader_t* video, uint8_t** img) {
+    assert(video->codec_type == VCDC_LIBAV);
+    video_metadata_libav_t* metadata = (video_metadata_libav_t*)video->metadata;
+retry:
+    if (video->fra_buffer == NULL) {
+        int r;
+        size_t skip = video->frame_current == 0 ? 0 : video->frame_skip;
+        do {
+            r = _video_reader_libav_get_frame(video, img);
+            // restart reader
+            if (r == -1 && video->cur_loop < video->loop_size) {
+                video->cur_loop++;
+                video->frame_current = 0;
+                _video_reader_libav_close(metadata);
+                _video_reader_libav_open(video, metadata);
+                goto retry;
+            }
+        } while ((r != -1) && skip--);
+        if (video->cur_loop == 1 && r != -1)
+            video->fra_count++;
+        return (r == -1) ? r : video->frame_start + r + (video->cur_loop -1) * video->fra_count *
+                               (1 + video->frame_skip);
+    } else {
+        const uint8_t** frame;
+        const int cur_fra = _video_reader_buffer_next(video, &frame);
+        if (cur_fra != -1)
+            for (int l = 0; l < metadata->codec->height; l++)
+                memcpy(img[l], frame[l], metadata->codec->width);
+        return cur_fra;
     }
+}
+
+void video_reader_libav_free(video_reader_t* video) {
+    assert(video->codec_type == VCDC_LIBAV);
+    video_metadata_libav_t* metadata = (video_metadata_libav_t*)video->metadata;
+    _video_reader_libav_close(metadata);
+    _video_reader_free_buffer(video);
     free(metadata);
     free(video);
 }
 
 #endif
 
+// ----------------------------------------------------------------------------
+// -- Raw I420 / Y4M files mapped in memory -----------------------------------
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    uint8_t* map; /*!< Mapping of the whole file. */
+    size_t map_size; /*!< Size of the file in bytes. */
+    size_t* frames; /*!< Offset of the Y plane of each frame in the mapping (\f$[\texttt{n\_frames}]\f$). */
+    size_t n_frames; /*!< Number of complete frames in the file. */
+    size_t width; /*!< Frames width. */
+    size_t height; /*!< Frames height. */
+    const uint8_t** rows[2]; /*!< Rows of the two last returned frames, they point into the mapping. */
+    size_t cur_rows; /*!< Index of the last used `rows`. */
+} video_metadata_mmap_t;
+
+/* Size of the chroma planes of one frame for a Y4M colorspace (`C` parameter), 0 if the colorspace is not supported
+   (only the 8-bit colorspaces are). */
+static size_t _video_reader_mmap_chroma_size(const char* cs, const size_t width, const size_t height, int* valid) {
+    const size_t cw = (width + 1) / 2, ch = (height + 1) / 2;
+    *valid = 1;
+    if (cs == NULL || !strcmp(cs, "420") || !strcmp(cs, "420jpeg") || !strcmp(cs, "420mpeg2") ||
+        !strcmp(cs, "420paldv"))
+        return 2 * cw * ch;
+    if (!strcmp(cs, "422"))
+        return 2 * cw * height;
+    if (!strcmp(cs, "444"))
+        return 2 * width * height;
+    if (!strcmp(cs, "444alpha"))
+        return 3 * width * height;
+    if (!strcmp(cs, "mono"))
+        return 0;
+    *valid = 0;
+    return 0;
+}
+
+static void _video_reader_mmap_add_frame(video_metadata_mmap_t* metadata, size_t* max_frames, const size_t offset) {
+    if (metadata->n_frames == *max_frames) {
+        *max_frames = *max_frames ? 2 * *max_frames : 256;
+        metadata->frames = (size_t*)realloc(metadata->frames, *max_frames * sizeof(size_t));
+    }
+    metadata->frames[metadata->n_frames++] = offset;
+}
+
+/* Parse the stream header of a Y4M file and index the Y plane of all its frames. */
+static void _video_reader_mmap_index_y4m(const char* path, video_metadata_mmap_t* metadata) {
+    const char* map = (const char*)metadata->map;
+    const char* end = map + metadata->map_size;
+    const char* eol = (const char*)memchr(map, '\n', metadata->map_size);
+    if (eol == NULL || strncmp(map, "YUV4MPEG2 ", 10)) {
+        fprintf(stderr, "(EE) '%s' is not a valid Y4M file\n", path);
+        exit(1);
+    }
+    char header[256], cs[32];
+    snprintf(header, sizeof(header), "%.*s", (int)(eol - map), map);
+    int has_cs = 0;
+    char* save;
+    for (char* tok = strtok_r(header + 10, " ", &save); tok; tok = strtok_r(NULL, " ", &save)) {
+        if (tok[0] == 'W')
+            metadata->width = strtoul(tok + 1, NULL, 10);
+        else if (tok[0] == 'H')
+            metadata->height = strtoul(tok + 1, NULL, 10);
+        else if (tok[0] == 'C') {
+            snprintf(cs, sizeof(cs), "%s", tok + 1);
+            has_cs = 1;
+        }
+    }
+    int valid;
+    const size_t chroma_size = _video_reader_mmap_chroma_size(has_cs ? cs : NULL, metadata->width, metadata->height,
+                                                              &valid);
+    if (!metadata->width || !metadata->height || !valid) {
+        fprintf(stderr, "(EE) unsupported Y4M stream in '%s' (8-bit 'mono', '420', '422' and '444' only)\n", path);
+        exit(1);
+    }
+    const size_t frame_size = metadata->width * metadata->height + chroma_size;
+
+    size_t max_frames = 0;
+    const char* cur = eol + 1;
+    while (cur + 5 < end && !strncmp(cur, "FRAME", 5)) {
+        // each frame starts with a header line that can contain parameters
+        eol = (const char*)memchr(cur, '\n', end - cur);
+        if (eol == NULL || (size_t)(end - (eol + 1)) < frame_size)
+            break; // truncated frame
+        _video_reader_mmap_add_frame(metadata, &max_frames, (eol + 1) - map);
+        cur = eol + 1 + frame_size;
+    }
+}
+
+/* Raw I420 file: the dimensions are given in the name of the file (e.g. 'foreman_352x288.yuv'). */
+static void _video_reader_mmap_index_raw(const char* path, video_metadata_mmap_t* metadata) {
+    const char* name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    unsigned width = 0, height = 0;
+    for (const char* c = name; *c && !(width && height); c++)
+        if (*c >= '0' && *c <= '9' && (c == name || c[-1] < '0' || c[-1] > '9'))
+            if (sscanf(c, "%ux%u", &width, &height) != 2)
+                width = height = 0;
+    if (!width || !height) {
+        fprintf(stderr, "(EE) the dimensions of the raw video '%s' have to be in its name (e.g. 'video_1920x1080.yuv')"
+                        "\n", path);
+        exit(1);
+    }
+    metadata->width = width;
+    metadata->height = height;
+    int valid;
+    const size_t frame_size = metadata->width * metadata->height +
+                              _video_reader_mmap_chroma_size(NULL, metadata->width, metadata->height, &valid);
+    size_t max_frames = 0;
+    for (size_t offset = 0; offset + frame_size <= metadata->map_size; offset += frame_size)
+        _video_reader_mmap_add_frame(metadata, &max_frames, offset);
+}
+
+video_reader_t* video_reader_mmap_alloc_init(const char* path, const size_t start, const size_t end, const size_t skip,
+                                             const int bufferize, const enum video_codec_hwaccel_e hwaccel, int* i0,
+                                             int* i1, int* j0, int* j1) {
+    assert(!end || start <= end);
+    video_reader_t* video = (video_reader_t*)malloc(sizeof(video_reader_t));
+    if (!video) {
+        fprintf(stderr, "(EE) can't allocate video structure\n");
+        exit(1);
+    }
+
+    if (hwaccel != VCDC_HWACCEL_NONE) {
+        fprintf(stderr, "(EE) Only 'VCDC_HWACCEL_NONE' is supported at this time.\n");
+        exit(1);
+    }
+
+    snprintf(video->path, sizeof(video->path), "%s", path);
+
+    video->codec_type = VCDC_YUV_MMAP;
+    video_metadata_mmap_t* metadata = (video_metadata_mmap_t*)calloc(1, sizeof(video_metadata_mmap_t));
+    video->metadata = (void*)metadata;
+
+    int fd = open(video->path, O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1 || st.st_size == 0) {
+        fprintf(stderr, "(EE) can't open file %s\n", video->path);
+        exit(1);
+    }
+    metadata->map_size = (size_t)st.st_size;
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (bufferize) // the whole file is read in memory now
+        flags |= MAP_POPULATE;
+#endif
+    metadata->map = (uint8_t*)mmap(NULL, metadata->map_size, PROT_READ, flags, fd, 0);
+    close(fd);
+    if (metadata->map == MAP_FAILED) {
+        fprintf(stderr, "(EE) can't map file %s\n", video->path);
+        exit(1);
+    }
+
+    const char* ext = strrchr(video->path, '.');
+    if (ext && !strcmp(ext, ".y4m"))
+        _video_reader_mmap_index_y4m(video->path, metadata);
+    else
+        _video_reader_mmap_index_raw(video->path, metadata);
+
+    for (int r = 0; r < 2; r++)
+        metadata->rows[r] = (const uint8_t**)malloc(metadata->height * sizeof(const uint8_t*));
+    metadata->cur_rows = 0;
+
+    video->frame_start = start;
+    video->frame_end = end;
+    video->frame_skip = skip;
+    video->frame_current = 0;
+
+    *i0 = 0;
+    *j0 = 0;
+    *i1 = metadata->height - 1;
+    *j1 = metadata->width - 1;
+
+    // the frames are already in memory, they are never copied in the frames arena
+    video->fra_arena = NULL;
+    video->fra_arena_size = 0;
+    video->fra_buffer = NULL;
+    video->fra_count = 0;
+
+    video->cur_loop = 1;
+    video->loop_size = 1;
+    video->prefetch = NULL;
+
+    return video;
+}
+
+/* Same frames sequence (start, stop, skip and loops) and same frame ids as the other readers, but no decoding: return
+   the Y plane of the next frame in the mapping. */
+static int _video_reader_mmap_next(video_reader_t* video, const uint8_t** y_plane) {
+    video_metadata_mmap_t* metadata = (video_metadata_mmap_t*)video->metadata;
+    while (1) {
+        const size_t skip = video->frame_current == 0 ? 0 : video->frame_skip;
+        const size_t index = video->frame_current + skip;
+        if ((!video->frame_end || video->frame_start + index <= video->frame_end) &&
+            video->frame_start + index < metadata->n_frames) {
+            video->frame_current = index + 1;
+            if (video->cur_loop == 1)
+                video->fra_count++;
+            *y_plane = metadata->map + metadata->frames[video->frame_start + index];
+            return video->frame_start + index + (video->cur_loop -1) * video->fra_count * (1 + video->frame_skip);
+        }
+        // restart reader
+        if (video->cur_loop >= video->loop_size || video->fra_count == 0)
+            return -1;
+        video->cur_loop++;
+        video->frame_current = 0;
+    }
+}
+
+int video_reader_mmap_get_frame_view(video_reader_t* video, const uint8_t*** frame) {
+    assert(video->codec_type == VCDC_YUV_MMAP);
+    video_metadata_mmap_t* metadata = (video_metadata_mmap_t*)video->metadata;
+    const uint8_t* y_plane;
+    const int cur_fra = _video_reader_mmap_next(video, &y_plane);
+    if (cur_fra == -1)
+        return -1;
+    metadata->cur_rows = (metadata->cur_rows + 1) % 2;
+    const uint8_t** rows = metadata->rows[metadata->cur_rows];
+    for (size_t l = 0; l < metadata->height; l++)
+        rows[l] = y_plane + l * metadata->width;
+    *frame = rows;
+    return cur_fra;
+}
+
+int video_reader_mmap_get_frame(video_reader_t* video, uint8_t** img) {
+    assert(video->codec_type == VCDC_YUV_MMAP);
+    video_metadata_mmap_t* metadata = (video_metadata_mmap_t*)video->metadata;
+    const uint8_t* y_plane;
+    const int cur_fra = _video_reader_mmap_next(video, &y_plane);
+    if (cur_fra != -1)
+        for (size_t l = 0; l < metadata->height; l++)
+            memcpy(img[l], y_plane + l * metadata->width, metadata->width);
+    return cur_fra;
+}
+
+void video_reader_mmap_free(video_reader_t* video) {
+    assert(video->codec_type == VCDC_YUV_MMAP);
+    video_metadata_mmap_t* metadata = (video_metadata_mmap_t*)video->metadata;
+    munmap(metadata->map, metadata->map_size);
+    free(metadata->frames);
+    for (int r = 0; r < 2; r++)
+        free(metadata->rows[r]);
+    free(metadata);
+    free(video);
+}
+
+// ----------------------------------------------------------------------------
+// -- Synthetic scene ---------------------------------------------------------
+// ----------------------------------------------------------------------------
+
+typedef struct {
+    synth_data_t* synth_data; /*!< Synthetic scene. */
+    size_t n_frames; /*!< Number of frames of the sequence (0 means endless). */
+    size_t width; /*!< Frames width. */
+    size_t height; /*!< Frames height. */
+} video_metadata_synth_t;
+
+/* Parse a 'synth://[WxH][?key=value[&key=value...]]' path, the keys are 'objs', 'size', 'speed', 'noise', 'seed' and
+   'frames' (see `synth_data_t`). Each parameter is optional. */
+static void _video_reader_synth_parse(const char* path, size_t* width, size_t* height, size_t* n_objs, float* size,
+                                      float* speed, float* noise, uint64_t* seed, size_t* n_frames) {
+    const char* cur = path + strlen(VIDEO_SYNTH_PREFIX);
+    if (*cur && *cur != '?') {
+        unsigned w, h;
+        int n;
+        if (sscanf(cur, "%ux%u%n", &w, &h, &n) != 2 || w < 3 || h < 3 || (cur[n] && cur[n] != '?')) {
+            fprintf(stderr, "(EE) invalid dimensions in '%s' (expected 'synth://WIDTHxHEIGHT', 3x3 minimum)\n", path);
+            exit(1);
+        }
+        *width = w;
+        *height = h;
+        cur += n;
+    }
+    if (*cur == '?')
+        cur++;
+    while (*cur) {
+        const char* end = strchr(cur, '&');
+        const size_t len = end ? (size_t)(end - cur) : strlen(cur);
+        char param[256];
+        snprintf(param, sizeof(param), "%.*s", (int)MIN(len, sizeof(param) - 1), cur);
+        char* value = strchr(param, '=');
+        if (value == NULL) {
+            fprintf(stderr, "(EE) invalid parameter '%s' in '%s' (expected 'key=value')\n", param, path);
+            exit(1);
+        }
+        *value++ = '\0';
+        if (!strcmp(param, "objs"))
+            *n_objs = strtoul(value, NULL, 10);
+        else if (!strcmp(param, "size"))
+            *size = MAX(strtof(value, NULL), 1.f);
+        else if (!strcmp(param, "speed"))
+            *speed = MAX(strtof(value, NULL), 0.f);
+        else if (!strcmp(param, "noise"))
+            *noise = CLAMP(strtof(value, NULL), 0.f, 1.f);
+        else if (!strcmp(param, "seed"))
+            *seed = strtoull(value, NULL, 10);
+        else if (!strcmp(param, "frames"))
+            *n_frames = strtoul(value, NULL, 10);
+        else {
+            fprintf(stderr, "(EE) unknown parameter '%s' in '%s' (expected 'objs', 'size', 'speed', 'noise', 'seed' "
+                            "or 'frames')\n", param, path);
+            exit(1);
+        }
+        cur += len + (end ? 1 : 0);
+    }
+}
+
+video_reader_t* video_reader_synth_alloc_init(const char* path, const size_t start, const size_t end,
+                                              const size_t skip, const int bufferize,
+                                              const enum video_codec_hwaccel_e hwaccel, int* i0, int* i1, int* j0,
+                                              int* j1) {
+    assert(!end || start <= end);
+    video_reader_t* video = (video_reader_t*)malloc(sizeof(video_reader_t));
+    if (!video) {
+        fprintf(stderr, "(EE) can't allocate video structure\n");
+        exit(1);
+    }
+
+    if (hwaccel != VCDC_HWACCEL_NONE) {
+        fprintf(stderr, "(EE) Only 'VCDC_HWACCEL_NONE' is supported at this time.\n");
+        exit(1);
+    }
+
+    snprintf(video->path, sizeof(video->path), "%s", path);
+
+    video->codec_type = VCDC_SYNTH;
+    video_metadata_synth_t* metadata = (video_metadata_synth_t*)malloc(sizeof(video_metadata_synth_t));
+    video->metadata = (void*)metadata;
+
+    size_t n_objs = 32;
+    float size = 24.f, speed = 3.f, noise = 0.001f;
+    uint64_t seed = 1;
+    metadata->width = 1920;
+    metadata->height = 1080;
+    metadata->n_frames = 1000;
+    _video_reader_synth_parse(video->path, &metadata->width, &metadata->height, &n_objs, &size, &speed, &noise, &seed,
+                              &metadata->n_frames);
+    if (bufferize && !metadata->n_frames && !end) {
+        fprintf(stderr, "(EE) an endless synthetic sequence ('frames=0') can't be bufferized without a stop frame\n");
+        exit(1);
+    }
+    metadata->synth_data = synth_alloc_data(0, metadata->height - 1, 0, metadata->width - 1, n_objs, size, speed,
+                                            noise, seed);
+    synth_init_data(metadata->synth_data);
+
+    video->frame_start = start;
+    video->frame_end = end;
+    video->frame_skip = skip;
+    video->frame_current = 0;
+
+    *i0 = 0;
+    *j0 = 0;
+    *i1 = metadata->height - 1;
+    *j1 = metadata->width - 1;
+
+    video->fra_arena = NULL;
+    video->fra_arena_size = 0;
+    video->fra_buffer = NULL;
+    video->fra_count = 0;
+
+    video->cur_loop = 1;
+    video->loop_size = 1;
+    video->prefetch = NULL;
+
+    if (bufferize)
+        _video_reader_bufferize(video, metadata->height, metadata->width);
+
+    return video;
+}
+
+/* Same frames sequence (start, stop, skip and loops) and same frame ids as the other readers, a frame only depends on
+   its index in the sequence so it is rendered directly. */
+static int _video_reader_synth_next(video_reader_t* video, size_t* frame) {
+    video_metadata_synth_t* metadata = (video_metadata_synth_t*)video->metadata;
+    while (1) {
+        const size_t skip = video->frame_current == 0 ? 0 : video->frame_skip;
+        const size_t index = video->frame_current + skip;
+        if ((!video->frame_end || video->frame_start + index <= video->frame_end) &&
+            (!metadata->n_frames || video->frame_start + index < metadata->n_frames)) {
+            video->frame_current = index + 1;
+            if (video->cur_loop == 1)
+                video->fra_count++;
+            *frame = video->frame_start + index;
+            return video->frame_start + index + (video->cur_loop -1) * video->fra_count * (1 + video->frame_skip);
+        }
+        // restart reader
+        if (video->cur_loop >= video->loop_size || video->fra_count == 0)
+            return -1;
+        video->cur_loop++;
+        video->frame_current = 0;
+    }
+}
+
+int video_reader_synth_get_frame(video_reader_t* video, uint8_t** img) {
+    assert(video->codec_type == VCDC_SYNTH);
+    video_metadata_synth_t* metadata = (video_metadata_synth_t*)video->metadata;
+    if (video->fra_buffer == NULL) {
+        size_t frame;
+        const int cur_fra = _video_reader_synth_next(video, &frame);
+        if (cur_fra != -1)
+            synth_render_gray(metadata->synth_data, frame, img);
+        return cur_fra;
+    } else {
+        const uint8_t** frame;
+        const int cur_fra = _video_reader_buffer_next(video, &frame);
+        if (cur_fra != -1)
+            for (size_t l = 0; l < metadata->height; l++)
+                memcpy(img[l], frame[l], metadata->width);
+        return cur_fra;
+    }
+}
+
+void video_reader_synth_free(video_reader_t* video) {
+    assert(video->codec_type == VCDC_SYNTH);
+    video_metadata_synth_t* metadata = (video_metadata_synth_t*)video->metadata;
+    synth_free_data(metadata->synth_data);
+    _video_reader_free_buffer(video);
+    free(metadata);
+    free(video);
+}
+
 // ----------------------------------------------------------------------------
 // ----------------------------------------------------------------------------
 
@@ -472,7 +1169,10 @@ video_reader_t* video_reader_alloc_init(const char* path, const size_t start, co
                                         const int bufferize, const size_t n_ffmpeg_threads,
                                         const enum video_codec_e codec_type, const enum video_codec_hwaccel_e hwaccel,
                                         int* i0, int* i1, int* j0, int* j1) {
-    switch (codec_type) {
+    // the synthetic scenes are selected from their path, whatever the decoder
+    const enum video_codec_e type = strncmp(path, VIDEO_SYNTH_PREFIX, strlen(VIDEO_SYNTH_PREFIX)) ? codec_type
+                                                                                                   : VCDC_SYNTH;
+    switch (type) {
         case VCDC_FFMPEG_IO: {
 #ifdef MOTION_USE_FFMPEG_IO
             return video_reader_ffio_alloc_init(path, start, end, skip, bufferize, n_ffmpeg_threads, hwaccel, i0, i1, j0, j1);
@@ -491,6 +1191,24 @@ video_reader_t* video_reader_alloc_init(const char* path, const size_t start, co
             exit(-1);
 #endif
         }
+        case VCDC_LIBAV: {
+#ifdef MOTION_USE_LIBAV
+            return video_reader_libav_alloc_init(path, start, end, skip, bufferize, n_ffmpeg_threads, hwaccel, i0, i1, j0,
+                                                 j1);
+            break;
+#else
+            fprintf(stderr, "(EE) Link with the libav libraries is required.\n");
+            exit(-1);
+#endif
+        }
+        case VCDC_YUV_MMAP: {
+            return video_reader_mmap_alloc_init(path, start, end, skip, bufferize, hwaccel, i0, i1, j0, j1);
+            break;
+        }
+        case VCDC_SYNTH: {
+            return video_reader_synth_alloc_init(path, start, end, skip, bufferize, hwaccel, i0, i1, j0, j1);
+            break;
+        }
         default: {
             fprintf(stderr, "(EE) This should never happen.\n");
             exit(-1);
@@ -498,7 +1216,7 @@ video_reader_t* video_reader_alloc_init(const char* path, const size_t start, co
     }
 }
 
-int video_reader_get_frame(video_reader_t* video, uint8_t** img) {
+static int _video_reader_decode_frame(video_reader_t* video, uint8_t** img) {
     switch (video->codec_type) {
         case VCDC_FFMPEG_IO: {
 #ifdef MOTION_USE_FFMPEG_IO
@@ -518,6 +1236,23 @@ int video_reader_get_frame(video_reader_t* video, uint8_t** img) {
             exit(-1);
 #endif
         }
+        case VCDC_LIBAV: {
+#ifdef MOTION_USE_LIBAV
+            return video_reader_libav_get_frame(video, img);
+            break;
+#else
+            fprintf(stderr, "(EE) Link with the libav libraries is required.\n");
+            exit(-1);
+#endif
+        }
+        case VCDC_YUV_MMAP: {
+            return video_reader_mmap_get_frame(video, img);
+            break;
+        }
+        case VCDC_SYNTH: {
+            return video_reader_synth_get_frame(video, img);
+            break;
+        }
         default: {
             fprintf(stderr, "(EE) This should never happen.\n");
             exit(-1);
@@ -525,7 +1260,179 @@ int video_reader_get_frame(video_reader_t* video, uint8_t** img) {
     }
 }
 
+// number of frames returned by `video_reader_get_frame_view` that remain valid in prefetching mode
+#define PREFETCH_N_HELD 2
+
+// number of polls of the other thread before going to sleep: it is often only a few microseconds late, but polling
+// longer (or yielding in a loop) burns a core that the chain or the decoder could use
+#define PREFETCH_N_SPINS 128
+
+/* The counters and the `*_waiting` flags are accessed with sequentially consistent operations: a thread sets its flag
+   before checking the counter one last time and the other thread publishes the counter before reading the flag, so at
+   least one of them sees the other and a wake up can not be lost. */
+static int _video_prefetch_can_produce(video_prefetch_t* pf, const size_t n) {
+    return n - __atomic_load_n(&pf->released, __ATOMIC_SEQ_CST) != pf->n_slots ||
+           __atomic_load_n(&pf->stop, __ATOMIC_SEQ_CST);
+}
+
+static int _video_prefetch_can_consume(video_prefetch_t* pf) {
+    return pf->consumed != __atomic_load_n(&pf->produced, __ATOMIC_SEQ_CST);
+}
+
+static void _video_prefetch_wake(video_prefetch_t* pf, uint8_t* waiting, pthread_cond_t* cond) {
+    if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&pf->lock);
+        pthread_cond_signal(cond);
+        pthread_mutex_unlock(&pf->lock);
+    }
+}
+
+/* Wait for a free slot to read the frame `n` (or for the reader to stop the I/O thread). */
+static void _video_prefetch_wait_slot(video_prefetch_t* pf, const size_t n) {
+    for (unsigned t = 0; t < PREFETCH_N_SPINS; t++)
+        if (_video_prefetch_can_produce(pf, n))
+            return;
+    pthread_mutex_lock(&pf->lock);
+    __atomic_store_n(&pf->producer_waiting, 1, __ATOMIC_SEQ_CST);
+    while (!_video_prefetch_can_produce(pf, n))
+        pthread_cond_wait(&pf->cond_released, &pf->lock);
+    __atomic_store_n(&pf->producer_waiting, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&pf->lock);
+}
+
+/* Wait for the I/O thread to produce the next frame. */
+static void _video_prefetch_wait_frame(video_prefetch_t* pf) {
+    for (unsigned t = 0; t < PREFETCH_N_SPINS; t++)
+        if (_video_prefetch_can_consume(pf))
+            return;
+    pthread_mutex_lock(&pf->lock);
+    __atomic_store_n(&pf->consumer_waiting, 1, __ATOMIC_SEQ_CST);
+    while (!_video_prefetch_can_consume(pf))
+        pthread_cond_wait(&pf->cond_produced, &pf->lock);
+    __atomic_store_n(&pf->consumer_waiting, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&pf->lock);
+}
+
+static void* _video_prefetch_thread(void* arg) {
+    video_reader_t* video = (video_reader_t*)arg;
+    video_prefetch_t* pf = video->prefetch;
+    size_t n = 0;
+    int frame_id;
+    do {
+        _video_prefetch_wait_slot(pf, n);
+        if (__atomic_load_n(&pf->stop, __ATOMIC_SEQ_CST))
+            return NULL;
+        const size_t s = n % pf->n_slots;
+        frame_id = _video_reader_decode_frame(video, pf->slots[s]);
+        pf->slots_frame[s] = frame_id;
+        __atomic_store_n(&pf->produced, ++n, __ATOMIC_SEQ_CST);
+        _video_prefetch_wake(pf, &pf->consumer_waiting, &pf->cond_produced);
+    } while (frame_id != -1 && !__atomic_load_n(&pf->stop, __ATOMIC_RELAXED));
+    return NULL;
+}
+
+/* Return the id of the next prefetched frame and its slot, -1 at the end of the video sequence (the end marker is not
+   consumed so the next calls also return -1). */
+static int _video_prefetch_pop(video_prefetch_t* pf, size_t* slot) {
+    _video_prefetch_wait_frame(pf);
+    *slot = pf->consumed % pf->n_slots;
+    if (pf->slots_frame[*slot] == -1)
+        return -1;
+    pf->consumed++;
+    return pf->slots_frame[*slot];
+}
+
+/* Give back the oldest slots to the I/O thread, `n_held` frames are kept by the reader. */
+static void _video_prefetch_release(video_prefetch_t* pf, const size_t n_held) {
+    if (pf->consumed - pf->released > n_held) {
+        __atomic_store_n(&pf->released, pf->consumed - n_held, __ATOMIC_SEQ_CST);
+        _video_prefetch_wake(pf, &pf->producer_waiting, &pf->cond_released);
+    }
+}
+
+void video_reader_prefetch_start(video_reader_t* video, const size_t depth, const int i0, const int i1, const int j0,
+                                 const int j1) {
+    assert(depth > 0);
+    assert(video->prefetch == NULL);
+    if (video->fra_buffer || video->codec_type == VCDC_YUV_MMAP) // the frames are already in memory
+        return;
+    video_prefetch_t* pf = (video_prefetch_t*)malloc(sizeof(video_prefetch_t));
+    pf->n_slots = depth + PREFETCH_N_HELD;
+    pf->slots = (uint8_t***)malloc(pf->n_slots * sizeof(uint8_t**));
+    pf->slots_frame = (int*)malloc(pf->n_slots * sizeof(int));
+    for (size_t s = 0; s < pf->n_slots; s++) {
+        pf->slots[s] = ui8matrix(i0, i1, j0, j1);
+        pf->slots_frame[s] = -1;
+    }
+    pf->i0 = i0;
+    pf->i1 = i1;
+    pf->j0 = j0;
+    pf->j1 = j1;
+    pf->produced = 0;
+    pf->released = 0;
+    pf->consumed = 0;
+    pf->stop = 0;
+    pf->producer_waiting = 0;
+    pf->consumer_waiting = 0;
+    pthread_mutex_init(&pf->lock, NULL);
+    pthread_cond_init(&pf->cond_produced, NULL);
+    pthread_cond_init(&pf->cond_released, NULL);
+    video->prefetch = pf;
+    if (pthread_create(&pf->thread, NULL, _video_prefetch_thread, video)) {
+        fprintf(stderr, "(EE) Unable to create the video prefetching thread.\n");
+        exit(1);
+    }
+}
+
+static void _video_prefetch_free(video_reader_t* video) {
+    video_prefetch_t* pf = video->prefetch;
+    __atomic_store_n(&pf->stop, 1, __ATOMIC_SEQ_CST);
+    _video_prefetch_wake(pf, &pf->producer_waiting, &pf->cond_released);
+    pthread_join(pf->thread, NULL);
+    pthread_cond_destroy(&pf->cond_released);
+    pthread_cond_destroy(&pf->cond_produced);
+    pthread_mutex_destroy(&pf->lock);
+    for (size_t s = 0; s < pf->n_slots; s++)
+        free_ui8matrix(pf->slots[s], pf->i0, pf->i1, pf->j0, pf->j1);
+    free(pf->slots);
+    free(pf->slots_frame);
+    free(pf);
+    video->prefetch = NULL;
+}
+
+int video_reader_get_frame(video_reader_t* video, uint8_t** img) {
+    video_prefetch_t* pf = video->prefetch;
+    if (pf == NULL)
+        return _video_reader_decode_frame(video, img);
+    size_t s;
+    const int cur_fra = _video_prefetch_pop(pf, &s);
+    if (cur_fra != -1)
+        for (int i = pf->i0; i <= pf->i1; i++)
+            memcpy(img[i] + pf->j0, pf->slots[s][i] + pf->j0, pf->j1 - pf->j0 + 1);
+    _video_prefetch_release(pf, 0);
+    return cur_fra;
+}
+
+int video_reader_get_frame_view(video_reader_t* video, uint8_t** img, const uint8_t*** frame) {
+    if (video->fra_buffer)
+        return _video_reader_buffer_next(video, frame);
+    video_prefetch_t* pf = video->prefetch;
+    if (pf) {
+        size_t s;
+        const int cur_fra = _video_prefetch_pop(pf, &s);
+        *frame = (const uint8_t**)pf->slots[s];
+        _video_prefetch_release(pf, PREFETCH_N_HELD);
+        return cur_fra;
+    }
+    if (video->codec_type == VCDC_YUV_MMAP)
+        return video_reader_mmap_get_frame_view(video, frame);
+    *frame = (const uint8_t**)img;
+    return _video_reader_decode_frame(video, img);
+}
+
 void video_reader_free(video_reader_t* video) {
+    if (video->prefetch)
+        _video_prefetch_free(video);
     switch (video->codec_type) {
         case VCDC_FFMPEG_IO: {
 #ifdef MOTION_USE_FFMPEG_IO
@@ -545,6 +1452,23 @@ void video_reader_free(video_reader_t* video) {
             exit(-1);
 #endif
         }
+        case VCDC_LIBAV: {
+#ifdef MOTION_USE_LIBAV
+            video_reader_libav_free(video);
+            break;
+#else
+            fprintf(stderr, "(EE) Link with the libav libraries is required.\n");
+            exit(-1);
+#endif
+        }
+        case VCDC_YUV_MMAP: {
+            video_reader_mmap_free(video);
+            break;
+        }
+        case VCDC_SYNTH: {
+            video_reader_synth_free(video);
+            break;
+        }
         default: {
             fprintf(stderr, "(EE) This should never happen.\n");
             exit(-1);
@@ -574,6 +1498,14 @@ video_writer_t* video_writer_alloc_init(const char* path, const size_t start, co
             exit(-1);
 #endif
         }
+        case VCDC_LIBAV: {
+            fprintf(stderr, "(EE) libav is not supported yet for video writer.\n");
+            exit(-1);
+        }
+        case VCDC_YUV_MMAP: {
+            fprintf(stderr, "(EE) 'YUV-MMAP' is only a video reader.\n");
+            exit(-1);
+        }
         default: {
             fprintf(stderr, "(EE) This should never happen.\n");
             exit(-1);
@@ -601,6 +1533,14 @@ void video_writer_save_frame(video_writer_t* video, const uint8_t** img) {
             exit(-1);
 #endif
         }
+        case VCDC_LIBAV: {
+            fprintf(stderr, "(EE) libav is not supported yet for video writer.\n");
+            exit(-1);
+        }
+        case VCDC_YUV_MMAP: {
+            fprintf(stderr, "(EE) 'YUV-MMAP' is only a video reader.\n");
+            exit(-1);
+        }
         default: {
             fprintf(stderr, "(EE) This should never happen.\n");
             exit(-1);
@@ -628,6 +1568,14 @@ void video_writer_free(video_writer_t* video) {
             exit(-1);
 #endif
         }
+        case VCDC_LIBAV: {
+            fprintf(stderr, "(EE) libav is not supported yet for video writer.\n");
+            exit(-1);
+        }
+        case VCDC_YUV_MMAP: {
+            fprintf(stderr, "(EE) 'YUV-MMAP' is only a video reader.\n");
+            exit(-1);
+        }
         default: {
             fprintf(stderr, "(EE) This should never happen.\n");
             exit(-1);
@@ -14,6 +14,18 @@ enum video_codec_e video_str_to_enum(const char* str) {
         fprintf(stderr, "(EE) '%s()' failed, 'VCODECS-IO' implementation requires to link with the vcodecs-io library.\n",
             __func__);
         exit(-1);
+#endif
+    } else if (strcmp(str, "YUV-MMAP") == 0) {
+        return VCDC_YUV_MMAP;
+    } else if (strcmp(str, "SYNTH") == 0) {
+        return VCDC_SYNTH;
+    } else if (strcmp(str, "LIBAV") == 0) {
+#ifdef MOTION_USE_LIBAV
+        return VCDC_LIBAV;
+#else
+        fprintf(stderr, "(EE) '%s()' failed, 'LIBAV' implementation requires to link with the libav libraries.\n",
+            __func__);
+        exit(-1);
 #endif
     } else {
         fprintf(stderr, "(EE) '%s()' failed, unknow input ('%s').\n", __func__, str);
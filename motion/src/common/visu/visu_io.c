@@ -27,11 +27,11 @@ visu_data_t* visu_alloc_init(const char* path, const size_t start, const size_t
     visu->buff_id_write = 0;
     visu->n_filled_buff = 0;
     visu->I = (uint8_t***)malloc(visu->buff_size * sizeof(uint8_t**));
-    visu->RoIs = (RoI_t**)malloc(visu->buff_size * sizeof(RoI_t**));
+    visu->RoIs = (RoI_t**)malloc(visu->buff_size * sizeof(RoI_t*));
     visu->frame_ids = (uint32_t*)malloc(visu->buff_size * sizeof(uint32_t));
     for (size_t i = 0; i < visu->buff_size; i++) {
         visu->I[i] = ui8matrix(0, visu->img_height + 1, 0, visu->img_width + 1);
-        visu->RoIs[i] = features_alloc_RoIs(max_RoIs_size);
+        visu->RoIs[i] = (RoI_t*)malloc(max_RoIs_size * sizeof(RoI_t));
     }
     visu->img_data = image_color_alloc(img_height, img_width);
     visu->BBs = (vec_BB_t)vector_create();
@@ -99,7 +99,7 @@ void _visu_write_or_play(visu_data_t* visu, const vec_track_t tracks) {
     video_writer_save_frame(visu->video_writer, (const uint8_t**)image_color_get_pixels_2d(visu->img_data));
 }
 
-void visu_display(visu_data_t* visu, const uint8_t** img, const RoI_t* RoIs, const size_t n_RoIs,
+void visu_display(visu_data_t* visu, const uint8_t** img, const RoIs_t* RoIs, const size_t n_RoIs,
                   const vec_track_t tracks, const uint32_t frame_id) {
     // ------------------------
     // write or play image ----
@@ -119,7 +119,9 @@ void visu_display(visu_data_t* visu, const uint8_t** img, const RoI_t* RoIs, con
     const size_t real_buff_id_write = visu->buff_id_write % visu->buff_size;
     for (size_t i = 0; i < visu->img_height; i++)
         memcpy(visu->I[real_buff_id_write][i], img[i], visu->img_width * sizeof(uint8_t));
-    memcpy(visu->RoIs[real_buff_id_write], RoIs, n_RoIs * sizeof(RoI_t));
+    // the RoIs are bufferized in the AoS layout
+    for (size_t i = 0; i < n_RoIs; i++)
+        visu->RoIs[real_buff_id_write][i] = features_get_RoI(RoIs, i);
     visu->frame_ids[real_buff_id_write] = frame_id;
 
     visu->n_filled_buff++;
@@ -139,7 +141,7 @@ void visu_free(visu_data_t* visu) {
     video_writer_free(visu->video_writer);
     for (size_t i = 0; i < visu->buff_size; i++) {
         free_ui8matrix(visu->I[i], 0, visu->img_height + 1, 0, visu->img_width + 1);
-        features_free_RoIs(visu->RoIs[i]);
+        free(visu->RoIs[i]);
     }
     free(visu->I);
     free(visu->RoIs);
@@ -4,6 +4,11 @@
 #include <stdint.h>
 #include <nrc2.h>
 #include <math.h>
+#include <string.h>
+#include <pthread.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "vec.h"
 
@@ -21,6 +26,353 @@
 #include "motion/sigma_delta.h"
 #include "motion/morpho.h"
 #include "motion/visu.h"
+#include "motion/pipeline.h"
+#include "motion/stats.h"
+
+/**
+ * Connected-components labeling and analysis of the binary image (CCL + CCA).
+ * @param ccl_data CCL data.
+ * @param IB Binary image (1 byte per pixel), used if \p IB_packed is NULL.
+ * @param IB_packed Packed binary image (1 bit per pixel), can be NULL.
+ * @param RoIs Output features.
+ * @param par Boolean, use the parallel CCL.
+ * @return Number of labels (= number of RoIs).
+ */
+static uint32_t CCL_CCA_apply(CCL_data_t* ccl_data, const uint8_t** IB, const uint64_t** IB_packed, RoIs_t* RoIs,
+                              const int par) {
+    if (IB_packed)
+        return CCL_LSL_apply_packed_features(ccl_data, IB_packed, NULL, RoIs, par);
+    return CCL_LSL_apply_features(ccl_data, IB, NULL, RoIs, par);
+}
+
+/**
+ *  Data shared by the stages of the pipelined execution (`--pipeline`). Each stage thread is the only one to access the
+ *  processing data and the time accumulator it owns, frame slots are exchanged through the queues.
+ */
+typedef struct {
+    video_reader_t* video; /**< Video reader (owned by the decoding stage). */
+    sigma_delta_data_t* sd_data; /**< Sigma-Delta data (owned by the Sigma-Delta + morphology stage). */
+    morpho_data_t* morpho_data; /**< Morphology data (owned by the Sigma-Delta + morphology stage). */
+    CCL_data_t* ccl_data; /**< CCL data (owned by the CCL + CCA + filtering stage). */
+    RoIs_t* RoIs_tmp; /**< RoIs before filtering (owned by the CCL + CCA + filtering stage). */
+    uint32_t* remap; /**< Labels remap table of the surface filtering (owned by the CCL + CCA + filtering stage). */
+    pipeline_slot_t* slots; /**< Frame slots. */
+    pipeline_queue_t* q_free; /**< Slots ready to receive a new frame. */
+    pipeline_queue_t* q_sd; /**< Slots with a decoded frame. */
+    pipeline_queue_t* q_ccl; /**< Slots with a binary image. */
+    pipeline_queue_t* q_trk; /**< Slots with the filtered RoIs. */
+    int i0, i1, j0, j1; /**< Images dimension. */
+    int sd_n; /**< Sigma-Delta N parameter. */
+    int morpho_packed; /**< Boolean, the binary image is packed (1 bit per pixel). */
+    int ccl_par; /**< Boolean, use the parallel CCL. */
+    int cca_roi_max1; /**< Maximum number of RoIs after CCA. */
+    int cca_roi_max2; /**< Maximum number of RoIs after surface filtering. */
+    int flt_s_min; /**< Minimum surface of the CCs. */
+    int flt_s_max; /**< Maximum surface of the CCs. */
+    double dec_us, sd_us, ccl_us, flt_us; /**< Accumulated latencies of the steps (in us). */
+    stats_hist_t *dec_hist, *sd_hist, *ccl_hist, *flt_hist; /**< Latency histograms of the steps. */
+    int perf_counters; /**< Boolean, each stage records the hardware counters of its own thread. */
+} pipeline_stages_t;
+
+static void* pipeline_stage_decode(void* arg) {
+    pipeline_stages_t* st = (pipeline_stages_t*)arg;
+    stats_perf_t* perf = st->perf_counters ? stats_perf_alloc() : NULL;
+    size_t s;
+    while (pipeline_queue_pop(st->q_free, &s)) {
+        STATS_POINT(perf, dec_b);
+        const uint8_t** IG_view;
+        const int cur_fra = video_reader_get_frame_view(st->video, st->slots[s].IG, &IG_view);
+        STATS_POINT(perf, dec_e);
+        st->dec_us += TIME_ELAPSED2_US(dec_b, dec_e);
+        STATS_HIST_ADD(st->dec_hist, dec_b, dec_e);
+        if (cur_fra == -1)
+            break;
+        st->slots[s].IG_view = (const uint8_t**)st->slots[s].IG;
+        if (IG_view != st->slots[s].IG_view) {
+            // several frames are in flight: keep the rows of the view in the slot (the pixels stay in memory)
+            memcpy(st->slots[s].IG_rows + st->i0, IG_view + st->i0, (st->i1 - st->i0 + 1) * sizeof(const uint8_t*));
+            st->slots[s].IG_view = st->slots[s].IG_rows;
+        }
+        st->slots[s].frame = cur_fra;
+        pipeline_queue_push(st->q_sd, s);
+    }
+    pipeline_queue_close(st->q_sd);
+    stats_perf_free(perf);
+    return NULL;
+}
+
+static void* pipeline_stage_sigma_delta_morpho(void* arg) {
+    pipeline_stages_t* st = (pipeline_stages_t*)arg;
+    stats_perf_t* perf = st->perf_counters ? stats_perf_alloc() : NULL;
+    size_t s;
+    while (pipeline_queue_pop(st->q_sd, &s)) {
+        pipeline_slot_t* slot = &st->slots[s];
+        STATS_POINT(perf, sd_b);
+        if (st->morpho_packed) {
+            sigma_delta_compute_packed(st->sd_data, slot->IG_view, slot->IB_packed, st->i0, st->i1, st->j0,
+                                       st->j1, st->sd_n);
+            morpho_compute_opening_closing3_packed64(st->morpho_data, (const uint64_t**)slot->IB_packed,
+                                                     slot->IB_packed, st->i0, st->i1, st->j0, st->j1);
+        } else {
+            sigma_delta_morpho_fused(st->sd_data, slot->IG_view, slot->IB, st->morpho_data->IB,
+                                     st->morpho_data->IB2, st->i0, st->i1, st->j0, st->j1, st->sd_n);
+        }
+        STATS_POINT(perf, sd_e);
+        st->sd_us += TIME_ELAPSED2_US(sd_b, sd_e);
+        STATS_HIST_ADD(st->sd_hist, sd_b, sd_e);
+        pipeline_queue_push(st->q_ccl, s);
+    }
+    pipeline_queue_close(st->q_ccl);
+    stats_perf_free(perf);
+    return NULL;
+}
+
+static void* pipeline_stage_CCL_CCA(void* arg) {
+    pipeline_stages_t* st = (pipeline_stages_t*)arg;
+    stats_perf_t* perf = st->perf_counters ? stats_perf_alloc() : NULL;
+    size_t s;
+    while (pipeline_queue_pop(st->q_ccl, &s)) {
+        pipeline_slot_t* slot = &st->slots[s];
+        // CCL and CCA are fused (the labels image is only written from the segments after filtering, if needed)
+        STATS_POINT(perf, ccl_b);
+        const uint32_t n_RoIs_tmp = CCL_CCA_apply(st->ccl_data, (const uint8_t**)slot->IB,
+                                                  (const uint64_t**)slot->IB_packed, st->RoIs_tmp, st->ccl_par);
+        assert(n_RoIs_tmp <= (uint32_t)st->cca_roi_max1);
+        STATS_POINT(perf, ccl_e);
+        st->ccl_us += TIME_ELAPSED2_US(ccl_b, ccl_e);
+        STATS_HIST_ADD(st->ccl_hist, ccl_b, ccl_e);
+
+        STATS_POINT(perf, flt_b);
+        slot->n_RoIs = features_filter_surface_remap(st->RoIs_tmp, n_RoIs_tmp, st->flt_s_min, st->flt_s_max,
+                                                     st->remap);
+        assert(slot->n_RoIs <= (uint32_t)st->cca_roi_max2);
+        if (slot->L2)
+            CCL_LSL_write_labels(st->ccl_data, slot->L2, st->remap);
+        features_shrink_basic(st->RoIs_tmp, n_RoIs_tmp, slot->RoIs);
+        STATS_POINT(perf, flt_e);
+        st->flt_us += TIME_ELAPSED2_US(flt_b, flt_e);
+        STATS_HIST_ADD(st->flt_hist, flt_b, flt_e);
+        pipeline_queue_push(st->q_trk, s);
+    }
+    pipeline_queue_close(st->q_trk);
+    stats_perf_free(perf);
+    return NULL;
+}
+
+/**
+ *  Parameters of the detection chain shared by all the streams in batch mode.
+ */
+typedef struct {
+    int vid_in_start, vid_in_stop, vid_in_skip, vid_in_buff, vid_in_loop, vid_in_threads, vid_in_async;
+    const char* vid_in_dec;
+    const char* vid_in_dec_hw;
+    int sd_n;
+    int morpho_packed;
+    int ccl_par;
+    int cca_roi_max1, cca_roi_max2;
+    int flt_s_min, flt_s_max;
+    int knn_k, knn_d;
+    float knn_s;
+    int trk_ext_d, trk_ext_o, trk_obj_min;
+} batch_params_t;
+
+/**
+ *  Result of the processing of one stream in batch mode.
+ */
+typedef struct {
+    size_t n_processed_frames; /**< Number of frames processed in the stream. */
+    size_t n_tracks; /**< Number of detected tracks in the stream. */
+    double time_sec; /**< Processing time of the stream (allocations excluded). */
+    char error[256]; /**< Empty if the stream has been processed, otherwise the reason why it has been skipped. */
+} batch_result_t;
+
+/**
+ * Run a full and independent instance of the detection chain over one stream and write its tracks into a file. This
+ * function is called from a parallel loop: it does not exit on the errors of the stream, `res->error` is set and the
+ * stream is skipped.
+ * @param p Chain parameters.
+ * @param vid_in_path Path to the input video (or images sequence).
+ * @param trk_out_path Path of the file where the tracks are written.
+ * @param res Return the processing statistics of the stream.
+ */
+static void batch_process_stream(const batch_params_t* p, const char* vid_in_path, const char* trk_out_path,
+                                 batch_result_t* res) {
+    res->error[0] = '\0';
+    // the readers exit when a file can't be opened: check it first (the images sequences ('%') and the URLs are
+    // left to the reader)
+    if (!strstr(vid_in_path, "://") && !strchr(vid_in_path, '%')) {
+        FILE* f_in = fopen(vid_in_path, "rb");
+        if (f_in == NULL) {
+            snprintf(res->error, sizeof(res->error), "'%s' can't be opened", vid_in_path);
+            return;
+        }
+        fclose(f_in);
+    }
+
+    int i0, i1, j0, j1;
+    video_reader_t* video = video_reader_alloc_init(vid_in_path, p->vid_in_start, p->vid_in_stop, p->vid_in_skip,
+                                                    p->vid_in_buff, p->vid_in_threads, video_str_to_enum(p->vid_in_dec),
+                                                    video_hwaccel_str_to_enum(p->vid_in_dec_hw), &i0, &i1, &j0, &j1);
+    video->loop_size = (size_t)(p->vid_in_loop);
+    if (p->vid_in_async)
+        video_reader_prefetch_start(video, p->vid_in_async, i0, i1, j0, j1);
+
+    uint8_t **IG = ui8matrix(i0, i1, j0, j1);
+    if (video_reader_get_frame(video, IG) == -1) {
+        snprintf(res->error, sizeof(res->error), "no frame can be read from '%s'", vid_in_path);
+        free_ui8matrix(IG, i0, i1, j0, j1);
+        video_reader_free(video);
+        return;
+    }
+    FILE* f = fopen(trk_out_path, "w");
+    if (f == NULL) {
+        snprintf(res->error, sizeof(res->error), "'%s' can't be opened", trk_out_path);
+        free_ui8matrix(IG, i0, i1, j0, j1);
+        video_reader_free(video);
+        return;
+    }
+
+    sigma_delta_data_t* sd_data = sigma_delta_alloc_data(i0, i1, j0, j1, 1, 254);
+    morpho_data_t* morpho_data = morpho_alloc_data(i0, i1, j0, j1);
+    CCL_data_t* ccl_data = CCL_LSL_alloc_data(i0, i1, j0, j1);
+    RoIs_t* RoIs_tmp = features_alloc_RoIs(p->cca_roi_max1);
+    RoIs_t* RoIs0 = features_alloc_RoIs(p->cca_roi_max2);
+    RoIs_t* RoIs1 = features_alloc_RoIs(p->cca_roi_max2);
+    kNN_data_t* knn_data = kNN_alloc_data(p->cca_roi_max2);
+    tracking_data_t* tracking_data = tracking_alloc_data(MAX(p->trk_obj_min, p->trk_ext_o) + 1, p->cca_roi_max2);
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    uint8_t **IB = p->morpho_packed ? NULL : ui8matrix(i0, i1, j0, j1);
+    uint64_t **IB_packed = p->morpho_packed ? (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1) : NULL;
+
+    sigma_delta_init_data(sd_data, (const uint8_t**)IG, i0, i1, j0, j1);
+    if (p->morpho_packed)
+        zero_ui64matrix((uint64**)IB_packed, i0, i1, 0, n_words - 1);
+    else
+        zero_ui8matrix(IB, i0, i1, j0, j1);
+    morpho_init_data(morpho_data);
+    CCL_LSL_init_data(ccl_data);
+    features_init_RoIs(RoIs_tmp);
+    features_init_RoIs(RoIs0);
+    features_init_RoIs(RoIs1);
+    kNN_init_data(knn_data);
+    tracking_init_data(tracking_data);
+
+    size_t n_processed_frames = 0;
+    uint32_t n_RoIs0 = 0;
+    const uint8_t** IG_t; // grayscale image at t (a view on the frames buffer when `vid_in_buff` is set)
+    int cur_fra;
+    TIME_POINT(start_compute);
+    while ((cur_fra = video_reader_get_frame_view(video, IG, &IG_t)) != -1) {
+        if (p->morpho_packed) {
+            sigma_delta_compute_packed(sd_data, IG_t, IB_packed, i0, i1, j0, j1, p->sd_n);
+            morpho_compute_opening_closing3_packed64(morpho_data, (const uint64_t**)IB_packed, IB_packed,
+                                                     i0, i1, j0, j1);
+        } else {
+            sigma_delta_morpho_fused(sd_data, IG_t, IB, morpho_data->IB, morpho_data->IB2, i0, i1, j0, j1, p->sd_n);
+        }
+        const uint32_t n_RoIs_tmp = CCL_CCA_apply(ccl_data, (const uint8_t**)IB, (const uint64_t**)IB_packed,
+                                                  RoIs_tmp, p->ccl_par);
+        assert(n_RoIs_tmp <= (uint32_t)p->cca_roi_max1);
+        const uint32_t n_RoIs1 = features_filter_surface(NULL, NULL, i0, i1, j0, j1, RoIs_tmp, n_RoIs_tmp,
+                                                         p->flt_s_min, p->flt_s_max);
+        assert(n_RoIs1 <= (uint32_t)p->cca_roi_max2);
+        features_shrink_basic(RoIs_tmp, n_RoIs_tmp, RoIs1);
+        kNN_match(knn_data, RoIs0, n_RoIs0, RoIs1, n_RoIs1, p->knn_k, p->knn_d, p->knn_s);
+        tracking_perform(tracking_data, RoIs1, n_RoIs1, cur_fra, p->trk_ext_d, p->trk_obj_min, 0, p->trk_ext_o,
+                         p->knn_s);
+
+        RoIs_t* tmp_RoIs = RoIs0;
+        RoIs0 = RoIs1;
+        RoIs1 = tmp_RoIs;
+        n_RoIs0 = n_RoIs1;
+        n_processed_frames++;
+    }
+    TIME_POINT(stop_compute);
+
+    res->n_processed_frames = n_processed_frames;
+    res->n_tracks = tracking_count_objects(tracking_data->tracks);
+    res->time_sec = TIME_ELAPSED2_SEC(start_compute, stop_compute);
+
+    fprintf(f, "# Input video: %s\n", vid_in_path);
+    tracking_tracks_write(f, tracking_data->tracks);
+    fprintf(f, "# Tracks statistics:\n");
+    fprintf(f, "# -> Processed frames = %4u\n", (unsigned)res->n_processed_frames);
+    fprintf(f, "# -> Detected tracks  = %4lu\n", (unsigned long)res->n_tracks);
+    fclose(f);
+
+    sigma_delta_free_data(sd_data);
+    morpho_free_data(morpho_data);
+    free_ui8matrix(IG, i0, i1, j0, j1);
+    if (IB)
+        free_ui8matrix(IB, i0, i1, j0, j1);
+    if (IB_packed)
+        free_ui64matrix((uint64**)IB_packed, i0, i1, 0, n_words - 1);
+    features_free_RoIs(RoIs_tmp);
+    features_free_RoIs(RoIs0);
+    features_free_RoIs(RoIs1);
+    video_reader_free(video);
+    CCL_LSL_free_data(ccl_data);
+    kNN_free_data(knn_data);
+    tracking_free_data(tracking_data);
+}
+
+/**
+ * Build the list of input streams from a comma-separated list of paths and/or from a manifest file (one path per
+ * line, empty lines and lines starting with '#' are skipped).
+ * @param vid_in_path Comma-separated list of paths (can be NULL).
+ * @param vid_in_list Path to the manifest file (can be NULL).
+ * @param n_paths Return the number of paths.
+ * @return Array of paths (to free with `free` as well as each path).
+ */
+static char** batch_get_paths(const char* vid_in_path, const char* vid_in_list, size_t* n_paths) {
+    size_t max_paths = 16;
+    char** paths = (char**)malloc(max_paths * sizeof(char*));
+    *n_paths = 0;
+    if (vid_in_path) {
+        const char* cur = vid_in_path;
+        while (1) {
+            const char* end = strchr(cur, ',');
+            size_t len = end ? (size_t)(end - cur) : strlen(cur);
+            if (len) {
+                if (*n_paths == max_paths) {
+                    max_paths *= 2;
+                    paths = (char**)realloc(paths, max_paths * sizeof(char*));
+                }
+                paths[*n_paths] = (char*)malloc(len + 1);
+                memcpy(paths[*n_paths], cur, len);
+                paths[*n_paths][len] = '\0';
+                (*n_paths)++;
+            }
+            if (!end)
+                break;
+            cur = end + 1;
+        }
+    }
+    if (vid_in_list) {
+        FILE* f = fopen(vid_in_list, "r");
+        if (f == NULL) {
+            fprintf(stderr, "(EE) error while opening '%s'\n", vid_in_list);
+            exit(1);
+        }
+        char line[2048];
+        while (fgets(line, sizeof(line), f)) {
+            size_t len = strlen(line);
+            while (len && (line[len - 1] == '\n' || line[len - 1] == '\r' || line[len - 1] == ' '))
+                line[--len] = '\0';
+            if (!len || line[0] == '#')
+                continue;
+            if (*n_paths == max_paths) {
+                max_paths *= 2;
+                paths = (char**)realloc(paths, max_paths * sizeof(char*));
+            }
+            paths[*n_paths] = (char*)malloc(len + 1);
+            memcpy(paths[*n_paths], line, len + 1);
+            (*n_paths)++;
+        }
+        fclose(f);
+    }
+    return paths;
+}
 
 int main(int argc, char** argv) {
 
@@ -29,13 +381,17 @@ int main(int argc, char** argv) {
     // ---------------------------------- //
 
     char* def_p_vid_in_path = NULL;
+    char* def_p_vid_in_list = NULL;
     int def_p_vid_in_start = 0;
     int def_p_vid_in_stop = 0;
     int def_p_vid_in_skip = 0;
     int def_p_vid_in_loop = 1;
     int def_p_vid_in_threads = 0;
+    int def_p_vid_in_async = 0;
+    char def_p_vid_in_dec[16] = "FFMPEG-IO";
     char def_p_vid_in_dec_hw[16] = "NONE";
     int def_p_sd_n = 2;
+    char def_p_sd_isa[16] = "AUTO";
     char* def_p_ccl_fra_path = NULL;
     int def_p_flt_s_min = 50;
     int def_p_flt_s_max = 100000;
@@ -46,10 +402,15 @@ int main(int argc, char** argv) {
     int def_p_trk_ext_o = 3;
     int def_p_trk_obj_min = 2;
     char* def_p_trk_roi_path = NULL;
+    char* def_p_trk_out_path = NULL;
     char* def_p_log_path = NULL;
     int def_p_cca_roi_max1 = 65536; // Maximum number of RoIs
     int def_p_cca_roi_max2 = 8192; // Maximum number of RoIs after filtering
     char* def_p_vid_out_path = NULL;
+    char* def_p_stats_path = NULL;
+    int def_p_pipeline_slots = 4;
+    char def_p_batch_out_path[16] = "batch";
+    int def_p_batch_threads = 0;
 
     // ------------------------ //
     // -- CMD LINE ARGS HELP -- //
@@ -57,8 +418,11 @@ int main(int argc, char** argv) {
 
     if (args_find(argc, argv, "--help,-h")) {
         fprintf(stderr,
-                "  --vid-in-path     Path to video file or to an images sequence                            [%s]\n",
+                "  --vid-in-path     Video(s), images sequence(s) or 'synth://' scene(s), ','-separated     [%s]\n",
                 def_p_vid_in_path ? def_p_vid_in_path : "NULL");
+        fprintf(stderr,
+                "  --vid-in-list     Path to a manifest file listing input videos (one per line, batch)     [%s]\n",
+                def_p_vid_in_list ? def_p_vid_in_list : "NULL");
         fprintf(stderr,
                 "  --vid-in-start    Start frame id (included) in the video                                 [%d]\n",
                 def_p_vid_in_start);
@@ -76,15 +440,28 @@ int main(int argc, char** argv) {
         fprintf(stderr,
                 "  --vid-in-threads  Select the number of threads to use to decode video input (in ffmpeg)  [%d]\n",
                 def_p_vid_in_threads);
+        fprintf(stderr,
+                "  --vid-in-async    Number of frames read in advance by a dedicated I/O thread (0 = off)   [%d]\n",
+                def_p_vid_in_async);
+        fprintf(stderr,
+                "  --vid-in-dec      Video decoder ('FFMPEG-IO', 'YUV-MMAP' or 'LIBAV' (experimental))      [%s]\n",
+                def_p_vid_in_dec);
         fprintf(stderr,
                 "  --vid-in-dec-hw   Select video decoder hardware acceleration ('NONE', 'NVDEC', 'VIDTB')  [%s]\n",
                 def_p_vid_in_dec_hw);
         fprintf(stderr,
                 "  --sd-n            Value of the N parameter in the Sigma-Delta algorithm                  [%d]\n",
                 def_p_sd_n);
+        fprintf(stderr,
+                "  --sd-isa          Sigma-Delta SIMD ('AUTO', 'SCALAR', 'MIPP', 'AVX2', 'AVX512BW')        [%s]\n",
+                def_p_sd_isa);
+        fprintf(stderr,
+                "  --morpho-packed   Sigma-Delta, morphology and CCL on a 1-bit per pixel binary image          \n");
         fprintf(stderr,
                 "  --ccl-fra-path    Path of the files for CC debug frames                                  [%s]\n",
                 def_p_ccl_fra_path ? def_p_ccl_fra_path : "NULL");
+        fprintf(stderr,
+                "  --ccl-par         Parallel connected-components labeling (bands + merge of the borders)      \n");
 #ifdef MOTION_OPENCV_LINK
         fprintf(stderr,
                 "  --ccl-fra-id      Show the RoI/CC ids on the ouptut CC frames                                \n");
@@ -122,6 +499,9 @@ int main(int argc, char** argv) {
         fprintf(stderr,
                 "  --trk-roi-path    Path to the file containing the RoI ids for each track                 [%s]\n",
                 def_p_trk_roi_path ? def_p_trk_roi_path : "NULL");
+        fprintf(stderr,
+                "  --trk-out-path    Path of the file where the tracks are streamed (bounded memory)        [%s]\n",
+                def_p_trk_out_path ? def_p_trk_out_path : "NULL");
         fprintf(stderr,
                 "  --log-path        Path of the output statistics, only required for debugging purpose     [%s]\n",
                 def_p_log_path ? def_p_log_path : "NULL");
@@ -135,7 +515,23 @@ int main(int argc, char** argv) {
                 "  --vid-out-id      Draw the track ids on the ouptut video                                     \n");
 #endif
         fprintf(stderr,
-                "  --stats           Show the average latency of each task                                      \n");
+                "  --stats           Show the latency distribution (mean and percentiles) of each task          \n");
+        fprintf(stderr,
+                "  --stats-path      File of the latency distributions (JSON if '.json', CSV otherwise)     [%s]\n",
+                def_p_stats_path ? def_p_stats_path : "NULL");
+        fprintf(stderr,
+                "  --perf-counters   Count cycles, instructions, cache and branch misses of each task           \n");
+        fprintf(stderr,
+                "  --pipeline        Run decoding, SD+morpho, CCL+CCA and k-NN+tracking as pipelined threads    \n");
+        fprintf(stderr,
+                "  --pipeline-slots  Number of frames in flight in the pipeline (with '--pipeline')         [%d]\n",
+                def_p_pipeline_slots);
+        fprintf(stderr,
+                "  --batch-out-path  Folder of the per-stream tracks files (batch mode)                     [%s]\n",
+                def_p_batch_out_path);
+        fprintf(stderr,
+                "  --batch-threads   Number of streams processed concurrently, 0 = all the cores (batch)    [%d]\n",
+                def_p_batch_threads);
         fprintf(stderr,
                 "  --help, -h        This help                                                                  \n");
         exit(1);
@@ -146,15 +542,21 @@ int main(int argc, char** argv) {
     // ------------------------- //
 
     const char* p_vid_in_path = args_find_char(argc, argv, "--vid-in-path", def_p_vid_in_path);
+    const char* p_vid_in_list = args_find_char(argc, argv, "--vid-in-list", def_p_vid_in_list);
     const int p_vid_in_start = args_find_int_min(argc, argv, "--vid-in-start", def_p_vid_in_start, 0);
     const int p_vid_in_stop = args_find_int_min(argc, argv, "--vid-in-stop", def_p_vid_in_stop, 0);
     const int p_vid_in_skip = args_find_int_min(argc, argv, "--vid-in-skip", def_p_vid_in_skip, 0);
     const int p_vid_in_buff = args_find(argc, argv, "--vid-in-buff");
     const int p_vid_in_loop = args_find_int_min(argc, argv, "--vid-in-loop", def_p_vid_in_loop, 1);
     const int p_vid_in_threads = args_find_int_min(argc, argv, "--vid-in-threads", def_p_vid_in_threads, 0);
+    const int p_vid_in_async = args_find_int_min(argc, argv, "--vid-in-async", def_p_vid_in_async, 0);
+    const char* p_vid_in_dec = args_find_char(argc, argv, "--vid-in-dec", def_p_vid_in_dec);
     const char* p_vid_in_dec_hw = args_find_char(argc, argv, "--vid-in-dec-hw", def_p_vid_in_dec_hw);
     const int p_sd_n = args_find_int_min(argc, argv, "--sd-n", def_p_sd_n, 0);
+    const char* p_sd_isa = args_find_char(argc, argv, "--sd-isa", def_p_sd_isa);
+    const int p_morpho_packed = args_find(argc, argv, "--morpho-packed");
     const char* p_ccl_fra_path = args_find_char(argc, argv, "--ccl-fra-path", def_p_ccl_fra_path);
+    const int p_ccl_par = args_find(argc, argv, "--ccl-par");
 #ifdef MOTION_OPENCV_LINK
     const int p_ccl_fra_id = args_find(argc, argv, "--ccl-fra-id,--show-id");
 #else
@@ -171,6 +573,7 @@ int main(int argc, char** argv) {
     const int p_trk_ext_o = args_find_int_min_max(argc, argv, "--trk-ext-o", def_p_trk_ext_o, 0, 255);
     const int p_trk_obj_min = args_find_int_min(argc, argv, "--trk-obj-min", def_p_trk_obj_min, 2);
     const char* p_trk_roi_path = args_find_char(argc, argv, "--trk-roi-path", def_p_trk_roi_path);
+    const char* p_trk_out_path = args_find_char(argc, argv, "--trk-out-path", def_p_trk_out_path);
     const char* p_log_path = args_find_char(argc, argv, "--log-path", def_p_log_path);
     const char* p_vid_out_path = args_find_char(argc, argv, "--vid-out-path", def_p_vid_out_path);
     const int p_vid_out_play = args_find(argc, argv, "--vid-out-play");
@@ -180,6 +583,12 @@ int main(int argc, char** argv) {
     const int p_vid_out_id = 0;
 #endif
     const int p_stats = args_find(argc, argv, "--stats");
+    const char* p_stats_path = args_find_char(argc, argv, "--stats-path", def_p_stats_path);
+    const int p_perf_counters = args_find(argc, argv, "--perf-counters");
+    const int p_pipeline = args_find(argc, argv, "--pipeline");
+    const int p_pipeline_slots = args_find_int_min(argc, argv, "--pipeline-slots", def_p_pipeline_slots, 1);
+    const char* p_batch_out_path = args_find_char(argc, argv, "--batch-out-path", def_p_batch_out_path);
+    const int p_batch_threads = args_find_int_min(argc, argv, "--batch-threads", def_p_batch_threads, 0);
 
     // --------------------- //
     // -- HEADING DISPLAY -- //
@@ -192,15 +601,21 @@ int main(int argc, char** argv) {
     printf("# Parameters:\n");
     printf("# -----------\n");
     printf("#  * vid-in-path    = %s\n", p_vid_in_path);
+    printf("#  * vid-in-list    = %s\n", p_vid_in_list);
     printf("#  * vid-in-start   = %d\n", p_vid_in_start);
     printf("#  * vid-in-stop    = %d\n", p_vid_in_stop);
     printf("#  * vid-in-skip    = %d\n", p_vid_in_skip);
     printf("#  * vid-in-buff    = %d\n", p_vid_in_buff);
     printf("#  * vid-in-loop    = %d\n", p_vid_in_loop);
     printf("#  * vid-in-threads = %d\n", p_vid_in_threads);
+    printf("#  * vid-in-async   = %d\n", p_vid_in_async);
+    printf("#  * vid-in-dec     = %s\n", p_vid_in_dec);
     printf("#  * vid-in-dec-hw  = %s\n", p_vid_in_dec_hw);
     printf("#  * sd-n           = %d\n", p_sd_n);
+    printf("#  * sd-isa         = %s\n", p_sd_isa);
+    printf("#  * morpho-packed  = %d\n", p_morpho_packed);
     printf("#  * ccl-fra-path   = %s\n", p_ccl_fra_path);
+    printf("#  * ccl-par        = %d\n", p_ccl_par);
 #ifdef MOTION_OPENCV_LINK
     printf("#  * ccl-fra-id     = %d\n", p_ccl_fra_id);
 #endif
@@ -215,6 +630,7 @@ int main(int argc, char** argv) {
     printf("#  * trk-ext-o      = %d\n", p_trk_ext_o);
     printf("#  * trk-obj-min    = %d\n", p_trk_obj_min);
     printf("#  * trk-roi-path   = %s\n", p_trk_roi_path);
+    printf("#  * trk-out-path   = %s\n", p_trk_out_path);
     printf("#  * log-path       = %s\n", p_log_path);
     printf("#  * vid-out-path   = %s\n", p_vid_out_path);
     printf("#  * vid-out-play   = %d\n", p_vid_out_play);
@@ -222,6 +638,12 @@ int main(int argc, char** argv) {
     printf("#  * vid-out-id     = %d\n", p_vid_out_id);
 #endif
     printf("#  * stats          = %d\n", p_stats);
+    printf("#  * stats-path     = %s\n", p_stats_path);
+    printf("#  * perf-counters  = %d\n", p_perf_counters);
+    printf("#  * pipeline       = %d\n", p_pipeline);
+    printf("#  * pipeline-slots = %d\n", p_pipeline_slots);
+    printf("#  * batch-out-path = %s\n", p_batch_out_path);
+    printf("#  * batch-threads  = %d\n", p_batch_threads);
 
     printf("#\n");
 
@@ -229,7 +651,7 @@ int main(int argc, char** argv) {
     // -- CMD LINE ARGS CHECKS -- //
     // -------------------------- //
 
-    if (!p_vid_in_path) {
+    if (!p_vid_in_path && !p_vid_in_list) {
         fprintf(stderr, "(EE) '--vid-in-path' is missing\n");
         exit(1);
     }
@@ -237,18 +659,150 @@ int main(int argc, char** argv) {
         fprintf(stderr, "(EE) '--vid-in-stop' has to be higher than '--vid-in-start'\n");
         exit(1);
     }
+    if (p_vid_in_async && p_vid_in_buff)
+        fprintf(stderr, "(WW) '--vid-in-async' will be ignored because '--vid-in-buff' is set\n");
+    if (p_vid_in_async && p_pipeline)
+        fprintf(stderr, "(WW) '--vid-in-async' will be ignored because '--pipeline' is set (the decoding is already "
+                        "performed by a dedicated stage)\n");
 #ifdef MOTION_OPENCV_LINK
     if (p_ccl_fra_id && !p_ccl_fra_path)
         fprintf(stderr, "(WW) '--ccl-fra-id' has to be combined with the '--ccl-fra-path' parameter\n");
 #endif
     if (p_vid_out_path && p_vid_out_play)
         fprintf(stderr, "(WW) '--vid-out-path' will be ignore because '--vid-out-play' is set\n");
+    if (p_trk_out_path && (p_trk_roi_path || p_vid_out_path || p_vid_out_play)) {
+        fprintf(stderr, "(EE) '--trk-out-path' can't be combined with '--trk-roi-path', '--vid-out-path' or "
+                        "'--vid-out-play' (the finished tracks are not kept in memory)\n");
+        exit(1);
+    }
+#ifdef _OPENMP
+    if (p_perf_counters && omp_get_max_threads() > 1)
+        fprintf(stderr, "(WW) '--perf-counters' does not count the events of the OpenMP threads (the tasks run on %d "
+                        "threads, set 'OMP_NUM_THREADS=1' to count all the events)\n", omp_get_max_threads());
+#endif
 #ifdef MOTION_OPENCV_LINK
     if (p_vid_out_id && !p_vid_out_path && !p_vid_out_play)
         fprintf(stderr,
                 "(WW) '--vid-out-id' will be ignore because neither '--vid-out-play' nor 'p_vid_out_path' are set\n");
 #endif
 
+    // the Sigma-Delta kernels are selected once, before any processing thread is started
+    sigma_delta_select_isa(sigma_delta_str_to_isa(p_sd_isa));
+
+    // ---------------- //
+    // -- BATCH MODE -- //
+    // ---------------- //
+
+    size_t n_streams;
+    char** streams_path = batch_get_paths(p_vid_in_path, p_vid_in_list, &n_streams);
+    if (n_streams == 0) {
+        fprintf(stderr, "(EE) No input video has been found\n");
+        exit(1);
+    }
+    if (n_streams > 1 || p_vid_in_list) {
+        if (p_ccl_fra_path || p_trk_roi_path || p_trk_out_path || p_log_path || p_vid_out_path || p_vid_out_play ||
+            p_pipeline || p_stats || p_stats_path || p_perf_counters)
+            fprintf(stderr, "(WW) '--ccl-fra-path', '--trk-roi-path', '--trk-out-path', '--log-path', "
+                            "'--vid-out-path', '--vid-out-play', '--pipeline', '--stats', '--stats-path' and "
+                            "'--perf-counters' are ignored in batch mode\n");
+
+        batch_params_t batch_params;
+        batch_params.vid_in_start = p_vid_in_start;
+        batch_params.vid_in_stop = p_vid_in_stop;
+        batch_params.vid_in_skip = p_vid_in_skip;
+        batch_params.vid_in_buff = p_vid_in_buff;
+        batch_params.vid_in_loop = p_vid_in_loop;
+        batch_params.vid_in_threads = p_vid_in_threads;
+        batch_params.vid_in_async = p_vid_in_async;
+        batch_params.vid_in_dec = p_vid_in_dec;
+        batch_params.vid_in_dec_hw = p_vid_in_dec_hw;
+        batch_params.sd_n = p_sd_n;
+        batch_params.morpho_packed = p_morpho_packed;
+        batch_params.ccl_par = p_ccl_par;
+        batch_params.cca_roi_max1 = p_cca_roi_max1;
+        batch_params.cca_roi_max2 = p_cca_roi_max2;
+        batch_params.flt_s_min = p_flt_s_min;
+        batch_params.flt_s_max = p_flt_s_max;
+        batch_params.knn_k = p_knn_k;
+        batch_params.knn_d = p_knn_d;
+        batch_params.knn_s = p_knn_s;
+        batch_params.trk_ext_d = p_trk_ext_d;
+        batch_params.trk_ext_o = p_trk_ext_o;
+        batch_params.trk_obj_min = p_trk_obj_min;
+
+        tools_create_folder(p_batch_out_path);
+        batch_result_t* results = (batch_result_t*)calloc(n_streams, sizeof(batch_result_t));
+
+        printf("# Batch mode: %lu streams\n", (unsigned long)n_streams);
+#ifdef _OPENMP
+        const int n_batch_threads = p_batch_threads ? p_batch_threads : omp_get_max_threads();
+        printf("# -> %d stream(s) processed concurrently, the kernels of each stream are single-threaded\n",
+               n_batch_threads);
+#endif
+        printf("# The program is running...\n");
+        TIME_POINT(start_batch);
+        // one independent chain per stream, the streams are dynamically distributed over a single pool of threads
+        // (the OpenMP regions of the kernels are nested and then executed by the stream thread only)
+#ifdef _OPENMP
+        const int max_active_levels = omp_get_max_active_levels();
+        omp_set_max_active_levels(1);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_batch_threads)
+#endif
+        for (size_t s = 0; s < n_streams; s++) {
+            char trk_out_path[2048];
+            const char* base_name = strrchr(streams_path[s], '/');
+            base_name = base_name ? base_name + 1 : streams_path[s];
+            int n = snprintf(trk_out_path, sizeof(trk_out_path), "%s/%04lu_", p_batch_out_path, (unsigned long)s);
+            n = MIN(n, (int)sizeof(trk_out_path) - 1);
+            snprintf(trk_out_path + n, sizeof(trk_out_path) - n, "%s.txt", base_name);
+            // only [A-Za-z0-9._-] in the file name (the 'synth://' paths come with a query: '?', '&', '=')
+            for (char* c = trk_out_path + n; *c; c++)
+                if (!(*c >= 'a' && *c <= 'z') && !(*c >= 'A' && *c <= 'Z') && !(*c >= '0' && *c <= '9') &&
+                    *c != '.' && *c != '_' && *c != '-')
+                    *c = '_';
+            batch_process_stream(&batch_params, streams_path[s], trk_out_path, &results[s]);
+            if (results[s].error[0])
+                fprintf(stderr, "(EE) Stream n°%4lu skipped: %s\n", (unsigned long)s, results[s].error);
+            else
+                fprintf(stderr, "(II) Stream n°%4lu done (%s)\n", (unsigned long)s, trk_out_path);
+        }
+#ifdef _OPENMP
+        omp_set_max_active_levels(max_active_levels);
+#endif
+        TIME_POINT(stop_batch);
+
+        size_t n_total_frames = 0, n_skipped = 0;
+        printf("# Streams statistics:\n");
+        for (size_t s = 0; s < n_streams; s++) {
+            if (results[s].error[0]) {
+                printf("# -> [%4lu] skipped (%s) -- %s\n", (unsigned long)s, results[s].error, streams_path[s]);
+                n_skipped++;
+                continue;
+            }
+            printf("# -> [%4lu] frames = %5u, tracks = %4lu, took %6.3f sec -- %s\n", (unsigned long)s,
+                   (unsigned)results[s].n_processed_frames, (unsigned long)results[s].n_tracks, results[s].time_sec,
+                   streams_path[s]);
+            n_total_frames += results[s].n_processed_frames;
+        }
+        printf("# -> Processed frames = %4u\n", (unsigned)n_total_frames);
+        if (n_skipped)
+            printf("# -> Skipped streams  = %4lu\n", (unsigned long)n_skipped);
+        printf("# -> Took %6.3f seconds (avg %d FPS)\n", TIME_ELAPSED2_SEC(start_batch, stop_batch),
+               (int)(n_total_frames / (TIME_ELAPSED2_SEC(start_batch, stop_batch))));
+
+        free(results);
+        for (size_t s = 0; s < n_streams; s++)
+            free(streams_path[s]);
+        free(streams_path);
+
+        printf("#\n");
+        printf("# End of the program, exiting.\n");
+        return n_skipped ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    for (size_t s = 0; s < n_streams; s++)
+        free(streams_path[s]);
+    free(streams_path);
+
     // --------------------------------------- //
     // -- VIDEO ALLOCATION & INITIALISATION -- //
     // --------------------------------------- //
@@ -256,9 +810,11 @@ int main(int argc, char** argv) {
     TIME_POINT(start_alloc_init);
     int i0, i1, j0, j1; // image dimension (i0 = y_min, i1 = y_max, j0 = x_min, j1 = x_max)
     video_reader_t* video = video_reader_alloc_init(p_vid_in_path, p_vid_in_start, p_vid_in_stop, p_vid_in_skip,
-                                                    p_vid_in_buff, p_vid_in_threads, VCDC_FFMPEG_IO,
+                                                    p_vid_in_buff, p_vid_in_threads, video_str_to_enum(p_vid_in_dec),
                                                     video_hwaccel_str_to_enum(p_vid_in_dec_hw), &i0, &i1, &j0, &j1);
     video->loop_size = (size_t)(p_vid_in_loop);
+    if (p_vid_in_async && !p_pipeline)
+        video_reader_prefetch_start(video, p_vid_in_async, i0, i1, j0, j1);
     video_writer_t* video_writer = NULL;
     img_data_t* img_data = NULL;
     if (p_ccl_fra_path) {
@@ -285,18 +841,21 @@ int main(int argc, char** argv) {
     CCL_data_t* ccl_data = CCL_LSL_alloc_data(i0, i1, j0, j1);
 
     // RoIs: we need two sets for matching (t-1 and t)
-    RoI_t* RoIs_tmp = features_alloc_RoIs(p_cca_roi_max1);
-    RoI_t* RoIs0 = features_alloc_RoIs(p_cca_roi_max2);  // RoIs at t-1 (produced from memorized)
-    RoI_t* RoIs1 = features_alloc_RoIs(p_cca_roi_max2);  // RoIs at t (current)
+    RoIs_t* RoIs_tmp = features_alloc_RoIs(p_cca_roi_max1);
+    uint32_t* remap = (uint32_t*)malloc((p_cca_roi_max1 + 1) * sizeof(uint32_t)); // labels remap (surface filter)
+    RoIs_t* RoIs0 = features_alloc_RoIs(p_cca_roi_max2);  // RoIs at t-1 (produced from memorized)
+    RoIs_t* RoIs1 = features_alloc_RoIs(p_cca_roi_max2);  // RoIs at t (current)
 
     kNN_data_t* knn_data = kNN_alloc_data(p_cca_roi_max2);
     tracking_data_t* tracking_data = tracking_alloc_data(MAX(p_trk_obj_min, p_trk_ext_o) + 1, p_cca_roi_max2);
 
     // Only ONE grayscale image buffer needed (current frame)
     uint8_t **IG = ui8matrix(i0, i1, j0, j1);   // grayscale input image at t
-    uint8_t **IB = ui8matrix(i0, i1, j0, j1);   // binary image (after Sigma-Delta)
-    uint32_t **L1 = ui32matrix(i0, i1, j0, j1); // labels (CCL)
-    uint32_t **L2 = NULL;                       // labels (CCL + surface filter)
+    // binary image (after Sigma-Delta), either 1 byte or 1 bit per pixel
+    const int n_words = PACKED_N_WORDS(j0, j1);
+    uint8_t **IB = p_morpho_packed ? NULL : ui8matrix(i0, i1, j0, j1);
+    uint64_t **IB_packed = p_morpho_packed ? (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1) : NULL;
+    uint32_t **L2 = NULL; // labels (CCL + surface filter)
     if (p_ccl_fra_path) {
         L2 = ui32matrix(i0, i1, j0, j1);
     }
@@ -313,16 +872,18 @@ int main(int argc, char** argv) {
         exit(1);
     }
     zero_ui8matrix(IG, i0, i1, j0, j1);
-    zero_ui8matrix(IB, i0, i1, j0, j1);
-    zero_ui32matrix(L1, i0, i1, j0, j1);
+    if (IB)
+        zero_ui8matrix(IB, i0, i1, j0, j1);
+    if (IB_packed)
+        zero_ui64matrix((uint64**)IB_packed, i0, i1, 0, n_words - 1);
     if (p_ccl_fra_path) {
         zero_ui32matrix(L2, i0, i1, j0, j1);
     }
     morpho_init_data(morpho_data);
     CCL_LSL_init_data(ccl_data);
-    features_init_RoIs(RoIs_tmp, p_cca_roi_max1);
-    features_init_RoIs(RoIs0, p_cca_roi_max2);
-    features_init_RoIs(RoIs1, p_cca_roi_max2);
+    features_init_RoIs(RoIs_tmp);
+    features_init_RoIs(RoIs0);
+    features_init_RoIs(RoIs1);
     kNN_init_data(knn_data);
     tracking_init_data(tracking_data);
 
@@ -337,73 +898,174 @@ int main(int argc, char** argv) {
     // -- PROCESSING LOOP -- //
     // --------------------- //
 
+    // latency histogram of each task, a histogram is only written by the thread that runs the task (the SD and the
+    // morphology are fused, as the CCL and the CCA)
+    stats_data_t* stats = stats_alloc_data(8);
+    stats_init_data(stats);
+    stats_hist_t* dec_hist = stats_add_hist(stats, "Video_decoding", p_pipeline ? "decode" : "main");
+    stats_hist_t* sd_hist = stats_add_hist(stats, "SD_Morphology", p_pipeline ? "sd-morpho" : "main");
+    stats_hist_t* ccl_hist = stats_add_hist(stats, "CCL_CCA", p_pipeline ? "ccl-cca" : "main");
+    stats_hist_t* flt_hist = stats_add_hist(stats, "Filtering", p_pipeline ? "ccl-cca" : "main");
+    stats_hist_t* knn_hist = stats_add_hist(stats, "k-NN", "main");
+    stats_hist_t* trk_hist = stats_add_hist(stats, "Tracking", "main");
+    stats_hist_t* log_hist = stats_add_hist(stats, "Logs", "main");
+    stats_hist_t* vis_hist = stats_add_hist(stats, "Visu", "main");
+    // the hardware counters only count the events of the thread that opened them
+    stats_perf_t* perf = p_perf_counters ? stats_perf_alloc() : NULL;
+    stats->perf_mask = perf ? perf->mask : 0;
+
+    // in pipelined mode, steps 0 to 5 are performed by 3 threads (decoding | Sigma-Delta + morphology | CCL + CCA +
+    // filtering) while the current thread performs the k-NN matching, the tracking, the logs and the visu
+    pipeline_stages_t stages;
+    pthread_t stages_threads[3];
+    if (p_pipeline) {
+        memset(&stages, 0, sizeof(stages));
+        stages.video = video;
+        stages.sd_data = sd_data;
+        stages.morpho_data = morpho_data;
+        stages.ccl_data = ccl_data;
+        stages.RoIs_tmp = RoIs_tmp;
+        stages.remap = remap;
+        stages.slots = pipeline_slots_alloc(p_pipeline_slots, i0, i1, j0, j1, p_cca_roi_max2, p_ccl_fra_path != NULL,
+                                            p_morpho_packed);
+        stages.q_free = pipeline_queue_alloc(p_pipeline_slots);
+        stages.q_sd = pipeline_queue_alloc(p_pipeline_slots);
+        stages.q_ccl = pipeline_queue_alloc(p_pipeline_slots);
+        stages.q_trk = pipeline_queue_alloc(p_pipeline_slots);
+        stages.i0 = i0; stages.i1 = i1; stages.j0 = j0; stages.j1 = j1;
+        stages.sd_n = p_sd_n;
+        stages.morpho_packed = p_morpho_packed;
+        stages.ccl_par = p_ccl_par;
+        stages.cca_roi_max1 = p_cca_roi_max1;
+        stages.cca_roi_max2 = p_cca_roi_max2;
+        stages.flt_s_min = p_flt_s_min;
+        stages.flt_s_max = p_flt_s_max;
+        stages.dec_hist = dec_hist;
+        stages.sd_hist = sd_hist;
+        stages.ccl_hist = ccl_hist;
+        stages.flt_hist = flt_hist;
+        stages.perf_counters = stats->perf_mask != 0;
+        for (int s = 0; s < p_pipeline_slots; s++)
+            pipeline_queue_push(stages.q_free, (size_t)s);
+    }
+
+    // the finished tracks are streamed into a file instead of being kept in memory
+    FILE* trk_out_file = NULL;
+    if (p_trk_out_path) {
+        trk_out_file = fopen(p_trk_out_path, "w");
+        if (trk_out_file == NULL) {
+            fprintf(stderr, "(EE) error while opening '%s'\n", p_trk_out_path);
+            exit(1);
+        }
+        tracking_tracks_write_header(trk_out_file);
+    }
+
     printf("# The program is running...\n");
     size_t n_moving_objs = 0, n_processed_frames = 0;
     uint32_t n_RoIs0 = 0; // Memorized RoI count from previous frame
     TIME_SETA(dec_a); TIME_SETA(sd_a); TIME_SETA(mrp_a); TIME_SETA(ccl_a); TIME_SETA(cca_a); TIME_SETA(flt_a);
     TIME_SETA(knn_a); TIME_SETA(trk_a); TIME_SETA(log_a); TIME_SETA(vis_a);
     TIME_POINT(start_compute);
+    if (p_pipeline) {
+        if (pthread_create(&stages_threads[0], NULL, pipeline_stage_decode, &stages) ||
+            pthread_create(&stages_threads[1], NULL, pipeline_stage_sigma_delta_morpho, &stages) ||
+            pthread_create(&stages_threads[2], NULL, pipeline_stage_CCL_CCA, &stages)) {
+            fprintf(stderr, "(EE) Unable to create the pipeline threads.\n");
+            exit(1);
+        }
+    }
     while (1) {
-        // step 0: video decoding
-        TIME_POINT(dec_b);
-        cur_fra = video_reader_get_frame(video, IG);
-        TIME_POINT(dec_e);
-        TIME_ACC(dec_a, dec_b, dec_e);
+        const uint8_t** IG_t = (const uint8_t**)IG; // grayscale image at t
+        uint32_t** L2_t = L2; // labels (CCL + surface filter) at t
+        uint32_t n_RoIs1;
+        size_t slot_id = 0;
+        if (p_pipeline) {
+            // steps 0 to 5 have been performed by the other stages
+            if (!pipeline_queue_pop(stages.q_trk, &slot_id))
+                break;
+            pipeline_slot_t* slot = &stages.slots[slot_id];
+            cur_fra = slot->frame;
+            IG_t = slot->IG_view;
+            L2_t = slot->L2;
+            n_RoIs1 = slot->n_RoIs;
+            // exchange the RoIs buffers: the slot RoIs become the RoIs at t
+            RoIs_t* tmp_RoIs = RoIs1;
+            RoIs1 = slot->RoIs;
+            slot->RoIs = tmp_RoIs;
+            fprintf(stderr, "(II) Frame n°%4d", cur_fra);
+        } else {
+            // step 0: video decoding
+            STATS_POINT(perf, dec_b);
+            // (with `--vid-in-buff` the image is not copied, `IG_t` points into the frames buffer)
+            cur_fra = video_reader_get_frame_view(video, IG, &IG_t);
+            STATS_POINT(perf, dec_e);
+            TIME_ACC(dec_a, dec_b, dec_e);
+            STATS_HIST_ADD(dec_hist, dec_b, dec_e);
 
-        // loop stop condition (= end of the video)
-        if (cur_fra == -1)
-            break;
+            // loop stop condition (= end of the video)
+            if (cur_fra == -1)
+                break;
 
-        fprintf(stderr, "(II) Frame n°%4d", cur_fra);
+            fprintf(stderr, "(II) Frame n°%4d", cur_fra);
 
-        // -------------------------------------- //
-        // -- IMAGE PROCESSING CHAIN EXECUTION -- //
-        // -------------------------------------- //
+            // -------------------------------------- //
+            // -- IMAGE PROCESSING CHAIN EXECUTION -- //
+            // -------------------------------------- //
 
-        // step 1 & 2: Fused Sigma-Delta + Morphology (Opening + Closing)
-        // == SIMPLIFIED TASK GRAPH IMPLEMENTATION  == //
-        // ============================================ //
-        //
-        // Old motion2: computes both t-1 and t in each iteration
-        // New motion:  computes only t, uses memorized RoIs for t-1
-        //
-        // "produce"  = use RoIs0 (memorized from previous iteration)
-        // "memorize" = store current RoIs1 into RoIs0 for next iteration
-
-        // --------------------- //
-        // -- Processing at t -- //
-        // --------------------- //
-
-        // step 1 & 2: Sigma-Delta + Morphology (Opening + Closing) - FUSED VERSION
-        TIME_POINT(sd_b);
-        sigma_delta_morpho_fused(sd_data, (const uint8_t**)IG, IB, morpho_data->IB, morpho_data->IB2, i0, i1, j0, j1, p_sd_n);
-        TIME_POINT(sd_e);
-
-        // Note: SD and Morphology are fused, we accumulate time to both for stats
-        TIME_ACC(sd_a, sd_b, sd_e);
-        TIME_ACC(mrp_a, sd_b, sd_e);
-
-        // step 3: connected components labeling (CCL)
-        TIME_POINT(ccl_b);
-        const uint32_t n_RoIs_tmp = CCL_LSL_apply(ccl_data, (const uint8_t**)IB, L1, 0);
-        assert(n_RoIs_tmp <= (uint32_t)p_cca_roi_max1);
-        TIME_POINT(ccl_e);
-        TIME_ACC(ccl_a, ccl_b, ccl_e);
-
-        // step 4: connected components analysis (CCA): from image of labels to "regions of interest" (RoIs)
-        TIME_POINT(cca_b);
-        features_extract((const uint32_t**)L1, i0, i1, j0, j1, RoIs_tmp, n_RoIs_tmp);
-        TIME_POINT(cca_e);
-        TIME_ACC(cca_a, cca_b, cca_e);
-
-        // step 5: surface filtering (rm too small and too big RoIs)
-        TIME_POINT(flt_b);
-        const uint32_t n_RoIs1 = features_filter_surface((const uint32_t**)L1, L2, i0, i1, j0, j1, RoIs_tmp,
-                                                         n_RoIs_tmp, p_flt_s_min, p_flt_s_max);
-        assert(n_RoIs1 <= (uint32_t)p_cca_roi_max2);
-        features_shrink_basic(RoIs_tmp, n_RoIs_tmp, RoIs1);
-        TIME_POINT(flt_e);
-        TIME_ACC(flt_a, flt_b, flt_e);
+            // step 1 & 2: Fused Sigma-Delta + Morphology (Opening + Closing)
+            // == SIMPLIFIED TASK GRAPH IMPLEMENTATION  == //
+            // ============================================ //
+            //
+            // Old motion2: computes both t-1 and t in each iteration
+            // New motion:  computes only t, uses memorized RoIs for t-1
+            //
+            // "produce"  = use RoIs0 (memorized from previous iteration)
+            // "memorize" = store current RoIs1 into RoIs0 for next iteration
+
+            // --------------------- //
+            // -- Processing at t -- //
+            // --------------------- //
+
+            // step 1 & 2: Sigma-Delta + Morphology (Opening + Closing) - FUSED VERSION
+            STATS_POINT(perf, sd_b);
+            if (p_morpho_packed) {
+                sigma_delta_compute_packed(sd_data, IG_t, IB_packed, i0, i1, j0, j1, p_sd_n);
+                morpho_compute_opening_closing3_packed64(morpho_data, (const uint64_t**)IB_packed, IB_packed,
+                                                         i0, i1, j0, j1);
+            } else {
+                sigma_delta_morpho_fused(sd_data, IG_t, IB, morpho_data->IB, morpho_data->IB2, i0, i1, j0, j1,
+                                         p_sd_n);
+            }
+            STATS_POINT(perf, sd_e);
+
+            // Note: SD and Morphology are fused, the time is accumulated to the SD only
+            TIME_ACC(sd_a, sd_b, sd_e);
+            STATS_HIST_ADD(sd_hist, sd_b, sd_e);
+
+            // step 3 & 4: connected components labeling (CCL) + connected components analysis (CCA): the "regions
+            // of interest" (RoIs) are computed from the segments of the CCL, no labels image is written
+            STATS_POINT(perf, ccl_b);
+            const uint32_t n_RoIs_tmp = CCL_CCA_apply(ccl_data, (const uint8_t**)IB, (const uint64_t**)IB_packed,
+                                                      RoIs_tmp, p_ccl_par);
+            assert(n_RoIs_tmp <= (uint32_t)p_cca_roi_max1);
+            STATS_POINT(perf, ccl_e);
+
+            // Note: CCL and CCA are fused, the time is accumulated to the CCL only
+            TIME_ACC(ccl_a, ccl_b, ccl_e);
+            STATS_HIST_ADD(ccl_hist, ccl_b, ccl_e);
+
+            // step 5: surface filtering (rm too small and too big RoIs), the filtered labels image (if needed) is
+            // directly written from the segments of the CCL
+            STATS_POINT(perf, flt_b);
+            n_RoIs1 = features_filter_surface_remap(RoIs_tmp, n_RoIs_tmp, p_flt_s_min, p_flt_s_max, remap);
+            assert(n_RoIs1 <= (uint32_t)p_cca_roi_max2);
+            if (L2)
+                CCL_LSL_write_labels(ccl_data, L2, remap);
+            features_shrink_basic(RoIs_tmp, n_RoIs_tmp, RoIs1);
+            STATS_POINT(perf, flt_e);
+            TIME_ACC(flt_a, flt_b, flt_e);
+            STATS_HIST_ADD(flt_hist, flt_b, flt_e);
+        }
 
         // ----------------------------- //
         // -- Associations (t - 1, t) -- //
@@ -411,26 +1073,30 @@ int main(int argc, char** argv) {
 
         // step 6: k-NN matching (RoIs associations)
         // "produce": RoIs0 contains memorized RoIs from previous frame
-        TIME_POINT(knn_b);
+        STATS_POINT(perf, knn_b);
         kNN_match(knn_data, RoIs0, n_RoIs0, RoIs1, n_RoIs1, p_knn_k, p_knn_d, p_knn_s);
-        TIME_POINT(knn_e);
+        STATS_POINT(perf, knn_e);
         TIME_ACC(knn_a, knn_b, knn_e);
+        STATS_HIST_ADD(knn_hist, knn_b, knn_e);
 
         // step 7: temporal tracking
-        TIME_POINT(trk_b);
+        STATS_POINT(perf, trk_b);
         tracking_perform(tracking_data, RoIs1, n_RoIs1, cur_fra, p_trk_ext_d, p_trk_obj_min,
                          p_trk_roi_path != NULL || visu_data, p_trk_ext_o, p_knn_s);
-        TIME_POINT(trk_e);
+        if (trk_out_file)
+            tracking_tracks_flush(tracking_data, trk_out_file, 1);
+        STATS_POINT(perf, trk_e);
         TIME_ACC(trk_a, trk_b, trk_e);
+        STATS_HIST_ADD(trk_hist, trk_b, trk_e);
 
         // ---------- //
         // -- LOGS -- //
         // ---------- //
 
-        TIME_POINT(log_b);
+        STATS_POINT(perf, log_b);
         // save frames (CCs)
         if (img_data) {
-            image_gs_draw_labels(img_data, (const uint32_t**)L2, RoIs1, n_RoIs1, p_ccl_fra_id);
+            image_gs_draw_labels(img_data, (const uint32_t**)L2_t, RoIs1, n_RoIs1, p_ccl_fra_id);
             video_writer_save_frame(video_writer, (const uint8_t**)image_gs_get_pixels_2d(img_data));
         }
 
@@ -454,27 +1120,33 @@ int main(int argc, char** argv) {
             }
             fclose(f);
         }
-        TIME_POINT(log_e);
+        STATS_POINT(perf, log_e);
         TIME_ACC(log_a, log_b, log_e);
+        STATS_HIST_ADD(log_hist, log_b, log_e);
 
         // display the result to the screen or write it into a video file
-        TIME_POINT(vis_b);
+        STATS_POINT(perf, vis_b);
         if (visu_data)
-            visu_display(visu_data, (const uint8_t**)IG, RoIs1, n_RoIs1, tracking_data->tracks, cur_fra);
-        TIME_POINT(vis_e);
+            visu_display(visu_data, IG_t, RoIs1, n_RoIs1, tracking_data->tracks, cur_fra);
+        STATS_POINT(perf, vis_e);
         TIME_ACC(vis_a, vis_b, vis_e);
+        STATS_HIST_ADD(vis_hist, vis_b, vis_e);
 
         // ============================================ //
         // == "MEMORIZE": Store RoIs1 -> RoIs0      == //
         // ============================================ //
         // Swap RoIs pointers: current becomes previous for next iteration
-        RoI_t* tmp_RoIs = RoIs0;
+        RoIs_t* tmp_RoIs = RoIs0;
         RoIs0 = RoIs1;
         RoIs1 = tmp_RoIs;
         n_RoIs0 = n_RoIs1;
 
+        // give the slot back to the decoding stage
+        if (p_pipeline)
+            pipeline_queue_push(stages.q_free, slot_id);
+
         n_processed_frames++;
-        n_moving_objs = tracking_count_objects(tracking_data->tracks);
+        n_moving_objs = tracking_data->n_flushed + tracking_count_objects(tracking_data->tracks);
 
         TIME_POINT(stop_compute);
         fprintf(stderr, " -- Time = %6.3f sec", TIME_ELAPSED2_SEC(start_compute, stop_compute));
@@ -485,6 +1157,17 @@ int main(int argc, char** argv) {
     TIME_POINT(stop_compute);
     fprintf(stderr, "\n");
 
+    if (p_pipeline) {
+        for (int t = 0; t < 3; t++)
+            pthread_join(stages_threads[t], NULL);
+        // each stage accumulated its own latencies, SD + morphology and CCL + CCA are fused (as in the sequential
+        // chain, the time is only accumulated to the SD and to the CCL)
+        t_dec_a_us = stages.dec_us;
+        t_sd_a_us = stages.sd_us;
+        t_ccl_a_us = stages.ccl_us;
+        t_flt_a_us = stages.flt_us;
+    }
+
     if (p_trk_roi_path) {
         FILE* f = fopen(p_trk_roi_path, "w");
         if (f == NULL) {
@@ -495,6 +1178,11 @@ int main(int argc, char** argv) {
         fclose(f);
     }
     tracking_tracks_write(stdout, tracking_data->tracks);
+    if (trk_out_file) {
+        // the remaining (not finished) tracks are also streamed
+        tracking_tracks_flush(tracking_data, trk_out_file, 0);
+        fclose(trk_out_file);
+    }
 
     printf("# Tracks statistics:\n");
     printf("# -> Processed frames = %4u\n", (unsigned)n_processed_frames);
@@ -505,10 +1193,10 @@ int main(int argc, char** argv) {
         printf("#\n");
         printf("# Average latencies: \n");
         printf("# -> Video decoding = %8.3f ms\n", TIME_ELAPSED_MS(dec_a) / n_processed_frames);
-        printf("# -> Sigma-Delta    = %8.3f ms\n", TIME_ELAPSED_MS(sd_a)  / n_processed_frames);
-        printf("# -> Morphology     = %8.3f ms\n", TIME_ELAPSED_MS(mrp_a) / n_processed_frames);
-        printf("# -> CC Labeling    = %8.3f ms\n", TIME_ELAPSED_MS(ccl_a) / n_processed_frames);
-        printf("# -> CC Analysis    = %8.3f ms\n", TIME_ELAPSED_MS(cca_a) / n_processed_frames);
+        printf("# -> Sigma-Delta    = %8.3f ms (+ Morphology)\n", TIME_ELAPSED_MS(sd_a) / n_processed_frames);
+        printf("# -> Morphology     = %8.3f ms (fused in SD)\n", TIME_ELAPSED_MS(mrp_a) / n_processed_frames);
+        printf("# -> CC Labeling    = %8.3f ms (+ CC Analysis)\n", TIME_ELAPSED_MS(ccl_a) / n_processed_frames);
+        printf("# -> CC Analysis    = %8.3f ms (fused in CCL)\n", TIME_ELAPSED_MS(cca_a) / n_processed_frames);
         printf("# -> Filtering      = %8.3f ms\n", TIME_ELAPSED_MS(flt_a) / n_processed_frames);
         printf("# -> k-NN           = %8.3f ms\n", TIME_ELAPSED_MS(knn_a) / n_processed_frames);
         printf("# -> Tracking       = %8.3f ms\n", TIME_ELAPSED_MS(trk_a) / n_processed_frames);
@@ -520,7 +1208,38 @@ int main(int argc, char** argv) {
         TIME_ADD(total, log_a); TIME_ADD(total, vis_a);
         double total = TIME_ELAPSED_MS(total) / n_processed_frames;
         printf("# => Total          = %8.3f ms [~%5.2f FPS]\n", total, 1000. / total);
+        printf("#\n");
+        printf("# Peak memory: \n");
+        printf("# -> k-NN           = %8lu bytes\n", (unsigned long)knn_data->peak_bytes);
+        if (p_pipeline) {
+            // the stages run concurrently: the throughput is bounded by the slowest one
+            double stages_ms[4];
+            stages_ms[0] = TIME_ELAPSED_MS(dec_a);
+            stages_ms[1] = TIME_ELAPSED_MS(sd_a);
+            stages_ms[2] = TIME_ELAPSED_MS(ccl_a) + TIME_ELAPSED_MS(cca_a) + TIME_ELAPSED_MS(flt_a);
+            stages_ms[3] = TIME_ELAPSED_MS(knn_a) + TIME_ELAPSED_MS(trk_a) + TIME_ELAPSED_MS(log_a) +
+                           TIME_ELAPSED_MS(vis_a);
+            printf("#\n");
+            printf("# Average latencies per pipeline stage: \n");
+            printf("# -> Decoding                      = %8.3f ms\n", stages_ms[0] / n_processed_frames);
+            printf("# -> SD + Morphology               = %8.3f ms\n", stages_ms[1] / n_processed_frames);
+            printf("# -> CCL + CCA + Filter            = %8.3f ms\n", stages_ms[2] / n_processed_frames);
+            // the logs and the visualization are performed by the main thread, in the same stage as the tracking
+            printf("# -> k-NN + Tracking + Logs + Visu = %8.3f ms\n", stages_ms[3] / n_processed_frames);
+            double slowest = 0.;
+            for (int s = 0; s < 4; s++)
+                slowest = MAX(slowest, stages_ms[s] / n_processed_frames);
+            printf("# => Slowest stage                 = %8.3f ms [~%5.2f FPS]\n", slowest, 1000. / slowest);
+        }
+        printf("#\n");
+        stats_write_table(stdout, stats, TIME_ELAPSED2_SEC(start_compute, stop_compute));
+    }
+    if (stats->perf_mask) {
+        printf("#\n");
+        stats_write_perf_table(stdout, stats);
     }
+    if (p_stats_path)
+        stats_write_file(p_stats_path, stats, TIME_ELAPSED2_SEC(start_compute, stop_compute));
 
     // some frames have been buffered for the visualization, display or write these frames here
     if (visu_data)
@@ -533,12 +1252,22 @@ int main(int argc, char** argv) {
     sigma_delta_free_data(sd_data);
     morpho_free_data(morpho_data);
     free_ui8matrix(IG, i0, i1, j0, j1);
-    free_ui8matrix(IB, i0, i1, j0, j1);
-    free_ui32matrix(L1, i0, i1, j0, j1);
+    if (IB)
+        free_ui8matrix(IB, i0, i1, j0, j1);
+    if (IB_packed)
+        free_ui64matrix((uint64**)IB_packed, i0, i1, 0, n_words - 1);
     if (p_ccl_fra_path) {
         free_ui32matrix(L2, i0, i1, j0, j1);
     }
+    if (p_pipeline) {
+        pipeline_slots_free(stages.slots, p_pipeline_slots, i0, i1, j0, j1);
+        pipeline_queue_free(stages.q_free);
+        pipeline_queue_free(stages.q_sd);
+        pipeline_queue_free(stages.q_ccl);
+        pipeline_queue_free(stages.q_trk);
+    }
     features_free_RoIs(RoIs_tmp);
+    free(remap);
     features_free_RoIs(RoIs0);
     features_free_RoIs(RoIs1);
     video_reader_free(video);
@@ -551,6 +1280,8 @@ int main(int argc, char** argv) {
     CCL_LSL_free_data(ccl_data);
     kNN_free_data(knn_data);
     tracking_free_data(tracking_data);
+    stats_perf_free(perf);
+    stats_free_data(stats);
 
     printf("#\n");
     printf("# End of the program, exiting.\n");
@@ -4,6 +4,9 @@
 #include <stdint.h>
 #include <nrc2.h>
 #include <math.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "vec.h"
 
@@ -21,6 +24,7 @@
 #include "motion/sigma_delta.h"
 #include "motion/morpho.h"
 #include "motion/visu.h"
+#include "motion/stats.h"
 
 int main(int argc, char** argv) {
 
@@ -34,8 +38,11 @@ int main(int argc, char** argv) {
     int def_p_vid_in_skip = 0;
     int def_p_vid_in_loop = 1;
     int def_p_vid_in_threads = 0;
+    int def_p_vid_in_async = 0;
+    char def_p_vid_in_dec[16] = "FFMPEG-IO";
     char def_p_vid_in_dec_hw[16] = "NONE";
     int def_p_sd_n = 2;
+    char def_p_sd_isa[16] = "AUTO";
     char* def_p_ccl_fra_path = NULL;
     int def_p_flt_s_min = 50;
     int def_p_flt_s_max = 100000;
@@ -50,6 +57,7 @@ int main(int argc, char** argv) {
     int def_p_cca_roi_max1 = 65536; // Maximum number of RoIs
     int def_p_cca_roi_max2 = 8192; // Maximum number of RoIs after filtering
     char* def_p_vid_out_path = NULL;
+    char* def_p_stats_path = NULL;
 
     // ------------------------ //
     // -- CMD LINE ARGS HELP -- //
@@ -57,7 +65,7 @@ int main(int argc, char** argv) {
 
     if (args_find(argc, argv, "--help,-h")) {
         fprintf(stderr,
-                "  --vid-in-path     Path to video file or to an images sequence                            [%s]\n",
+                "  --vid-in-path     Path to video file, images sequence or 'synth://' scene                [%s]\n",
                 def_p_vid_in_path ? def_p_vid_in_path : "NULL");
         fprintf(stderr,
                 "  --vid-in-start    Start frame id (included) in the video                                 [%d]\n",
@@ -76,12 +84,21 @@ int main(int argc, char** argv) {
         fprintf(stderr,
                 "  --vid-in-threads  Select the number of threads to use to decode video input (in ffmpeg)  [%d]\n",
                 def_p_vid_in_threads);
+        fprintf(stderr,
+                "  --vid-in-async    Number of frames read in advance by a dedicated I/O thread (0 = off)   [%d]\n",
+                def_p_vid_in_async);
+        fprintf(stderr,
+                "  --vid-in-dec      Video decoder ('FFMPEG-IO', 'YUV-MMAP' or 'LIBAV' (experimental))      [%s]\n",
+                def_p_vid_in_dec);
         fprintf(stderr,
                 "  --vid-in-dec-hw   Select video decoder hardware acceleration ('NONE', 'NVDEC', 'VIDTB')  [%s]\n",
                 def_p_vid_in_dec_hw);
         fprintf(stderr,
                 "  --sd-n            Value of the N parameter in the Sigma-Delta algorithm                  [%d]\n",
                 def_p_sd_n);
+        fprintf(stderr,
+                "  --sd-isa          Sigma-Delta SIMD ('AUTO', 'SCALAR', 'MIPP', 'AVX2', 'AVX512BW')        [%s]\n",
+                def_p_sd_isa);
         fprintf(stderr,
                 "  --ccl-fra-path    Path of the files for CC debug frames                                  [%s]\n",
                 def_p_ccl_fra_path ? def_p_ccl_fra_path : "NULL");
@@ -135,7 +152,12 @@ int main(int argc, char** argv) {
                 "  --vid-out-id      Draw the track ids on the ouptut video                                     \n");
 #endif
         fprintf(stderr,
-                "  --stats           Show the average latency of each task                                      \n");
+                "  --stats           Show the latency distribution (mean and percentiles) of each task          \n");
+        fprintf(stderr,
+                "  --stats-path      File of the latency distributions (JSON if '.json', CSV otherwise)     [%s]\n",
+                def_p_stats_path ? def_p_stats_path : "NULL");
+        fprintf(stderr,
+                "  --perf-counters   Count cycles, instructions, cache and branch misses of each task           \n");
         fprintf(stderr,
                 "  --help, -h        This help                                                                  \n");
         exit(1);
@@ -152,8 +174,11 @@ int main(int argc, char** argv) {
     const int p_vid_in_buff = args_find(argc, argv, "--vid-in-buff");
     const int p_vid_in_loop = args_find_int_min(argc, argv, "--vid-in-loop", def_p_vid_in_loop, 1);
     const int p_vid_in_threads = args_find_int_min(argc, argv, "--vid-in-threads", def_p_vid_in_threads, 0);
+    const int p_vid_in_async = args_find_int_min(argc, argv, "--vid-in-async", def_p_vid_in_async, 0);
+    const char* p_vid_in_dec = args_find_char(argc, argv, "--vid-in-dec", def_p_vid_in_dec);
     const char* p_vid_in_dec_hw = args_find_char(argc, argv, "--vid-in-dec-hw", def_p_vid_in_dec_hw);
     const int p_sd_n = args_find_int_min(argc, argv, "--sd-n", def_p_sd_n, 0);
+    const char* p_sd_isa = args_find_char(argc, argv, "--sd-isa", def_p_sd_isa);
     const char* p_ccl_fra_path = args_find_char(argc, argv, "--ccl-fra-path", def_p_ccl_fra_path);
 #ifdef MOTION_OPENCV_LINK
     const int p_ccl_fra_id = args_find(argc, argv, "--ccl-fra-id,--show-id");
@@ -180,6 +205,8 @@ int main(int argc, char** argv) {
     const int p_vid_out_id = 0;
 #endif
     const int p_stats = args_find(argc, argv, "--stats");
+    const char* p_stats_path = args_find_char(argc, argv, "--stats-path", def_p_stats_path);
+    const int p_perf_counters = args_find(argc, argv, "--perf-counters");
 
     // --------------------- //
     // -- HEADING DISPLAY -- //
@@ -198,8 +225,11 @@ int main(int argc, char** argv) {
     printf("#  * vid-in-buff    = %d\n", p_vid_in_buff);
     printf("#  * vid-in-loop    = %d\n", p_vid_in_loop);
     printf("#  * vid-in-threads = %d\n", p_vid_in_threads);
+    printf("#  * vid-in-async   = %d\n", p_vid_in_async);
+    printf("#  * vid-in-dec     = %s\n", p_vid_in_dec);
     printf("#  * vid-in-dec-hw  = %s\n", p_vid_in_dec_hw);
     printf("#  * sd-n           = %d\n", p_sd_n);
+    printf("#  * sd-isa         = %s\n", p_sd_isa);
     printf("#  * ccl-fra-path   = %s\n", p_ccl_fra_path);
 #ifdef MOTION_OPENCV_LINK
     printf("#  * ccl-fra-id     = %d\n", p_ccl_fra_id);
@@ -222,6 +252,8 @@ int main(int argc, char** argv) {
     printf("#  * vid-out-id     = %d\n", p_vid_out_id);
 #endif
     printf("#  * stats          = %d\n", p_stats);
+    printf("#  * stats-path     = %s\n", p_stats_path);
+    printf("#  * perf-counters  = %d\n", p_perf_counters);
 
     printf("#\n");
 
@@ -237,18 +269,28 @@ int main(int argc, char** argv) {
         fprintf(stderr, "(EE) '--vid-in-stop' has to be higher than '--vid-in-start'\n");
         exit(1);
     }
+    if (p_vid_in_async && p_vid_in_buff)
+        fprintf(stderr, "(WW) '--vid-in-async' will be ignored because '--vid-in-buff' is set\n");
 #ifdef MOTION_OPENCV_LINK
     if (p_ccl_fra_id && !p_ccl_fra_path)
         fprintf(stderr, "(WW) '--ccl-fra-id' has to be combined with the '--ccl-fra-path' parameter\n");
 #endif
     if (p_vid_out_path && p_vid_out_play)
         fprintf(stderr, "(WW) '--vid-out-path' will be ignore because '--vid-out-play' is set\n");
+#ifdef _OPENMP
+    if (p_perf_counters && omp_get_max_threads() > 1)
+        fprintf(stderr, "(WW) '--perf-counters' does not count the events of the OpenMP threads (the tasks run on %d "
+                        "threads, set 'OMP_NUM_THREADS=1' to count all the events)\n", omp_get_max_threads());
+#endif
 #ifdef MOTION_OPENCV_LINK
     if (p_vid_out_id && !p_vid_out_path && !p_vid_out_play)
         fprintf(stderr,
                 "(WW) '--vid-out-id' will be ignore because neither '--vid-out-play' nor 'p_vid_out_path' are set\n");
 #endif
 
+    // the Sigma-Delta kernels are selected once, before any processing thread is started
+    sigma_delta_select_isa(sigma_delta_str_to_isa(p_sd_isa));
+
     // --------------------------------------- //
     // -- VIDEO ALLOCATION & INITIALISATION -- //
     // --------------------------------------- //
@@ -256,9 +298,11 @@ int main(int argc, char** argv) {
     TIME_POINT(start_alloc_init);
     int i0, i1, j0, j1; // image dimension (i0 = y_min, i1 = y_max, j0 = x_min, j1 = x_max)
     video_reader_t* video = video_reader_alloc_init(p_vid_in_path, p_vid_in_start, p_vid_in_stop, p_vid_in_skip,
-                                                    p_vid_in_buff, p_vid_in_threads, VCDC_FFMPEG_IO,
+                                                    p_vid_in_buff, p_vid_in_threads, video_str_to_enum(p_vid_in_dec),
                                                     video_hwaccel_str_to_enum(p_vid_in_dec_hw), &i0, &i1, &j0, &j1);
     video->loop_size = (size_t)(p_vid_in_loop);
+    if (p_vid_in_async)
+        video_reader_prefetch_start(video, p_vid_in_async, i0, i1, j0, j1);
     video_writer_t* video_writer = NULL;
     img_data_t* img_data = NULL;
     if (p_ccl_fra_path) {
@@ -283,20 +327,21 @@ int main(int argc, char** argv) {
     sigma_delta_data_t* sd_data1 = sigma_delta_alloc_data(i0, i1, j0, j1, 1, 254);
     morpho_data_t* morpho_data0 = morpho_alloc_data(i0, i1, j0, j1);
     morpho_data_t* morpho_data1 = morpho_alloc_data(i0, i1, j0, j1);
-    RoI_t* RoIs_tmp0 = features_alloc_RoIs(p_cca_roi_max1);
-    RoI_t* RoIs0 = features_alloc_RoIs(p_cca_roi_max2);
-    RoI_t* RoIs_tmp1 = features_alloc_RoIs(p_cca_roi_max1);
-    RoI_t* RoIs1 = features_alloc_RoIs(p_cca_roi_max2);
+    RoIs_t* RoIs_tmp0 = features_alloc_RoIs(p_cca_roi_max1);
+    RoIs_t* RoIs0 = features_alloc_RoIs(p_cca_roi_max2);
+    RoIs_t* RoIs_tmp1 = features_alloc_RoIs(p_cca_roi_max1);
+    uint32_t* remap = (uint32_t*)malloc((p_cca_roi_max1 + 1) * sizeof(uint32_t)); // labels remap (surface filter)
+    RoIs_t* RoIs1 = features_alloc_RoIs(p_cca_roi_max2);
     CCL_data_t* ccl_data0 = CCL_LSL_alloc_data(i0, i1, j0, j1);
     CCL_data_t* ccl_data1 = CCL_LSL_alloc_data(i0, i1, j0, j1);
     kNN_data_t* knn_data = kNN_alloc_data(p_cca_roi_max2);
     tracking_data_t* tracking_data = tracking_alloc_data(MAX(p_trk_obj_min, p_trk_ext_o) + 1, p_cca_roi_max2);
     uint8_t **IG0 = ui8matrix(i0, i1, j0, j1); // grayscale input image at t - 1
     uint8_t **IG1 = ui8matrix(i0, i1, j0, j1); // grayscale input image at t
+    // images read by the chain: `IG0` / `IG1` or views on the frames buffer when `--vid-in-buff` is set
+    const uint8_t **IG0_t = (const uint8_t**)IG0, **IG1_t = (const uint8_t**)IG1;
     uint8_t **IB0 = ui8matrix(i0, i1, j0, j1); // binary image (after Sigma-Delta) at t - 1
     uint8_t **IB1 = ui8matrix(i0, i1, j0, j1); // binary image (after Sigma-Delta) at t
-    uint32_t **L10 = ui32matrix(i0, i1, j0, j1); // labels (CCL) at t - 1
-    uint32_t **L11 = ui32matrix(i0, i1, j0, j1); // labels (CCL) at t
     uint32_t **L20 = NULL; // labels (CCL + surface filter) at t - 1
     uint32_t **L21 = NULL; // labels (CCL + surface filter) at t
     if (p_ccl_fra_path) {
@@ -320,8 +365,6 @@ int main(int argc, char** argv) {
     zero_ui8matrix(IG1, i0, i1, j0, j1);
     zero_ui8matrix(IB0, i0, i1, j0, j1);
     zero_ui8matrix(IB1, i0, i1, j0, j1);
-    zero_ui32matrix(L10, i0, i1, j0, j1);
-    zero_ui32matrix(L11, i0, i1, j0, j1);
     if (p_ccl_fra_path) {
         zero_ui32matrix(L20, i0, i1, j0, j1);
         zero_ui32matrix(L21, i0, i1, j0, j1);
@@ -330,10 +373,10 @@ int main(int argc, char** argv) {
     morpho_init_data(morpho_data1);
     CCL_LSL_init_data(ccl_data0);
     CCL_LSL_init_data(ccl_data1);
-    features_init_RoIs(RoIs_tmp0, p_cca_roi_max1);
-    features_init_RoIs(RoIs_tmp1, p_cca_roi_max1);
-    features_init_RoIs(RoIs0, p_cca_roi_max2);
-    features_init_RoIs(RoIs1, p_cca_roi_max2);
+    features_init_RoIs(RoIs_tmp0);
+    features_init_RoIs(RoIs_tmp1);
+    features_init_RoIs(RoIs0);
+    features_init_RoIs(RoIs1);
     kNN_init_data(knn_data);
     tracking_init_data(tracking_data);
     // to bufferize/display the first frame
@@ -347,6 +390,21 @@ int main(int argc, char** argv) {
     // -- PROCESSING LOOP -- //
     // --------------------- //
 
+    // latency histogram of each task (the CCL and the CCA are fused)
+    stats_data_t* stats = stats_alloc_data(9);
+    stats_init_data(stats);
+    stats_hist_t* dec_hist = stats_add_hist(stats, "Video_decoding", "main");
+    stats_hist_t* sd_hist = stats_add_hist(stats, "Sigma-Delta", "main");
+    stats_hist_t* mrp_hist = stats_add_hist(stats, "Morphology", "main");
+    stats_hist_t* ccl_hist = stats_add_hist(stats, "CCL_CCA", "main");
+    stats_hist_t* flt_hist = stats_add_hist(stats, "Filtering", "main");
+    stats_hist_t* knn_hist = stats_add_hist(stats, "k-NN", "main");
+    stats_hist_t* trk_hist = stats_add_hist(stats, "Tracking", "main");
+    stats_hist_t* log_hist = stats_add_hist(stats, "Logs", "main");
+    stats_hist_t* vis_hist = stats_add_hist(stats, "Visu", "main");
+    stats_perf_t* perf = p_perf_counters ? stats_perf_alloc() : NULL;
+    stats->perf_mask = perf ? perf->mask : 0;
+
     printf("# The program is running...\n");
     size_t n_moving_objs = 0, n_processed_frames = 0;
     TIME_SETA(dec_a); TIME_SETA(sd_a); TIME_SETA(mrp_a); TIME_SETA(ccl_a); TIME_SETA(cca_a); TIME_SETA(flt_a);
@@ -354,10 +412,11 @@ int main(int argc, char** argv) {
     TIME_POINT(start_compute);
     while (1) {
         // step 0: video decoding
-        TIME_POINT(dec_b);
-        cur_fra = video_reader_get_frame(video, IG1);
-        TIME_POINT(dec_e);
+        STATS_POINT(perf, dec_b);
+        cur_fra = video_reader_get_frame_view(video, IG1, &IG1_t);
+        STATS_POINT(perf, dec_e);
         TIME_ACC(dec_a, dec_b, dec_e);
+        STATS_HIST_ADD(dec_hist, dec_b, dec_e);
 
         // loop stop condition (= end of the video)
         if (cur_fra == -1)
@@ -376,40 +435,41 @@ int main(int argc, char** argv) {
         uint32_t n_RoIs0 = 0;
         if (n_processed_frames > 0) {
             // step 1: motion detection (per pixel) with Sigma-Delta algorithm
-            TIME_POINT(sd_b);
-            sigma_delta_compute(sd_data0, (const uint8_t**)IG0, IB0, i0, i1, j0, j1, p_sd_n);
-            TIME_POINT(sd_e);
+            STATS_POINT(perf, sd_b);
+            sigma_delta_compute(sd_data0, IG0_t, IB0, i0, i1, j0, j1, p_sd_n);
+            STATS_POINT(perf, sd_e);
             TIME_ACC(sd_a, sd_b, sd_e);
+            STATS_HIST_ADD(sd_hist, sd_b, sd_e);
 
             // step 2: mathematical morphology
-            TIME_POINT(mrp_b);
+            STATS_POINT(perf, mrp_b);
             morpho_compute_opening3(morpho_data0, (const uint8_t**)IB0, IB0, i0, i1, j0, j1);
             morpho_compute_closing3(morpho_data0, (const uint8_t**)IB0, IB0, i0, i1, j0, j1);
-            TIME_POINT(mrp_e);
+            STATS_POINT(perf, mrp_e);
             TIME_ACC(mrp_a, mrp_b, mrp_e);
+            STATS_HIST_ADD(mrp_hist, mrp_b, mrp_e);
 
-            // step 3: connected components labeling (CCL)
-            TIME_POINT(ccl_b);
-            const uint32_t n_RoIs_tmp0 = CCL_LSL_apply(ccl_data0, (const uint8_t**)IB0, L10, 0);
+            // step 3 & 4: connected components labeling (CCL) + connected components analysis (CCA): the "regions
+            // of interest" (RoIs) are computed from the segments of the CCL, no labels image is written
+            STATS_POINT(perf, ccl_b);
+            const uint32_t n_RoIs_tmp0 = CCL_LSL_apply_features(ccl_data0, (const uint8_t**)IB0, NULL, RoIs_tmp0, 0);
             assert(n_RoIs_tmp0 <= (uint32_t)p_cca_roi_max1);
-            TIME_POINT(ccl_e);
+            STATS_POINT(perf, ccl_e);
             TIME_ACC(ccl_a, ccl_b, ccl_e);
+            STATS_HIST_ADD(ccl_hist, ccl_b, ccl_e);
 
-            // step 4: connected components analysis (CCA): from image of labels to "regions of interest" (RoIs)
-            TIME_POINT(cca_b);
-            features_extract((const uint32_t**)L10, i0, i1, j0, j1, RoIs_tmp0, n_RoIs_tmp0);
-            TIME_POINT(cca_e);
-            TIME_ACC(cca_a, cca_b, cca_e);
-
-            // step 5: surface filtering (rm too small and too big RoIs)
-            TIME_POINT(flt_b);
-            n_RoIs0 = features_filter_surface((const uint32_t**)L10, L20, i0, i1, j0, j1, RoIs_tmp0, n_RoIs_tmp0,
-                                              p_flt_s_min, p_flt_s_max);
+            // step 5: surface filtering (rm too small and too big RoIs), the filtered labels image (if needed) is
+            // directly written from the segments of the CCL
+            STATS_POINT(perf, flt_b);
+            n_RoIs0 = features_filter_surface_remap(RoIs_tmp0, n_RoIs_tmp0, p_flt_s_min, p_flt_s_max, remap);
             assert(n_RoIs0 <= (uint32_t)p_cca_roi_max2);
+            if (L20)
+                CCL_LSL_write_labels(ccl_data0, L20, remap);
             // features_labels_zero_init(RoIs_tmp->basic, L1);
             features_shrink_basic(RoIs_tmp0, n_RoIs_tmp0, RoIs0);
-            TIME_POINT(flt_e);
+            STATS_POINT(perf, flt_e);
             TIME_ACC(flt_a, flt_b, flt_e);
+            STATS_HIST_ADD(flt_hist, flt_b, flt_e);
         }
 
         // --------------------- //
@@ -417,63 +477,66 @@ int main(int argc, char** argv) {
         // --------------------- //
 
         // step 1: motion detection (per pixel) with Sigma-Delta algorithm
-        TIME_POINT(sd_b);
-        sigma_delta_compute(sd_data1, (const uint8_t**)IG1, IB1, i0, i1, j0, j1, p_sd_n);
-        TIME_POINT(sd_e);
+        STATS_POINT(perf, sd_b);
+        sigma_delta_compute(sd_data1, IG1_t, IB1, i0, i1, j0, j1, p_sd_n);
+        STATS_POINT(perf, sd_e);
         TIME_ACC(sd_a, sd_b, sd_e);
+        STATS_HIST_ADD(sd_hist, sd_b, sd_e);
 
         // step 2: mathematical morphology
-        TIME_POINT(mrp_b);
+        STATS_POINT(perf, mrp_b);
         morpho_compute_opening3(morpho_data1, (const uint8_t**)IB1, IB1, i0, i1, j0, j1);
         morpho_compute_closing3(morpho_data1, (const uint8_t**)IB1, IB1, i0, i1, j0, j1);
-        TIME_POINT(mrp_e);
+        STATS_POINT(perf, mrp_e);
         TIME_ACC(mrp_a, mrp_b, mrp_e);
+        STATS_HIST_ADD(mrp_hist, mrp_b, mrp_e);
 
-        // step 3: connected components labeling (CCL)
-        TIME_POINT(ccl_b);
-        const uint32_t n_RoIs_tmp1 = CCL_LSL_apply(ccl_data1, (const uint8_t**)IB1, L11, 0);
+        // step 3 & 4: connected components labeling (CCL) + connected components analysis (CCA): the "regions
+        // of interest" (RoIs) are computed from the segments of the CCL, no labels image is written
+        STATS_POINT(perf, ccl_b);
+        const uint32_t n_RoIs_tmp1 = CCL_LSL_apply_features(ccl_data1, (const uint8_t**)IB1, NULL, RoIs_tmp1, 0);
         assert(n_RoIs_tmp1 <= (uint32_t)p_cca_roi_max1);
-        TIME_POINT(ccl_e);
+        STATS_POINT(perf, ccl_e);
         TIME_ACC(ccl_a, ccl_b, ccl_e);
+        STATS_HIST_ADD(ccl_hist, ccl_b, ccl_e);
 
-        // step 4: connected components analysis (CCA): from image of labels to "regions of interest" (RoIs)
-        TIME_POINT(cca_b);
-        features_extract((const uint32_t**)L11, i0, i1, j0, j1, RoIs_tmp1, n_RoIs_tmp1);
-        TIME_POINT(cca_e);
-        TIME_ACC(cca_a, cca_b, cca_e);
-
-        // step 5: surface filtering (rm too small and too big RoIs)
-        TIME_POINT(flt_b);
-        const uint32_t n_RoIs1 = features_filter_surface((const uint32_t**)L11, L21, i0, i1, j0, j1, RoIs_tmp1,
-                                                         n_RoIs_tmp1, p_flt_s_min, p_flt_s_max);
+        // step 5: surface filtering (rm too small and too big RoIs), the filtered labels image (if needed) is
+        // directly written from the segments of the CCL
+        STATS_POINT(perf, flt_b);
+        const uint32_t n_RoIs1 = features_filter_surface_remap(RoIs_tmp1, n_RoIs_tmp1, p_flt_s_min, p_flt_s_max, remap);
         assert(n_RoIs1 <= (uint32_t)p_cca_roi_max2);
+        if (L21)
+            CCL_LSL_write_labels(ccl_data1, L21, remap);
         // features_labels_zero_init(RoIs_tmp->basic, L1);
         features_shrink_basic(RoIs_tmp1, n_RoIs_tmp1, RoIs1);
-        TIME_POINT(flt_e);
+        STATS_POINT(perf, flt_e);
         TIME_ACC(flt_a, flt_b, flt_e);
+        STATS_HIST_ADD(flt_hist, flt_b, flt_e);
 
         // ----------------------------- //
         // -- Associations (t - 1, t) -- //
         // ----------------------------- //
 
         // step 6: k-NN matching (RoIs associations)
-        TIME_POINT(knn_b);
+        STATS_POINT(perf, knn_b);
         kNN_match(knn_data, RoIs0, n_RoIs0, RoIs1, n_RoIs1, p_knn_k, p_knn_d, p_knn_s);
-        TIME_POINT(knn_e);
+        STATS_POINT(perf, knn_e);
         TIME_ACC(knn_a, knn_b, knn_e);
+        STATS_HIST_ADD(knn_hist, knn_b, knn_e);
 
         // step 7: temporal tracking
-        TIME_POINT(trk_b);
+        STATS_POINT(perf, trk_b);
         tracking_perform(tracking_data, RoIs1, n_RoIs1, cur_fra, p_trk_ext_d, p_trk_obj_min,
                          p_trk_roi_path != NULL || visu_data, p_trk_ext_o, p_knn_s);
-        TIME_POINT(trk_e);
+        STATS_POINT(perf, trk_e);
         TIME_ACC(trk_a, trk_b, trk_e);
+        STATS_HIST_ADD(trk_hist, trk_b, trk_e);
 
         // ---------- //
         // -- LOGS -- //
         // ---------- //
 
-        TIME_POINT(log_b);
+        STATS_POINT(perf, log_b);
         // save frames (CCs)
         if (img_data) {
             image_gs_draw_labels(img_data, (const uint32_t**)L21, RoIs1, n_RoIs1, p_ccl_fra_id);
@@ -500,20 +563,23 @@ int main(int argc, char** argv) {
             }
             fclose(f);
         }
-        TIME_POINT(log_e);
+        STATS_POINT(perf, log_e);
         TIME_ACC(log_a, log_b, log_e);
+        STATS_HIST_ADD(log_hist, log_b, log_e);
 
         // display the result to the screen or write it into a video file
-        TIME_POINT(vis_b);
+        STATS_POINT(perf, vis_b);
         if (visu_data)
-            visu_display(visu_data, (const uint8_t**)IG1, RoIs1, n_RoIs1, tracking_data->tracks, cur_fra);
-        TIME_POINT(vis_e);
+            visu_display(visu_data, IG1_t, RoIs1, n_RoIs1, tracking_data->tracks, cur_fra);
+        STATS_POINT(perf, vis_e);
         TIME_ACC(vis_a, vis_b, vis_e);
+        STATS_HIST_ADD(vis_hist, vis_b, vis_e);
 
         // swap IG0 <-> IG1 for the next frame
         uint8_t** tmp = IG0;
         IG0 = IG1;
         IG1 = tmp;
+        IG0_t = IG1_t;
 
         n_processed_frames++;
         n_moving_objs = tracking_count_objects(tracking_data->tracks);
@@ -562,7 +628,18 @@ int main(int argc, char** argv) {
         TIME_ADD(total, log_a); TIME_ADD(total, vis_a);
         double total = TIME_ELAPSED_MS(total) / n_processed_frames;
         printf("# => Total          = %8.3f ms [~%5.2f FPS]\n", total, 1000. / total);
+        printf("#\n");
+        printf("# Peak memory: \n");
+        printf("# -> k-NN           = %8lu bytes\n", (unsigned long)knn_data->peak_bytes);
+        printf("#\n");
+        stats_write_table(stdout, stats, TIME_ELAPSED2_SEC(start_compute, stop_compute));
+    }
+    if (stats->perf_mask) {
+        printf("#\n");
+        stats_write_perf_table(stdout, stats);
     }
+    if (p_stats_path)
+        stats_write_file(p_stats_path, stats, TIME_ELAPSED2_SEC(start_compute, stop_compute));
 
     // some frames have been buffered for the visualization, display or write these frames here
     if (visu_data)
@@ -580,14 +657,13 @@ int main(int argc, char** argv) {
     free_ui8matrix(IG1, i0, i1, j0, j1);
     free_ui8matrix(IB0, i0, i1, j0, j1);
     free_ui8matrix(IB1, i0, i1, j0, j1);
-    free_ui32matrix(L10, i0, i1, j0, j1);
-    free_ui32matrix(L11, i0, i1, j0, j1);
     if (p_ccl_fra_path) {
         free_ui32matrix(L20, i0, i1, j0, j1);
         free_ui32matrix(L21, i0, i1, j0, j1);
     }
     features_free_RoIs(RoIs_tmp0);
     features_free_RoIs(RoIs_tmp1);
+    free(remap);
     features_free_RoIs(RoIs0);
     features_free_RoIs(RoIs1);
     video_reader_free(video);
@@ -601,6 +677,8 @@ int main(int argc, char** argv) {
     CCL_LSL_free_data(ccl_data1);
     kNN_free_data(knn_data);
     tracking_free_data(tracking_data);
+    stats_perf_free(perf);
+    stats_free_data(stats);
 
     printf("#\n");
     printf("# End of the program, exiting.\n");
@@ -0,0 +1,680 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <nrc2.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "vec.h"
+
+#include "motion/args.h"
+#include "motion/tools.h"
+#include "motion/macros.h"
+
+#include "motion/CCL.h"
+#include "motion/features.h"
+#include "motion/kNN.h"
+#include "motion/tracking.h"
+#include "motion/sigma_delta.h"
+#include "motion/morpho.h"
+#include "motion/synth.h"
+
+// number of frames of the synthetic scene rendered before the measures, the iterations cycle over these frames
+#define BENCH_N_FRAMES 8
+
+/**
+ *  Inputs, outputs and inner data of the kernels. The inputs of each kernel are the reference outputs of the previous
+ *  steps of the detection chain, computed once per frame before the measures.
+ */
+typedef struct {
+    int i0; /**< First \f$y\f$ index in the images (included). */
+    int i1; /**< Last \f$y\f$ index in the images (included). */
+    int j0; /**< First \f$x\f$ index in the images (included). */
+    int j1; /**< Last \f$x\f$ index in the images (included). */
+    int sd_n; /**< Sigma-Delta parameter. */
+    int flt_s_min; /**< Minimum surface of the CCs (surface filtering). */
+    int flt_s_max; /**< Maximum surface of the CCs (surface filtering). */
+    int knn_k; /**< Maximum number of neighbors (k-NN). */
+    int knn_d; /**< Maximum distance between two RoIs (k-NN). */
+    float knn_s; /**< Minimum surface ratio (k-NN and tracking). */
+    int trk_ext_d; /**< Search radius for the extrapolation (tracking). */
+    int trk_ext_o; /**< Maximum number of extrapolated frames (tracking). */
+    int trk_obj_min; /**< Minimum number of frames to track an object (tracking). */
+    uint8_t** IG[BENCH_N_FRAMES]; /**< Grayscale frames. */
+    uint8_t** IB[BENCH_N_FRAMES]; /**< Binary frames (1 byte per pixel). */
+    uint64_t** IB_packed[BENCH_N_FRAMES]; /**< Binary frames (1 bit per pixel, see `PACKED_N_WORDS`). */
+    uint32_t** L[BENCH_N_FRAMES]; /**< Labels of the binary frames. */
+    RoIs_t* RoIs[BENCH_N_FRAMES]; /**< RoIs of the binary frames (CCA). */
+    uint32_t n_RoIs[BENCH_N_FRAMES]; /**< Number of RoIs in `RoIs`. */
+    RoIs_t* RoIs_flt[BENCH_N_FRAMES]; /**< RoIs of the binary frames after surface filtering. */
+    uint32_t n_RoIs_flt[BENCH_N_FRAMES]; /**< Number of RoIs in `RoIs_flt`. */
+    uint8_t** IB_tmp; /**< Intermediate binary image (opening result before the closing). */
+    uint8_t** IB_out; /**< Output binary image. */
+    uint64_t** IB_packed_tmp; /**< Intermediate packed binary image (opening result before the closing). */
+    uint64_t** IB_packed_out; /**< Output packed binary image. */
+    uint32_t** L_out; /**< Output labels. */
+    RoIs_t* RoIs_out; /**< Output RoIs. */
+    uint32_t* remap; /**< Labels remap table (surface filtering). */
+    sigma_delta_data_t* sd_data; /**< Sigma-Delta data. */
+    morpho_data_t* morpho_data; /**< Morphology data. */
+    CCL_data_t* ccl_data; /**< CCL data. */
+    kNN_data_t* knn_data; /**< k-NN data. */
+    tracking_data_t* tracking_data; /**< Tracking data. */
+    size_t trk_frame; /**< Frame id given to the tracking. */
+    FILE* trk_file; /**< Sink of the finished tracks (the tracking memory is bounded). */
+} bench_data_t;
+
+/**
+ *  RoIs read or produced by a kernel, the time per RoI is computed from their average number.
+ */
+enum bench_RoIs_e { BENCH_ROIS_NONE = 0, /**< Pixel kernel. */
+                    BENCH_ROIS_CCA, /**< RoIs of the CCA (before surface filtering). */
+                    BENCH_ROIS_FLT /**< RoIs after surface filtering. */
+};
+
+/**
+ *  Benchmarked kernel: `prepare` is called before each iteration (not measured, can be NULL), then `run` is measured.
+ */
+typedef struct {
+    const char* name; /**< Name of the kernel (= name of the function or of the variant). */
+    enum bench_RoIs_e RoIs; /**< RoIs of the kernel. */
+    void (*prepare)(bench_data_t* b, const size_t f); /**< Preparation of the inputs of frame `f`. */
+    void (*run)(bench_data_t* b, const size_t f); /**< Kernel on frame `f`. */
+} bench_kernel_t;
+
+// copy the `n_RoIs` first RoIs
+static void bench_copy_RoIs(const RoIs_t* RoIs_src, const size_t n_RoIs, RoIs_t* RoIs_dst) {
+    assert(n_RoIs <= RoIs_dst->_max_size);
+    const uint32_t* src[10] = { RoIs_src->id, RoIs_src->xmin, RoIs_src->xmax, RoIs_src->ymin, RoIs_src->ymax,
+                                RoIs_src->S, RoIs_src->Sx, RoIs_src->Sy, RoIs_src->prev_id, RoIs_src->next_id };
+    uint32_t* dst[10] = { RoIs_dst->id, RoIs_dst->xmin, RoIs_dst->xmax, RoIs_dst->ymin, RoIs_dst->ymax,
+                          RoIs_dst->S, RoIs_dst->Sx, RoIs_dst->Sy, RoIs_dst->prev_id, RoIs_dst->next_id };
+    for (size_t a = 0; a < 10; a++)
+        memcpy(dst[a], src[a], n_RoIs * sizeof(uint32_t));
+    memcpy(RoIs_dst->x, RoIs_src->x, n_RoIs * sizeof(float));
+    memcpy(RoIs_dst->y, RoIs_src->y, n_RoIs * sizeof(float));
+}
+
+static void bench_sigma_delta(bench_data_t* b, const size_t f) {
+    sigma_delta_compute(b->sd_data, (const uint8_t**)b->IG[f], b->IB_out, b->i0, b->i1, b->j0, b->j1, b->sd_n);
+}
+
+static void bench_sigma_delta_packed(bench_data_t* b, const size_t f) {
+    sigma_delta_compute_packed(b->sd_data, (const uint8_t**)b->IG[f], b->IB_packed_out, b->i0, b->i1, b->j0, b->j1,
+                               b->sd_n);
+}
+
+// opening + closing with the 3x3 (non-separable) operators
+static void bench_morpho_byte(bench_data_t* b, const size_t f) {
+    morpho_data_t* m = b->morpho_data;
+    morpho_compute_erosion3((const uint8_t**)b->IB[f], m->IB, b->i0, b->i1, b->j0, b->j1);
+    morpho_compute_dilation3((const uint8_t**)m->IB, m->IB2, b->i0, b->i1, b->j0, b->j1);
+    morpho_compute_dilation3((const uint8_t**)m->IB2, m->IB, b->i0, b->i1, b->j0, b->j1);
+    morpho_compute_erosion3((const uint8_t**)m->IB, b->IB_out, b->i0, b->i1, b->j0, b->j1);
+}
+
+static void bench_morpho_separable(bench_data_t* b, const size_t f) {
+    morpho_compute_opening3(b->morpho_data, (const uint8_t**)b->IB[f], b->IB_tmp, b->i0, b->i1, b->j0, b->j1);
+    morpho_compute_closing3(b->morpho_data, (const uint8_t**)b->IB_tmp, b->IB_out, b->i0, b->i1, b->j0, b->j1);
+}
+
+static void bench_morpho_packed8_prepare(bench_data_t* b, const size_t f) {
+    morpho_pack_binary((const uint8_t**)b->IB[f], b->morpho_data->IB_packed, b->i0, b->i1, b->j0, b->j1);
+}
+
+static void bench_morpho_packed8(bench_data_t* b, const size_t f) {
+    (void)f;
+    morpho_data_t* m = b->morpho_data;
+    const int jp1 = b->j0 + (b->j1 - b->j0 + 8) / 8 - 1;
+    morpho_compute_opening3_packed(m->IB_packed, m->IB_packed2, m->IB_packed3, b->i0, b->i1, b->j0, jp1);
+    morpho_compute_closing3_packed(m->IB_packed, m->IB_packed2, m->IB_packed3, b->i0, b->i1, b->j0, jp1);
+}
+
+static void bench_morpho_packed64(bench_data_t* b, const size_t f) {
+    morpho_compute_opening3_packed64(b->morpho_data, (const uint64_t**)b->IB_packed[f], b->IB_packed_tmp, b->i0,
+                                     b->i1, b->j0, b->j1);
+    morpho_compute_closing3_packed64(b->morpho_data, (const uint64_t**)b->IB_packed_tmp, b->IB_packed_out, b->i0,
+                                     b->i1, b->j0, b->j1);
+}
+
+static void bench_morpho_packed64_fused(bench_data_t* b, const size_t f) {
+    morpho_compute_opening_closing3_packed64(b->morpho_data, (const uint64_t**)b->IB_packed[f], b->IB_packed_out,
+                                             b->i0, b->i1, b->j0, b->j1);
+}
+
+static void bench_sd_morpho_fused(bench_data_t* b, const size_t f) {
+    sigma_delta_morpho_fused(b->sd_data, (const uint8_t**)b->IG[f], b->IB_out, b->morpho_data->IB,
+                             b->morpho_data->IB2, b->i0, b->i1, b->j0, b->j1, b->sd_n);
+}
+
+static void bench_sd_morpho_pipelined(bench_data_t* b, const size_t f) {
+    sigma_delta_morpho_pipelined(b->sd_data, (const uint8_t**)b->IG[f], b->IB_out, b->morpho_data->IB,
+                                 b->morpho_data->IB2, b->i0, b->i1, b->j0, b->j1, b->sd_n);
+}
+
+static void bench_CCL_LSL_apply(bench_data_t* b, const size_t f) {
+    CCL_LSL_apply(b->ccl_data, (const uint8_t**)b->IB[f], b->L_out, 0);
+}
+
+static void bench_CCL_LSL_apply_par(bench_data_t* b, const size_t f) {
+    CCL_LSL_apply_par(b->ccl_data, (const uint8_t**)b->IB[f], b->L_out, 0);
+}
+
+static void bench_CCL_LSL_apply_packed(bench_data_t* b, const size_t f) {
+    CCL_LSL_apply_packed(b->ccl_data, (const uint64_t**)b->IB_packed[f], b->L_out, 0);
+}
+
+static void bench_CCL_LSL_apply_features(bench_data_t* b, const size_t f) {
+    CCL_LSL_apply_features(b->ccl_data, (const uint8_t**)b->IB[f], NULL, b->RoIs_out, 0);
+}
+
+static void bench_CCL_LSL_apply_packed_features(bench_data_t* b, const size_t f) {
+    CCL_LSL_apply_packed_features(b->ccl_data, (const uint64_t**)b->IB_packed[f], NULL, b->RoIs_out, 0);
+}
+
+static void bench_features_extract(bench_data_t* b, const size_t f) {
+    features_extract((const uint32_t**)b->L[f], b->i0, b->i1, b->j0, b->j1, b->RoIs_out, b->n_RoIs[f]);
+}
+
+// the surface filtering resets the ids of the filtered RoIs, it works on a copy of the RoIs
+static void bench_features_filter_prepare(bench_data_t* b, const size_t f) {
+    bench_copy_RoIs(b->RoIs[f], b->n_RoIs[f], b->RoIs_out);
+}
+
+static void bench_features_filter_surface(bench_data_t* b, const size_t f) {
+    features_filter_surface((const uint32_t**)b->L[f], b->L_out, b->i0, b->i1, b->j0, b->j1, b->RoIs_out,
+                            b->n_RoIs[f], b->flt_s_min, b->flt_s_max);
+}
+
+static void bench_features_filter_surface_remap(bench_data_t* b, const size_t f) {
+    features_filter_surface_remap(b->RoIs_out, b->n_RoIs[f], b->flt_s_min, b->flt_s_max, b->remap);
+}
+
+static void bench_kNN_match(bench_data_t* b, const size_t f) {
+    const size_t f0 = (f + BENCH_N_FRAMES - 1) % BENCH_N_FRAMES;
+    kNN_match(b->knn_data, b->RoIs_flt[f0], b->n_RoIs_flt[f0], b->RoIs_flt[f], b->n_RoIs_flt[f], b->knn_k, b->knn_d,
+              b->knn_s);
+}
+
+// the tracking needs the associations of the k-NN, the finished tracks are flushed to keep a steady state
+static void bench_tracking_prepare(bench_data_t* b, const size_t f) {
+    bench_kNN_match(b, f);
+    tracking_tracks_flush(b->tracking_data, b->trk_file, 1);
+}
+
+static void bench_tracking_perform(bench_data_t* b, const size_t f) {
+    tracking_perform(b->tracking_data, b->RoIs_flt[f], b->n_RoIs_flt[f], b->trk_frame++, b->trk_ext_d,
+                     b->trk_obj_min, 0, b->trk_ext_o, b->knn_s);
+}
+
+static const bench_kernel_t bench_kernels[] = {
+    { "sigma_delta", BENCH_ROIS_NONE, NULL, bench_sigma_delta },
+    { "sigma_delta_packed", BENCH_ROIS_NONE, NULL, bench_sigma_delta_packed },
+    { "morpho_byte", BENCH_ROIS_NONE, NULL, bench_morpho_byte },
+    { "morpho_separable", BENCH_ROIS_NONE, NULL, bench_morpho_separable },
+    { "morpho_packed8", BENCH_ROIS_NONE, bench_morpho_packed8_prepare, bench_morpho_packed8 },
+    { "morpho_packed64", BENCH_ROIS_NONE, NULL, bench_morpho_packed64 },
+    { "morpho_packed64_fused", BENCH_ROIS_NONE, NULL, bench_morpho_packed64_fused },
+    { "sd_morpho_fused", BENCH_ROIS_NONE, NULL, bench_sd_morpho_fused },
+    { "sd_morpho_pipelined", BENCH_ROIS_NONE, NULL, bench_sd_morpho_pipelined },
+    { "CCL_LSL_apply", BENCH_ROIS_CCA, NULL, bench_CCL_LSL_apply },
+    { "CCL_LSL_apply_par", BENCH_ROIS_CCA, NULL, bench_CCL_LSL_apply_par },
+    { "CCL_LSL_apply_packed", BENCH_ROIS_CCA, NULL, bench_CCL_LSL_apply_packed },
+    { "CCL_LSL_apply_features", BENCH_ROIS_CCA, NULL, bench_CCL_LSL_apply_features },
+    { "CCL_LSL_apply_packed_features", BENCH_ROIS_CCA, NULL, bench_CCL_LSL_apply_packed_features },
+    { "features_extract", BENCH_ROIS_CCA, NULL, bench_features_extract },
+    { "features_filter_surface", BENCH_ROIS_CCA, bench_features_filter_prepare, bench_features_filter_surface },
+    { "features_filter_surface_remap", BENCH_ROIS_CCA, bench_features_filter_prepare,
+      bench_features_filter_surface_remap },
+    { "kNN_match", BENCH_ROIS_FLT, NULL, bench_kNN_match },
+    { "tracking_perform", BENCH_ROIS_FLT, bench_tracking_prepare, bench_tracking_perform },
+};
+#define BENCH_N_KERNELS (sizeof(bench_kernels) / sizeof(bench_kernels[0]))
+
+// reset the state of the kernels (the Sigma-Delta model and the tracks), each measure starts from the same state
+static void bench_reset(bench_data_t* b) {
+    sigma_delta_init_data(b->sd_data, (const uint8_t**)b->IG[0], b->i0, b->i1, b->j0, b->j1);
+    tracking_tracks_flush(b->tracking_data, b->trk_file, 0);
+    tracking_init_data(b->tracking_data);
+    b->trk_frame = 1;
+}
+
+// return 1 if `name` starts with one of the ','-separated prefixes of `filter` (or if `filter` is NULL)
+static int bench_select(const char* filter, const char* name) {
+    if (filter == NULL)
+        return 1;
+    const char* cur = filter;
+    while (1) {
+        const char* end = strchr(cur, ',');
+        const size_t len = end ? (size_t)(end - cur) : strlen(cur);
+        if (len && strncmp(name, cur, len) == 0)
+            return 1;
+        if (!end)
+            return 0;
+        cur = end + 1;
+    }
+}
+
+static int bench_compare_double(const void* a, const void* b) {
+    const double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+int main(int argc, char** argv) {
+
+    // ---------------------------------- //
+    // -- DEFAULT VALUES OF PARAMETERS -- //
+    // ---------------------------------- //
+
+    int def_p_synth_width = 1920;
+    int def_p_synth_height = 1080;
+    int def_p_synth_objs = 32;
+    float def_p_synth_size = 24.f;
+    float def_p_synth_speed = 3.f;
+    float def_p_synth_noise = 0.001f;
+    int def_p_synth_seed = 1;
+    int def_p_sd_n = 2;
+    char def_p_sd_isa[16] = "AUTO";
+    int def_p_flt_s_min = 50;
+    int def_p_flt_s_max = 100000;
+    int def_p_knn_k = 3;
+    int def_p_knn_d = 10;
+    float def_p_knn_s = 0.125f;
+    int def_p_trk_ext_d = 5;
+    int def_p_trk_ext_o = 3;
+    int def_p_trk_obj_min = 2;
+    int def_p_bench_iter = 50;
+    int def_p_bench_warmup = 3;
+    char def_p_bench_threads[64] = "[1]";
+#ifdef _OPENMP
+    if (omp_get_max_threads() > 1)
+        snprintf(def_p_bench_threads, sizeof(def_p_bench_threads), "[1,%d]", omp_get_max_threads());
+#endif
+    char* def_p_bench_kernels = NULL;
+    char* def_p_bench_out_path = NULL;
+
+    // ------------------------ //
+    // -- CMD LINE ARGS HELP -- //
+    // ------------------------ //
+
+    if (args_find(argc, argv, "--help,-h")) {
+        fprintf(stderr,
+                "  --synth-width     Width of the synthetic frames                                          [%d]\n",
+                def_p_synth_width);
+        fprintf(stderr,
+                "  --synth-height    Height of the synthetic frames                                         [%d]\n",
+                def_p_synth_height);
+        fprintf(stderr,
+                "  --synth-objs      Number of moving objects in the synthetic scene                        [%d]\n",
+                def_p_synth_objs);
+        fprintf(stderr,
+                "  --synth-size      Mean diameter of the objects in pixels                                 [%f]\n",
+                def_p_synth_size);
+        fprintf(stderr,
+                "  --synth-speed     Maximum speed of the objects in pixels per frame                       [%f]\n",
+                def_p_synth_speed);
+        fprintf(stderr,
+                "  --synth-noise     Ratio of noisy pixels per frame (density of the small CCs)             [%f]\n",
+                def_p_synth_noise);
+        fprintf(stderr,
+                "  --synth-seed      Seed of the synthetic scene                                            [%d]\n",
+                def_p_synth_seed);
+        fprintf(stderr,
+                "  --sd-n            Value of the N parameter in the Sigma-Delta algorithm                  [%d]\n",
+                def_p_sd_n);
+        fprintf(stderr,
+                "  --sd-isa          Sigma-Delta SIMD ('AUTO', 'SCALAR', 'MIPP', 'AVX2', 'AVX512BW')        [%s]\n",
+                def_p_sd_isa);
+        fprintf(stderr,
+                "  --flt-s-min       Minimum surface of the CCs in pixels                                   [%d]\n",
+                def_p_flt_s_min);
+        fprintf(stderr,
+                "  --flt-s-max       Maxumum surface of the CCs in pixels                                   [%d]\n",
+                def_p_flt_s_max);
+        fprintf(stderr,
+                "  --knn-k           Maximum number of neighbors considered in k-NN algorithm               [%d]\n",
+                def_p_knn_k);
+        fprintf(stderr,
+                "  --knn-d           Maximum distance in pixels between two images (in k-NN)                [%d]\n",
+                def_p_knn_d);
+        fprintf(stderr,
+                "  --knn-s           Minimum surface ratio to match two CCs in k-NN                         [%f]\n",
+                def_p_knn_s);
+        fprintf(stderr,
+                "  --trk-ext-d       Search radius in pixels for CC extrapolation (piece-wise tracking)     [%d]\n",
+                def_p_trk_ext_d);
+        fprintf(stderr,
+                "  --trk-ext-o       Maximum number of frames to extrapolate (linear) for lost objects      [%d]\n",
+                def_p_trk_ext_o);
+        fprintf(stderr,
+                "  --trk-obj-min     Minimum number of frames required to track an object                   [%d]\n",
+                def_p_trk_obj_min);
+        fprintf(stderr,
+                "  --bench-iter      Number of measured iterations per kernel (the median is reported)      [%d]\n",
+                def_p_bench_iter);
+        fprintf(stderr,
+                "  --bench-warmup    Number of iterations per kernel before the measures                    [%d]\n",
+                def_p_bench_warmup);
+        fprintf(stderr,
+                "  --bench-threads   Numbers of OpenMP threads to measure                                   [%s]\n",
+                def_p_bench_threads);
+        fprintf(stderr,
+                "  --bench-kernels   Kernels to measure, ','-separated names or prefixes (NULL = all)       [%s]\n",
+                def_p_bench_kernels ? def_p_bench_kernels : "NULL");
+        fprintf(stderr,
+                "  --bench-out-path  Path of the CSV file of the results                                    [%s]\n",
+                def_p_bench_out_path ? def_p_bench_out_path : "NULL");
+        fprintf(stderr,
+                "  --bench-list      List the kernels and exit                                                  \n");
+        fprintf(stderr,
+                "  --help, -h        This help                                                                  \n");
+        exit(1);
+    }
+
+    if (args_find(argc, argv, "--bench-list")) {
+        for (size_t k = 0; k < BENCH_N_KERNELS; k++)
+            printf("%s\n", bench_kernels[k].name);
+        exit(0);
+    }
+
+    // ------------------------- //
+    // -- PARSE CMD LINE ARGS -- //
+    // ------------------------- //
+
+    const int p_synth_width = args_find_int_min(argc, argv, "--synth-width", def_p_synth_width, 3);
+    const int p_synth_height = args_find_int_min(argc, argv, "--synth-height", def_p_synth_height, 3);
+    const int p_synth_objs = args_find_int_min(argc, argv, "--synth-objs", def_p_synth_objs, 0);
+    const float p_synth_size = args_find_float_min(argc, argv, "--synth-size", def_p_synth_size, 1.f);
+    const float p_synth_speed = args_find_float_min(argc, argv, "--synth-speed", def_p_synth_speed, 0.f);
+    const float p_synth_noise = args_find_float_min_max(argc, argv, "--synth-noise", def_p_synth_noise, 0.f, 1.f);
+    const int p_synth_seed = args_find_int_min(argc, argv, "--synth-seed", def_p_synth_seed, 0);
+    const int p_sd_n = args_find_int_min(argc, argv, "--sd-n", def_p_sd_n, 0);
+    const char* p_sd_isa = args_find_char(argc, argv, "--sd-isa", def_p_sd_isa);
+    const int p_flt_s_min = args_find_int_min(argc, argv, "--flt-s-min", def_p_flt_s_min, 0);
+    const int p_flt_s_max = args_find_int_min(argc, argv, "--flt-s-max", def_p_flt_s_max, 0);
+    const int p_knn_k = args_find_int_min(argc, argv, "--knn-k", def_p_knn_k, 0);
+    const int p_knn_d = args_find_int_min(argc, argv, "--knn-d", def_p_knn_d, 0);
+    const float p_knn_s = args_find_float_min_max(argc, argv, "--knn-s", def_p_knn_s, 0.f, 1.f);
+    const int p_trk_ext_d = args_find_int_min(argc, argv, "--trk-ext-d", def_p_trk_ext_d, 0);
+    const int p_trk_ext_o = args_find_int_min_max(argc, argv, "--trk-ext-o", def_p_trk_ext_o, 0, 255);
+    const int p_trk_obj_min = args_find_int_min(argc, argv, "--trk-obj-min", def_p_trk_obj_min, 2);
+    const int p_bench_iter = args_find_int_min(argc, argv, "--bench-iter", def_p_bench_iter, 1);
+    const int p_bench_warmup = args_find_int_min(argc, argv, "--bench-warmup", def_p_bench_warmup, 0);
+    vec_int_t p_bench_threads = args_find_vector_int(argc, argv, "--bench-threads", def_p_bench_threads);
+    const char* p_bench_kernels = args_find_char(argc, argv, "--bench-kernels", def_p_bench_kernels);
+    const char* p_bench_out_path = args_find_char(argc, argv, "--bench-out-path", def_p_bench_out_path);
+
+    // the Sigma-Delta kernels are selected once, the heading displays the instruction set really used
+    const enum sigma_delta_isa_e sd_isa = sigma_delta_select_isa(sigma_delta_str_to_isa(p_sd_isa));
+
+    // --------------------- //
+    // -- HEADING DISPLAY -- //
+    // --------------------- //
+
+    char str_bench_threads[256];
+    args_convert_int_vector_to_string(p_bench_threads, str_bench_threads, sizeof(str_bench_threads));
+
+    printf("#  ---------------- \n");
+    printf("# |  MOTION-BENCH  |\n");
+    printf("#  ---------------- \n");
+    printf("#\n");
+    printf("# Parameters:\n");
+    printf("# -----------\n");
+    printf("#  * synth-width    = %d\n", p_synth_width);
+    printf("#  * synth-height   = %d\n", p_synth_height);
+    printf("#  * synth-objs     = %d\n", p_synth_objs);
+    printf("#  * synth-size     = %1.1f\n", p_synth_size);
+    printf("#  * synth-speed    = %1.1f\n", p_synth_speed);
+    printf("#  * synth-noise    = %1.4f\n", p_synth_noise);
+    printf("#  * synth-seed     = %d\n", p_synth_seed);
+    printf("#  * sd-n           = %d\n", p_sd_n);
+    printf("#  * sd-isa         = %s\n", sigma_delta_isa_to_str(sd_isa));
+    printf("#  * flt-s-min      = %d\n", p_flt_s_min);
+    printf("#  * flt-s-max      = %d\n", p_flt_s_max);
+    printf("#  * knn-k          = %d\n", p_knn_k);
+    printf("#  * knn-d          = %d\n", p_knn_d);
+    printf("#  * knn-s          = %1.3f\n", p_knn_s);
+    printf("#  * trk-ext-d      = %d\n", p_trk_ext_d);
+    printf("#  * trk-ext-o      = %d\n", p_trk_ext_o);
+    printf("#  * trk-obj-min    = %d\n", p_trk_obj_min);
+    printf("#  * bench-iter     = %d\n", p_bench_iter);
+    printf("#  * bench-warmup   = %d\n", p_bench_warmup);
+    printf("#  * bench-threads  = %s\n", str_bench_threads);
+    printf("#  * bench-kernels  = %s\n", p_bench_kernels);
+    printf("#  * bench-out-path = %s\n", p_bench_out_path);
+    printf("#\n");
+
+    // -------------------------- //
+    // -- CMD LINE ARGS CHECKS -- //
+    // -------------------------- //
+
+    const size_t n_threads = vector_size(p_bench_threads);
+    for (size_t t = 0; t < n_threads; t++) {
+        if (p_bench_threads[t] < 1) {
+            fprintf(stderr, "(EE) '--bench-threads' values have to be greater than 0\n");
+            exit(1);
+        }
+#ifndef _OPENMP
+        if (p_bench_threads[t] != 1)
+            fprintf(stderr, "(WW) '--bench-threads' is ignored, OpenMP is not enabled (%d -> 1)\n",
+                    p_bench_threads[t]);
+#endif
+    }
+    size_t n_selected = 0;
+    for (size_t k = 0; k < BENCH_N_KERNELS; k++)
+        n_selected += bench_select(p_bench_kernels, bench_kernels[k].name);
+    if (n_selected == 0) {
+        fprintf(stderr, "(EE) '--bench-kernels' does not select any kernel (see '--bench-list')\n");
+        exit(1);
+    }
+
+    // ---------------------------------------- //
+    // -- SYNTHETIC INPUTS & DATA ALLOCATION -- //
+    // ---------------------------------------- //
+
+    TIME_POINT(start_alloc_init);
+    const int i0 = 0, i1 = p_synth_height - 1, j0 = 0, j1 = p_synth_width - 1;
+    const int n_words = PACKED_N_WORDS(j0, j1);
+
+    synth_data_t* synth_data = synth_alloc_data(i0, i1, j0, j1, p_synth_objs, p_synth_size, p_synth_speed,
+                                                p_synth_noise, (uint64_t)p_synth_seed);
+    synth_init_data(synth_data);
+
+    bench_data_t b;
+    memset(&b, 0, sizeof(b));
+    b.i0 = i0;
+    b.i1 = i1;
+    b.j0 = j0;
+    b.j1 = j1;
+    b.sd_n = p_sd_n;
+    b.flt_s_min = p_flt_s_min;
+    b.flt_s_max = p_flt_s_max;
+    b.knn_k = p_knn_k;
+    b.knn_d = p_knn_d;
+    b.knn_s = p_knn_s;
+    b.trk_ext_d = p_trk_ext_d;
+    b.trk_ext_o = p_trk_ext_o;
+    b.trk_obj_min = p_trk_obj_min;
+    b.sd_data = sigma_delta_alloc_data(i0, i1, j0, j1, 1, 254);
+    b.morpho_data = morpho_alloc_data(i0, i1, j0, j1);
+    b.ccl_data = CCL_LSL_alloc_data(i0, i1, j0, j1);
+    morpho_init_data(b.morpho_data);
+    CCL_LSL_init_data(b.ccl_data);
+
+    // the reference labels give the capacity of the RoIs
+    uint32_t max_RoIs = 1;
+    for (size_t f = 0; f < BENCH_N_FRAMES; f++) {
+        b.IG[f] = ui8matrix(i0, i1, j0, j1);
+        b.IB[f] = ui8matrix(i0, i1, j0, j1);
+        b.IB_packed[f] = (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1);
+        b.L[f] = ui32matrix(i0, i1, j0, j1);
+        synth_render_gray(synth_data, f, b.IG[f]);
+        synth_render_binary(synth_data, f, b.IB[f]);
+        morpho_pack64((const uint8_t**)b.IB[f], b.IB_packed[f], i0, i1, j0, j1);
+        b.n_RoIs[f] = CCL_LSL_apply(b.ccl_data, (const uint8_t**)b.IB[f], b.L[f], 0);
+        max_RoIs = MAX(max_RoIs, b.n_RoIs[f]);
+    }
+    b.IB_tmp = ui8matrix(i0, i1, j0, j1);
+    b.IB_out = ui8matrix(i0, i1, j0, j1);
+    b.IB_packed_tmp = (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1);
+    b.IB_packed_out = (uint64_t**)ui64matrix(i0, i1, 0, n_words - 1);
+    b.L_out = ui32matrix(i0, i1, j0, j1);
+    b.RoIs_out = features_alloc_RoIs(max_RoIs);
+    b.remap = (uint32_t*)malloc((max_RoIs + 1) * sizeof(uint32_t));
+    features_init_RoIs(b.RoIs_out);
+
+    uint32_t max_RoIs_flt = 1;
+    double avg_RoIs = 0., avg_RoIs_flt = 0., density = 0.;
+    for (size_t f = 0; f < BENCH_N_FRAMES; f++) {
+        b.RoIs[f] = features_alloc_RoIs(max_RoIs);
+        b.RoIs_flt[f] = features_alloc_RoIs(max_RoIs);
+        features_init_RoIs(b.RoIs[f]);
+        features_init_RoIs(b.RoIs_flt[f]);
+        features_extract((const uint32_t**)b.L[f], i0, i1, j0, j1, b.RoIs[f], b.n_RoIs[f]);
+        bench_copy_RoIs(b.RoIs[f], b.n_RoIs[f], b.RoIs_out);
+        b.n_RoIs_flt[f] = features_filter_surface_remap(b.RoIs_out, b.n_RoIs[f], p_flt_s_min, p_flt_s_max,
+                                                        b.remap);
+        features_shrink_basic(b.RoIs_out, b.n_RoIs[f], b.RoIs_flt[f]);
+        max_RoIs_flt = MAX(max_RoIs_flt, b.n_RoIs_flt[f]);
+        avg_RoIs += (double)b.n_RoIs[f] / BENCH_N_FRAMES;
+        avg_RoIs_flt += (double)b.n_RoIs_flt[f] / BENCH_N_FRAMES;
+        for (int i = i0; i <= i1; i++)
+            for (int j = j0; j <= j1; j++)
+                density += b.IB[f][i][j] ? 1. : 0.;
+    }
+    const double n_pixels = (double)(i1 - i0 + 1) * (double)(j1 - j0 + 1);
+    density /= n_pixels * BENCH_N_FRAMES;
+
+    b.knn_data = kNN_alloc_data(max_RoIs_flt);
+    b.tracking_data = tracking_alloc_data(MAX(p_trk_obj_min, p_trk_ext_o) + 1, max_RoIs_flt);
+    kNN_init_data(b.knn_data);
+    tracking_init_data(b.tracking_data);
+    b.trk_file = fopen("/dev/null", "w");
+    if (b.trk_file == NULL) {
+        fprintf(stderr, "(EE) error while opening '/dev/null'\n");
+        exit(1);
+    }
+
+    TIME_POINT(stop_alloc_init);
+    printf("# Synthetic inputs and allocations took %6.3f sec\n",
+           (TIME_ELAPSED2_SEC(start_alloc_init, stop_alloc_init)));
+    printf("# Scene: %d x %d pixels, %.4f foreground density, %.1f RoIs per frame (%.1f after surface filtering)\n",
+           p_synth_width, p_synth_height, density, avg_RoIs, avg_RoIs_flt);
+    printf("#\n");
+
+    // ------------------ //
+    // -- MEASURE LOOP -- //
+    // ------------------ //
+
+    double* times_ns = (double*)malloc(p_bench_iter * sizeof(double));
+    double* medians_ns = (double*)malloc(n_threads * BENCH_N_KERNELS * sizeof(double));
+
+    FILE* out_file = NULL;
+    if (p_bench_out_path) {
+        out_file = fopen(p_bench_out_path, "w");
+        if (out_file == NULL) {
+            fprintf(stderr, "(EE) error while opening '%s'\n", p_bench_out_path);
+            exit(1);
+        }
+        fprintf(out_file, "Kernel,Threads,Width,Height,Objects,Noise,RoIs,Median_ns,ns_per_pixel,ns_per_RoI,"
+                          "Speedup\n");
+    }
+
+    printf("# -------------------------------||---------||------------||----------||----------||---------\n");
+    printf("#  Kernel                        || Threads ||     Median ||  ns/pix. ||   ns/RoI || Speedup \n");
+    printf("#                                ||         ||       (us) ||          ||          ||         \n");
+    printf("# -------------------------------||---------||------------||----------||----------||---------\n");
+
+    for (size_t t = 0; t < n_threads; t++) {
+#ifdef _OPENMP
+        omp_set_num_threads(p_bench_threads[t]);
+        const int threads = p_bench_threads[t];
+#else
+        const int threads = 1;
+#endif
+        for (size_t k = 0; k < BENCH_N_KERNELS; k++) {
+            const bench_kernel_t* kernel = &bench_kernels[k];
+            if (!bench_select(p_bench_kernels, kernel->name))
+                continue;
+
+            bench_reset(&b);
+            for (int it = 0; it < p_bench_warmup + p_bench_iter; it++) {
+                const size_t f = (size_t)it % BENCH_N_FRAMES;
+                if (kernel->prepare)
+                    kernel->prepare(&b, f);
+                TIME_POINT(run_b);
+                kernel->run(&b, f);
+                TIME_POINT(run_e);
+                if (it >= p_bench_warmup)
+                    times_ns[it - p_bench_warmup] = TIME_ELAPSED2_US(run_b, run_e) * 1e3;
+            }
+            qsort(times_ns, p_bench_iter, sizeof(double), bench_compare_double);
+            const double median_ns = (p_bench_iter % 2) ? times_ns[p_bench_iter / 2]
+                                                        : (times_ns[p_bench_iter / 2 - 1] +
+                                                           times_ns[p_bench_iter / 2]) / 2.;
+            medians_ns[t * BENCH_N_KERNELS + k] = median_ns;
+
+            const double n_RoIs = kernel->RoIs == BENCH_ROIS_CCA ? avg_RoIs :
+                                  kernel->RoIs == BENCH_ROIS_FLT ? avg_RoIs_flt : 0.;
+            const double ns_per_pixel = median_ns / n_pixels;
+            const double ns_per_RoI = n_RoIs > 0. ? median_ns / n_RoIs : 0.;
+            const double speedup = median_ns > 0. ? medians_ns[k] / median_ns : 0.;
+
+            char str_ns_per_RoI[32] = "-";
+            if (n_RoIs > 0.)
+                snprintf(str_ns_per_RoI, sizeof(str_ns_per_RoI), "%8.1f", ns_per_RoI);
+            printf("   %-29s || %7d || %10.1f || %8.3f || %8s || %7.2f \n", kernel->name, threads, median_ns * 1e-3,
+                   ns_per_pixel, str_ns_per_RoI, speedup);
+            fflush(stdout);
+
+            if (out_file) {
+                fprintf(out_file, "%s,%d,%d,%d,%d,%.4f,%.1f,%.0f,%.4f,", kernel->name, threads, p_synth_width,
+                        p_synth_height, p_synth_objs, p_synth_noise, n_RoIs, median_ns, ns_per_pixel);
+                if (n_RoIs > 0.)
+                    fprintf(out_file, "%.2f", ns_per_RoI);
+                fprintf(out_file, ",%.2f\n", speedup);
+            }
+        }
+    }
+
+    // ---------- //
+    // -- FREE -- //
+    // ---------- //
+
+    if (out_file) {
+        fclose(out_file);
+        printf("# Results written in '%s'\n", p_bench_out_path);
+    }
+    fclose(b.trk_file);
+    free(times_ns);
+    free(medians_ns);
+    for (size_t f = 0; f < BENCH_N_FRAMES; f++) {
+        free_ui8matrix(b.IG[f], i0, i1, j0, j1);
+        free_ui8matrix(b.IB[f], i0, i1, j0, j1);
+        free_ui64matrix((uint64**)b.IB_packed[f], i0, i1, 0, n_words - 1);
+        free_ui32matrix(b.L[f], i0, i1, j0, j1);
+        features_free_RoIs(b.RoIs[f]);
+        features_free_RoIs(b.RoIs_flt[f]);
+    }
+    free_ui8matrix(b.IB_tmp, i0, i1, j0, j1);
+    free_ui8matrix(b.IB_out, i0, i1, j0, j1);
+    free_ui64matrix((uint64**)b.IB_packed_tmp, i0, i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)b.IB_packed_out, i0, i1, 0, n_words - 1);
+    free_ui32matrix(b.L_out, i0, i1, j0, j1);
+    features_free_RoIs(b.RoIs_out);
+    free(b.remap);
+    sigma_delta_free_data(b.sd_data);
+    morpho_free_data(b.morpho_data);
+    CCL_LSL_free_data(b.ccl_data);
+    kNN_free_data(b.knn_data);
+    tracking_free_data(b.tracking_data);
+    synth_free_data(synth_data);
+    vector_free(p_bench_threads);
+
+    printf("# End of the program, exiting.\n");
+
+    return EXIT_SUCCESS;
+}
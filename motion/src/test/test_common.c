@@ -0,0 +1,15 @@
+#include "test_common.h"
+
+uint32_t test_rand(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+void test_rand_binary(uint8_t** img, const int i0, const int i1, const int j0, const int j1, const uint32_t density,
+                      uint32_t* state) {
+    for (int i = i0; i <= i1; i++)
+        for (int j = j0; j <= j1; j++)
+            img[i][j] = (test_rand(state) & 0xFF) < density ? 255 : 0;
+}
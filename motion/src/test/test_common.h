@@ -0,0 +1,28 @@
+/*!
+ * \file
+ * \brief Helpers shared by the tests.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Pseudo-random generator (xorshift32): the test images do not depend on the `rand()` implementation of the C library.
+ * @param state State of the generator (not 0), updated.
+ * @return The next pseudo-random number.
+ */
+uint32_t test_rand(uint32_t* state);
+
+/**
+ * Fill a binary image with random pixels.
+ * @param img Output 2D binary image (0 or 255 per pixel).
+ * @param i0 First \f$y\f$ index in the image (included).
+ * @param i1 Last \f$y\f$ index in the image (included).
+ * @param j0 First \f$x\f$ index in the image (included).
+ * @param j1 Last \f$x\f$ index in the image (included).
+ * @param density Probability of a foreground pixel (in 1/256).
+ * @param state State of the generator (see `test_rand`), updated.
+ */
+void test_rand_binary(uint8_t** img, const int i0, const int i1, const int j0, const int j1, const uint32_t density,
+                      uint32_t* state);
@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <nrc2.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "motion/macros.h"
+#include "motion/morpho.h"
+
+#include "test_common.h"
+
+// number of random images per configuration
+#define TEST_N_IMAGES 8
+
+static const int test_sizes[][2] = { { 37, 203 }, { 9, 64 }, { 11, 65 }, { 3, 1 }, { 64, 130 }, { 5, 515 } };
+// probability of a foreground pixel (in 1/256): sparse noise, blobs with holes and almost full images
+static const uint32_t test_density[] = { 16, 128, 240 };
+static const int test_threads[] = { 1, 3 };
+
+static int test_cmp_packed(const uint64_t** ref, const uint64_t** img, const int i1, const int j1) {
+    for (int i = 0; i <= i1; i++)
+        if (memcmp(ref[i], img[i], PACKED_N_WORDS(0, j1) * sizeof(uint64_t)))
+            return i;
+    return -1;
+}
+
+/* Check that `morpho_unpack64` gives back the image packed by `morpho_pack64`, then compare the 64-bit packed
+   morphology (opening, closing and fused opening + closing, out of place and in place) with the byte morphology on
+   random images. Return the number of failed checks. */
+static int test_size(const int i1, const int j1, const uint32_t density) {
+    const int n_words = PACKED_N_WORDS(0, j1);
+    uint8_t** img = ui8matrix(0, i1, 0, j1);
+    uint8_t** tmp = ui8matrix(0, i1, 0, j1);
+    uint8_t** ref = ui8matrix(0, i1, 0, j1);
+    uint64_t** img_packed = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    uint64_t** ref_packed_open = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    uint64_t** ref_packed_close = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    uint64_t** ref_packed = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    uint64_t** out_packed = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    uint64_t** out_packed2 = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    morpho_data_t* morpho_data = morpho_alloc_data(0, i1, 0, j1);
+    morpho_init_data(morpho_data);
+
+    int fails = 0;
+    uint32_t seed = 0x2545F491u ^ (uint32_t)(i1 * 4099 + j1 * 31 + density);
+    for (int n = 0; n < TEST_N_IMAGES && !fails; n++) {
+        test_rand_binary(img, 0, i1, 0, j1, density, &seed);
+        morpho_pack64((const uint8_t**)img, img_packed, 0, i1, 0, j1);
+
+        int i;
+        morpho_unpack64((const uint64_t**)img_packed, tmp, 0, i1, 0, j1);
+        for (i = 0; i <= i1 && !memcmp(img[i], tmp[i], j1 + 1); i++)
+            ;
+        if (i <= i1) {
+            fprintf(stderr, "(EE) morpho_pack64 + morpho_unpack64, %dx%d, density %u, image %d, row %d\n", j1 + 1,
+                    i1 + 1, density, n, i);
+            fails++;
+        }
+
+        // byte references
+        morpho_compute_opening3(morpho_data, (const uint8_t**)img, ref, 0, i1, 0, j1);
+        morpho_pack64((const uint8_t**)ref, ref_packed_open, 0, i1, 0, j1);
+        morpho_compute_closing3(morpho_data, (const uint8_t**)img, ref, 0, i1, 0, j1);
+        morpho_pack64((const uint8_t**)ref, ref_packed_close, 0, i1, 0, j1);
+        morpho_compute_opening3(morpho_data, (const uint8_t**)img, tmp, 0, i1, 0, j1);
+        morpho_compute_closing3(morpho_data, (const uint8_t**)tmp, ref, 0, i1, 0, j1);
+        morpho_pack64((const uint8_t**)ref, ref_packed, 0, i1, 0, j1);
+
+        morpho_compute_opening3_packed64(morpho_data, (const uint64_t**)img_packed, out_packed, 0, i1, 0, j1);
+        if ((i = test_cmp_packed((const uint64_t**)ref_packed_open, (const uint64_t**)out_packed, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) morpho_compute_opening3_packed64, %dx%d, density %u, image %d, row %d\n", j1 + 1,
+                    i1 + 1, density, n, i);
+            fails++;
+        }
+        morpho_compute_closing3_packed64(morpho_data, (const uint64_t**)img_packed, out_packed, 0, i1, 0, j1);
+        if ((i = test_cmp_packed((const uint64_t**)ref_packed_close, (const uint64_t**)out_packed, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) morpho_compute_closing3_packed64, %dx%d, density %u, image %d, row %d\n", j1 + 1,
+                    i1 + 1, density, n, i);
+            fails++;
+        }
+        morpho_compute_opening3_packed64(morpho_data, (const uint64_t**)img_packed, out_packed2, 0, i1, 0, j1);
+        morpho_compute_closing3_packed64(morpho_data, (const uint64_t**)out_packed2, out_packed, 0, i1, 0, j1);
+        if ((i = test_cmp_packed((const uint64_t**)ref_packed, (const uint64_t**)out_packed, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) opening3_packed64 + closing3_packed64, %dx%d, density %u, image %d, row %d\n",
+                    j1 + 1, i1 + 1, density, n, i);
+            fails++;
+        }
+        morpho_compute_opening_closing3_packed64(morpho_data, (const uint64_t**)img_packed, out_packed, 0, i1, 0,
+                                                 j1);
+        if ((i = test_cmp_packed((const uint64_t**)ref_packed, (const uint64_t**)out_packed, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) morpho_compute_opening_closing3_packed64, %dx%d, density %u, image %d, row %d\n",
+                    j1 + 1, i1 + 1, density, n, i);
+            fails++;
+        }
+
+        // in place, as in the detection chain
+        for (int ii = 0; ii <= i1; ii++)
+            memcpy(out_packed[ii], img_packed[ii], n_words * sizeof(uint64_t));
+        morpho_compute_opening3_packed64(morpho_data, (const uint64_t**)out_packed, out_packed, 0, i1, 0, j1);
+        morpho_compute_closing3_packed64(morpho_data, (const uint64_t**)out_packed, out_packed, 0, i1, 0, j1);
+        if ((i = test_cmp_packed((const uint64_t**)ref_packed, (const uint64_t**)out_packed, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) in place opening3_packed64 + closing3_packed64, %dx%d, density %u, image %d, "
+                            "row %d\n", j1 + 1, i1 + 1, density, n, i);
+            fails++;
+        }
+        for (int ii = 0; ii <= i1; ii++)
+            memcpy(out_packed[ii], img_packed[ii], n_words * sizeof(uint64_t));
+        morpho_compute_opening_closing3_packed64(morpho_data, (const uint64_t**)out_packed, out_packed, 0, i1, 0,
+                                                 j1);
+        if ((i = test_cmp_packed((const uint64_t**)ref_packed, (const uint64_t**)out_packed, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) in place opening_closing3_packed64, %dx%d, density %u, image %d, row %d\n",
+                    j1 + 1, i1 + 1, density, n, i);
+            fails++;
+        }
+    }
+
+    morpho_free_data(morpho_data);
+    free_ui8matrix(img, 0, i1, 0, j1);
+    free_ui8matrix(tmp, 0, i1, 0, j1);
+    free_ui8matrix(ref, 0, i1, 0, j1);
+    free_ui64matrix((uint64**)img_packed, 0, i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)ref_packed_open, 0, i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)ref_packed_close, 0, i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)ref_packed, 0, i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)out_packed, 0, i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)out_packed2, 0, i1, 0, n_words - 1);
+    return fails;
+}
+
+int main(void) {
+    int fails = 0;
+    for (size_t t = 0; t < sizeof(test_threads) / sizeof(test_threads[0]); t++) {
+#ifdef _OPENMP
+        // the fused kernel splits the image in bands of rows, one per thread
+        omp_set_num_threads(test_threads[t]);
+#else
+        if (t > 0)
+            break;
+#endif
+        int t_fails = 0;
+        for (size_t s = 0; s < sizeof(test_sizes) / sizeof(test_sizes[0]); s++)
+            for (size_t d = 0; d < sizeof(test_density) / sizeof(test_density[0]); d++)
+                t_fails += test_size(test_sizes[s][0] - 1, test_sizes[s][1] - 1, test_density[d]);
+        printf("# Packed morphology (%d thread(s)): %s\n", test_threads[t], t_fails ? "FAILED" : "ok");
+        fails += t_fails;
+    }
+    return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
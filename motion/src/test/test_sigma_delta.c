@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <nrc2.h>
+
+#include "motion/macros.h"
+#include "motion/sigma_delta.h"
+#include "motion/morpho.h"
+
+#include "test_common.h"
+
+// number of frames computed by each configuration (the saturations of M and V are reached after a few frames)
+#define TEST_N_FRAMES 64
+
+static const int test_sizes[][2] = { { 37, 203 }, { 9, 64 }, { 11, 65 }, { 4, 1 }, { 17, 130 }, { 3, 515 } };
+static const uint8_t test_N[] = { 0, 1, 2, 3, 4, 5, 7, 16, 255 };
+
+/* Random grayscale sequence: each frame is the previous one with a small noise and some random pixels, so the
+   differences with the background are not always 0 or saturated. */
+static void test_next_frame(uint8_t** img, const int i1, const int j1, uint32_t* seed) {
+    for (int i = 0; i <= i1; i++)
+        for (int j = 0; j <= j1; j++) {
+            const uint32_t r = test_rand(seed);
+            img[i][j] = (r & 3) ? (uint8_t)(img[i][j] + (int)((r >> 8) % 7) - 3) : (uint8_t)(r >> 16);
+        }
+}
+
+static int test_cmp_data(const sigma_delta_data_t* ref, const sigma_delta_data_t* sd, const int i1, const int j1) {
+    for (int i = 0; i <= i1; i++)
+        if (memcmp(ref->M[i], sd->M[i], j1 + 1) || memcmp(ref->V[i], sd->V[i], j1 + 1) ||
+            memcmp(ref->O[i], sd->O[i], j1 + 1))
+            return i;
+    return -1;
+}
+
+static int test_cmp_img(const uint8_t** ref, const uint8_t** img, const int i1, const int j1) {
+    for (int i = 0; i <= i1; i++)
+        if (memcmp(ref[i], img[i], j1 + 1))
+            return i;
+    return -1;
+}
+
+/* Run the scalar reference and the kernels of `isa` on the same sequence and compare the inner data and the outputs
+   after each frame. Return the number of failed checks. */
+static int test_isa(const enum sigma_delta_isa_e isa, const int i1, const int j1, const uint8_t N) {
+    const int n_words = PACKED_N_WORDS(0, j1);
+    uint8_t** img = ui8matrix(0, i1, 0, j1);
+    uint8_t** ref_out = ui8matrix(0, i1, 0, j1);
+    uint8_t** ref_mrp = ui8matrix(0, i1, 0, j1);
+    uint8_t** out = ui8matrix(0, i1, 0, j1);
+    uint64_t** ref_packed = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    uint64_t** out_packed = (uint64_t**)ui64matrix(0, i1, 0, n_words - 1);
+    morpho_data_t* morpho_data = morpho_alloc_data(0, i1, 0, j1);
+    morpho_init_data(morpho_data);
+
+    // one Sigma-Delta state per tested function: the reference and the byte, packed and fused (+ morphology) kernels
+    sigma_delta_data_t* sd[4];
+    uint32_t seed = 0x9E3779B9u ^ (uint32_t)(i1 * 4099 + j1 * 31 + N);
+    test_next_frame(img, i1, j1, &seed);
+    for (int k = 0; k < 4; k++) {
+        sd[k] = sigma_delta_alloc_data(0, i1, 0, j1, 1, 254);
+        sigma_delta_init_data(sd[k], (const uint8_t**)img, 0, i1, 0, j1);
+    }
+
+    int fails = 0;
+    const char* isa_str = sigma_delta_isa_to_str(isa);
+    for (int f = 0; f < TEST_N_FRAMES && !fails; f++) {
+        test_next_frame(img, i1, j1, &seed);
+
+        sigma_delta_select_isa(SD_ISA_SCALAR);
+        sigma_delta_compute(sd[0], (const uint8_t**)img, ref_out, 0, i1, 0, j1, N);
+        morpho_pack64((const uint8_t**)ref_out, ref_packed, 0, i1, 0, j1);
+        morpho_compute_opening3(morpho_data, (const uint8_t**)ref_out, out, 0, i1, 0, j1);
+        morpho_compute_closing3(morpho_data, (const uint8_t**)out, ref_mrp, 0, i1, 0, j1);
+
+        sigma_delta_select_isa(isa);
+        int i;
+        sigma_delta_compute(sd[1], (const uint8_t**)img, out, 0, i1, 0, j1, N);
+        if ((i = test_cmp_data(sd[0], sd[1], i1, j1)) != -1 ||
+            (i = test_cmp_img((const uint8_t**)ref_out, (const uint8_t**)out, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) sigma_delta_compute, isa = %s, %dx%d, N = %d, frame %d, row %d\n", isa_str,
+                    j1 + 1, i1 + 1, N, f, i);
+            fails++;
+        }
+
+        sigma_delta_compute_packed(sd[2], (const uint8_t**)img, out_packed, 0, i1, 0, j1, N);
+        if ((i = test_cmp_data(sd[0], sd[2], i1, j1)) == -1)
+            for (int ii = 0; ii <= i1 && i == -1; ii++)
+                if (memcmp(ref_packed[ii], out_packed[ii], n_words * sizeof(uint64_t)))
+                    i = ii;
+        if (i != -1) {
+            fprintf(stderr, "(EE) sigma_delta_compute_packed, isa = %s, %dx%d, N = %d, frame %d, row %d\n", isa_str,
+                    j1 + 1, i1 + 1, N, f, i);
+            fails++;
+        }
+
+        sigma_delta_morpho_fused(sd[3], (const uint8_t**)img, out, morpho_data->IB, morpho_data->IB2, 0, i1, 0, j1,
+                                 N);
+        if ((i = test_cmp_data(sd[0], sd[3], i1, j1)) != -1 ||
+            (i = test_cmp_img((const uint8_t**)ref_mrp, (const uint8_t**)out, i1, j1)) != -1) {
+            fprintf(stderr, "(EE) sigma_delta_morpho_fused, isa = %s, %dx%d, N = %d, frame %d, row %d\n", isa_str,
+                    j1 + 1, i1 + 1, N, f, i);
+            fails++;
+        }
+    }
+
+    for (int k = 0; k < 4; k++)
+        sigma_delta_free_data(sd[k]);
+    morpho_free_data(morpho_data);
+    free_ui8matrix(img, 0, i1, 0, j1);
+    free_ui8matrix(ref_out, 0, i1, 0, j1);
+    free_ui8matrix(ref_mrp, 0, i1, 0, j1);
+    free_ui8matrix(out, 0, i1, 0, j1);
+    free_ui64matrix((uint64**)ref_packed, 0, i1, 0, n_words - 1);
+    free_ui64matrix((uint64**)out_packed, 0, i1, 0, n_words - 1);
+    return fails;
+}
+
+int main(void) {
+    const enum sigma_delta_isa_e isas[] = { SD_ISA_SCALAR, SD_ISA_MIPP, SD_ISA_AVX2, SD_ISA_AVX512BW };
+    int fails = 0;
+    for (size_t k = 0; k < sizeof(isas) / sizeof(isas[0]); k++) {
+        if (!sigma_delta_isa_supported(isas[k])) {
+            printf("# Sigma-Delta '%s' kernels: skipped (not supported by the build or by the CPU)\n",
+                   sigma_delta_isa_to_str(isas[k]));
+            continue;
+        }
+        int isa_fails = 0;
+        for (size_t s = 0; s < sizeof(test_sizes) / sizeof(test_sizes[0]); s++)
+            for (size_t n = 0; n < sizeof(test_N); n++)
+                isa_fails += test_isa(isas[k], test_sizes[s][0] - 1, test_sizes[s][1] - 1, test_N[n]);
+        printf("# Sigma-Delta '%s' kernels: %s\n", sigma_delta_isa_to_str(isas[k]), isa_fails ? "FAILED" : "ok");
+        fails += isa_fails;
+    }
+    return fails ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,54 @@
+# Run the detection chain on a synthetic scene and compare its outputs with the golden files: the tracks written on the
+# standard output, the RoI ids of the tracks ('--trk-roi-path') and the streamed tracks ('--trk-out-path').
+#
+# Usage: cmake -DMOTION=<motion executable> -DSCENE=<'synth://' path> -DPARAMS=<chain options>
+#              -DGOLDEN=<prefix of the golden files> -DOUT=<prefix of the output files> [-DUPDATE_GOLDEN=ON]
+#              -P test_tracking_golden.cmake
+#
+# With '-DUPDATE_GOLDEN=ON' the outputs replace the golden files (to be used only when the tracks are expected to
+# change, the new golden files have to be reviewed).
+
+foreach(_var MOTION SCENE GOLDEN OUT)
+	if (NOT DEFINED ${_var})
+		message(FATAL_ERROR "(EE) '${_var}' is not defined.")
+	endif()
+endforeach()
+separate_arguments(_params UNIX_COMMAND "${PARAMS}")
+
+get_filename_component(_out_dir "${OUT}" DIRECTORY)
+file(MAKE_DIRECTORY "${_out_dir}")
+
+# '--trk-out-path' can't be combined with '--trk-roi-path': two runs
+execute_process(COMMAND "${MOTION}" --vid-in-path "${SCENE}" ${_params} --trk-roi-path "${OUT}_rois.txt"
+                OUTPUT_VARIABLE _stdout ERROR_VARIABLE _stderr RESULT_VARIABLE _ret)
+if (NOT _ret EQUAL 0)
+	message(FATAL_ERROR "(EE) '${MOTION}' failed (${_ret}):\n${_stderr}")
+endif()
+execute_process(COMMAND "${MOTION}" --vid-in-path "${SCENE}" ${_params} --trk-out-path "${OUT}_stream.txt"
+                OUTPUT_QUIET ERROR_VARIABLE _stderr RESULT_VARIABLE _ret)
+if (NOT _ret EQUAL 0)
+	message(FATAL_ERROR "(EE) '${MOTION}' failed (${_ret}):\n${_stderr}")
+endif()
+
+# the tracks are the lines of the standard output that are not comments (parameters, timings, ...)
+file(WRITE "${OUT}_stdout.txt" "${_stdout}")
+file(STRINGS "${OUT}_stdout.txt" _tracks REGEX "^[^#]")
+string(REPLACE ";" "\n" _tracks "${_tracks}")
+file(WRITE "${OUT}_tracks.txt" "${_tracks}\n")
+
+set(_fails 0)
+foreach(_file tracks rois stream)
+	if (UPDATE_GOLDEN)
+		configure_file("${OUT}_${_file}.txt" "${GOLDEN}_${_file}.txt" COPYONLY)
+		continue()
+	endif()
+	execute_process(COMMAND "${CMAKE_COMMAND}" -E compare_files "${OUT}_${_file}.txt" "${GOLDEN}_${_file}.txt"
+	                RESULT_VARIABLE _ret)
+	if (NOT _ret EQUAL 0)
+		message(SEND_ERROR "(EE) '${OUT}_${_file}.txt' differs from '${GOLDEN}_${_file}.txt'.")
+		math(EXPR _fails "${_fails} + 1")
+	endif()
+endforeach()
+if (_fails)
+	message(FATAL_ERROR "(EE) ${_fails} output(s) differ from the golden files (scene '${SCENE}', options '${PARAMS}').")
+endif()